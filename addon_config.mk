@@ -26,3 +26,20 @@ vs:
 	ADDON_SOURCES_EXCLUDE += "libs/openvr/samples/%"
 	ADDON_SOURCES_EXCLUDE += "libs/openvr/src"
 	ADDON_SOURCES_EXCLUDE += "libs/openvr/src/%"
+
+linux64:
+	ADDON_LIBS += "libs/openvr/lib/linux64/libopenvr_api.so"
+	ADDON_INCLUDES_EXCLUDE += "libs/openvr/bin"
+	ADDON_INCLUDES_EXCLUDE += "libs/openvr/bin/%"
+	ADDON_INCLUDES_EXCLUDE += "libs/openvr/lib"
+	ADDON_INCLUDES_EXCLUDE += "libs/openvr/lib/%"
+	ADDON_INCLUDES_EXCLUDE += "libs/openvr/src"
+	ADDON_INCLUDES_EXCLUDE += "libs/openvr/src/%"
+	ADDON_INCLUDES_EXCLUDE += "libs/openvr/samples"
+	ADDON_INCLUDES_EXCLUDE += "libs/openvr/samples/%"
+	ADDON_INCLUDES_EXCLUDE += "libs/openvr/controller_callouts"
+	ADDON_INCLUDES_EXCLUDE += "libs/openvr/controller_callouts/%"
+	ADDON_SOURCES_EXCLUDE += "libs/openvr/samples"
+	ADDON_SOURCES_EXCLUDE += "libs/openvr/samples/%"
+	ADDON_SOURCES_EXCLUDE += "libs/openvr/src"
+	ADDON_SOURCES_EXCLUDE += "libs/openvr/src/%"
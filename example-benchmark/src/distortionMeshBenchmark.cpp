@@ -0,0 +1,187 @@
+#include "distortionMeshBenchmark.h"
+#include "ofxOpenVRDistortionMesh.h"
+#include "ofxOpenVRFakeBackend.h"
+
+namespace {
+	const int kBucketCount = 32;	//buckets along each side of an eye, for finding the triangle under a point
+
+	//--------------------------------------------------------------
+	// Fake runtime with a barrel distortion growing with the 4th power of the radius,
+	// channels differ slightly as with chromatic aberration of real lenses
+	class BarrelBackend : public ofxOpenVRFakeBackend {
+	public:
+		bool ComputeDistortion(vr::EVREye eEye, float fU, float fV, vr::DistortionCoordinates_t *pDistortionCoordinates) override {
+			float k = (eEye == vr::Eye_Left) ? 0.9f : 0.85f;
+			distort(fU, fV, k * 1.02f, pDistortionCoordinates->rfRed);
+			distort(fU, fV, k, pDistortionCoordinates->rfGreen);
+			distort(fU, fV, k * 0.98f, pDistortionCoordinates->rfBlue);
+			return true;
+		}
+
+	protected:
+		static void distort(float fU, float fV, float k, float *pResult) {
+			float x = fU - 0.5f;
+			float y = fV - 0.5f;
+			float r2 = x * x + y * y;
+			float scale = 1 + k * r2 + 2 * k * k * r2 * r2;
+			pResult[0] = 0.5f + x * scale;
+			pResult[1] = 0.5f + y * scale;
+		}
+	};
+
+	struct MeshResult {
+		size_t vertices = 0;
+		size_t triangles = 0;
+		float maxError = 0;
+		float buildMs = 0;
+		int missed = 0;		//points not covered by any triangle, a watertight mesh has none
+	};
+
+	//--------------------------------------------------------------
+	// Purpose: Mesh positions of an eye span u in [0,1] and y = 1 - 2v, so buckets are indexed by u and v
+	//--------------------------------------------------------------
+	std::vector<std::vector<uint32_t>> makeBuckets(const ofxOpenVRDistortionMesh &mesh, vr::Hmd_Eye eye) {
+		const std::vector<ofxOpenVRLensVertex> &vertices = mesh.getVertices();
+		const std::vector<GLushort> &indices = mesh.getIndices();
+		float fXoffset = (eye == vr::Eye_Left) ? -1 : 0;
+		auto toBucket = [](float f) { return ofClamp(int(f * kBucketCount), 0, kBucketCount - 1); };
+
+		std::vector<std::vector<uint32_t>> buckets(kBucketCount * kBucketCount);
+		uint32_t unEnd = mesh.getFirstIndex(eye) + mesh.getIndexCount(eye);
+		for (uint32_t i = mesh.getFirstIndex(eye); i < unEnd; i += 3) {
+			float uMin = 1, uMax = 0, vMin = 1, vMax = 0;
+			for (int k = 0; k < 3; k++) {
+				const glm::vec2 &p = vertices[indices[i + k]].position;
+				float u = p.x - fXoffset;
+				float v = (1 - p.y) / 2;
+				uMin = std::min(uMin, u); uMax = std::max(uMax, u);
+				vMin = std::min(vMin, v); vMax = std::max(vMax, v);
+			}
+			for (int by = toBucket(vMin); by <= toBucket(vMax); by++) {
+				for (int bx = toBucket(uMin); bx <= toBucket(uMax); bx++) {
+					buckets[by * kBucketCount + bx].push_back(i);
+				}
+			}
+		}
+		return buckets;
+	}
+
+	//--------------------------------------------------------------
+	// Purpose: Largest difference of the UVs interpolated over the triangle under a random point
+	// from the runtime's UVs at it, of any channel, over both eyes
+	//--------------------------------------------------------------
+	void measureError(ofxOpenVRBackend *pVR, const ofxOpenVRDistortionMesh &mesh, int samples, MeshResult &result) {
+		const std::vector<ofxOpenVRLensVertex> &vertices = mesh.getVertices();
+		const std::vector<GLushort> &indices = mesh.getIndices();
+		for (int e = 0; e < 2; e++) {
+			vr::Hmd_Eye eye = vr::Hmd_Eye(e);
+			float fXoffset = (eye == vr::Eye_Left) ? -1 : 0;
+			std::vector<std::vector<uint32_t>> buckets = makeBuckets(mesh, eye);
+			ofSeedRandom(1);
+
+			for (int s = 0; s < samples; s++) {
+				float u = ofRandom(0, 1);
+				float v = ofRandom(0, 1);
+				glm::vec2 p(fXoffset + u, 1 - 2 * v);
+				int bx = ofClamp(int(u * kBucketCount), 0, kBucketCount - 1);
+				int by = ofClamp(int(v * kBucketCount), 0, kBucketCount - 1);
+
+				bool bFound = false;
+				for (uint32_t i : buckets[by * kBucketCount + bx]) {
+					const ofxOpenVRLensVertex &a = vertices[indices[i]];
+					const ofxOpenVRLensVertex &b = vertices[indices[i + 1]];
+					const ofxOpenVRLensVertex &c = vertices[indices[i + 2]];
+					glm::vec2 ab = b.position - a.position;
+					glm::vec2 ac = c.position - a.position;
+					glm::vec2 ap = p - a.position;
+					float det = ab.x * ac.y - ac.x * ab.y;
+					if (det == 0) continue;
+					float wb = (ap.x * ac.y - ac.x * ap.y) / det;
+					float wc = (ab.x * ap.y - ap.x * ab.y) / det;
+					float wa = 1 - wb - wc;
+					const float kEpsilon = -1e-6f;
+					if (wa < kEpsilon || wb < kEpsilon || wc < kEpsilon) continue;
+
+					vr::DistortionCoordinates_t dc;
+					pVR->ComputeDistortion(eye, u, v, &dc);
+					const float *pActual[3] = { dc.rfRed, dc.rfGreen, dc.rfBlue };
+					glm::vec2 interpolated[3] = {
+						a.texCoordRed * wa + b.texCoordRed * wb + c.texCoordRed * wc,
+						a.texCoordGreen * wa + b.texCoordGreen * wb + c.texCoordGreen * wc,
+						a.texCoordBlue * wa + b.texCoordBlue * wb + c.texCoordBlue * wc
+					};
+					for (int k = 0; k < 3; k++) {
+						result.maxError = std::max(result.maxError, std::abs(interpolated[k].x - pActual[k][0]));
+						result.maxError = std::max(result.maxError, std::abs(interpolated[k].y - (1 - pActual[k][1])));
+					}
+					bFound = true;
+					break;
+				}
+				if (!bFound) result.missed++;
+			}
+		}
+	}
+
+	//--------------------------------------------------------------
+	MeshResult measure(ofxOpenVRBackend *pVR, const ofxOpenVRDistortionMeshSettings &settings, int samples) {
+		MeshResult result;
+		ofxOpenVRDistortionMesh mesh;
+		uint64_t ulStart = ofGetElapsedTimeMicros();
+		mesh.build(pVR, "", "", settings);
+		result.buildMs = (ofGetElapsedTimeMicros() - ulStart) / 1000.0f;
+		result.vertices = mesh.getVertices().size();
+		result.triangles = mesh.getIndices().size() / 3;
+		measureError(pVR, mesh, samples, result);
+		return result;
+	}
+
+	//--------------------------------------------------------------
+	string toJson(const MeshResult &result) {
+		std::ostringstream out;
+		out << "{\"vertices\": " << result.vertices << ", \"triangles\": " << result.triangles
+			<< ", \"maxError\": " << result.maxError << ", \"buildMs\": " << result.buildMs << ", \"missed\": " << result.missed << "}";
+		return out.str();
+	}
+}
+
+//--------------------------------------------------------------
+bool runDistortionMeshBenchmark(int samples, const string &outFileName) {
+	samples = std::max(samples, 1);
+	BarrelBackend backend;
+	backend.Init();
+
+	// Same vertex budget: the default 43x43 grid has as many vertices per eye as the adaptive mesh may use
+	ofxOpenVRDistortionMeshSettings uniformSettings;
+	uniformSettings.adaptive = false;
+	uniformSettings.cacheDirectory = "";
+	ofxOpenVRDistortionMeshSettings adaptiveSettings = uniformSettings;
+	adaptiveSettings.adaptive = true;
+	adaptiveSettings.vertexBudget = uniformSettings.gridSize * uniformSettings.gridSize;
+
+	MeshResult uniform = measure(&backend, uniformSettings, samples);
+	MeshResult adaptive = measure(&backend, adaptiveSettings, samples);
+	backend.Shutdown();
+
+	bool ok = adaptive.triangles < uniform.triangles && adaptive.maxError < uniform.maxError
+		&& uniform.missed == 0 && adaptive.missed == 0;
+
+	std::ostringstream out;
+	out << "{" << endl;
+	out << "\t\"config\": {\"samplesPerEye\": " << samples << ", \"gridSize\": " << uniformSettings.gridSize
+		<< ", \"vertexBudget\": " << adaptiveSettings.vertexBudget << ", \"tolerance\": " << adaptiveSettings.tolerance << "}," << endl;
+	out << "\t\"uniform\": " << toJson(uniform) << "," << endl;
+	out << "\t\"adaptive\": " << toJson(adaptive) << endl;
+	out << "}" << endl;
+
+	cout << out.str();
+	ofBuffer buffer;
+	buffer.set(out.str());
+	if (!ofBufferToFile(outFileName, buffer)) {
+		ofLogError() << "Can't write " << outFileName;
+		return false;
+	}
+	if (!ok) {
+		ofLogError() << "Adaptive distortion mesh is not both smaller and more accurate than the uniform grid";
+	}
+	return ok;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+//Comparison of the adaptive lens distortion mesh of ofxOpenVRDistortionMesh with the uniform grid at the same vertex budget,
+//on a synthetic barrel distortion (the fake runtime's distortion is the identity, which needs no refinement).
+//Run with --distortion-mesh N (N - random points per eye where the interpolated UVs are checked), without window and runtime.
+//Fails unless the adaptive mesh has both fewer triangles and a lower maximum UV error.
+
+#include "ofMain.h"
+
+bool runDistortionMeshBenchmark(int samples, const string &outFileName);
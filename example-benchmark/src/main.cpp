@@ -0,0 +1,149 @@
+#include "ofMain.h"
+#include "ofApp.h"
+#include "poseMathBenchmark.h"
+#include "distortionMeshBenchmark.h"
+
+//========================================================================
+// Counting of heap allocations for the benchmark report
+static std::atomic<uint64_t> allocationCount(0);
+
+uint64_t getAllocationCount() {
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+// Every replaceable form is counted: plain, array, nothrow, sized and (C++17) over-aligned
+static void *countedAlloc(std::size_t size) {
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	return std::malloc(size ? size : 1);
+}
+
+void *operator new(std::size_t size) {
+	void *p = countedAlloc(size);
+	if (!p) throw std::bad_alloc();
+	return p;
+}
+
+void *operator new[](std::size_t size) {
+	return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+	return countedAlloc(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+	return countedAlloc(size);
+}
+
+void operator delete(void *p) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+	std::free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+	std::free(p);
+}
+
+#ifdef __cpp_aligned_new
+static void *countedAlignedAlloc(std::size_t size, std::align_val_t alignment) {
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+#ifdef _WIN32
+	return _aligned_malloc(size ? size : 1, std::size_t(alignment));
+#else
+	void *p = nullptr;
+	return (posix_memalign(&p, std::max(std::size_t(alignment), sizeof(void *)), size ? size : 1) == 0) ? p : nullptr;
+#endif
+}
+
+static void alignedFree(void *p) {
+#ifdef _WIN32
+	_aligned_free(p);
+#else
+	std::free(p);
+#endif
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+	void *p = countedAlignedAlloc(size, alignment);
+	if (!p) throw std::bad_alloc();
+	return p;
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+	return operator new(size, alignment);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+	return countedAlignedAlloc(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+	return countedAlignedAlloc(size, alignment);
+}
+
+void operator delete(void *p, std::align_val_t) noexcept {
+	alignedFree(p);
+}
+
+void operator delete[](void *p, std::align_val_t) noexcept {
+	alignedFree(p);
+}
+
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept {
+	alignedFree(p);
+}
+
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept {
+	alignedFree(p);
+}
+
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept {
+	alignedFree(p);
+}
+
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept {
+	alignedFree(p);
+}
+#endif
+
+//========================================================================
+int main(int argc, char *argv[]){
+	ofApp *app = new ofApp();
+	if (!app->parseArguments(argc, argv)) {
+		delete app;
+		return 1;
+	}
+	if (app->settings.poseMathIterations > 0) {
+		bool ok = runPoseMathBenchmark(app->settings.poseMathIterations, app->settings.out);
+		delete app;
+		return ok ? 0 : 1;
+	}
+	if (app->settings.distortionMeshSamples > 0) {
+		bool ok = runDistortionMeshBenchmark(app->settings.distortionMeshSamples, app->settings.out);
+		delete app;
+		return ok ? 0 : 1;
+	}
+
+	// The window is hidden, the benchmark renders into eye FBOs only
+	ofGLFWWindowSettings settings;
+	settings.setGLVersion(4, 1);
+	settings.setSize(320, 240);
+	settings.visible = false;
+	ofCreateWindow(settings);
+	ofRunApp(app);
+}
@@ -0,0 +1,290 @@
+#include "ofApp.h"
+
+#define STRINGIFY(A) #A
+
+//--------------------------------------------------------------
+bool ofApp::parseArguments(int argc, char *argv[]){
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		bool hasValue = (i + 1 < argc);
+		if (arg == "--frames" && hasValue) settings.frames = ofToInt(argv[++i]);
+		else if (arg == "--warmup" && hasValue) settings.warmup = ofToInt(argv[++i]);
+		else if (arg == "--controllers" && hasValue) settings.controllers = ofToInt(argv[++i]);
+		else if (arg == "--trackers" && hasValue) settings.trackers = ofToInt(argv[++i]);
+		else if (arg == "--burst-interval" && hasValue) settings.burstInterval = ofToInt(argv[++i]);
+		else if (arg == "--burst-size" && hasValue) settings.burstSize = ofToInt(argv[++i]);
+		else if (arg == "--boxes" && hasValue) settings.boxes = ofToInt(argv[++i]);
+		else if (arg == "--out" && hasValue) settings.out = argv[++i];
+		else if (arg == "--record" && hasValue) settings.record = argv[++i];
+		else if (arg == "--replay" && hasValue) settings.replay = argv[++i];
+		else if (arg == "--pose-math" && hasValue) settings.poseMathIterations = ofToInt(argv[++i]);
+		else if (arg == "--distortion-mesh" && hasValue) settings.distortionMeshSamples = ofToInt(argv[++i]);
+		else if (arg == "--single-pass") settings.singlePass = true;
+		else if (arg == "--no-camera") settings.camera = false;
+		else if (arg == "--throttle") settings.throttle = true;
+		else if (arg == "--check-allocations") settings.checkAllocations = true;
+		else {
+			cout << "Unknown argument: " << arg << ", see example-benchmark/src/ofApp.h for the list" << endl;
+			return false;
+		}
+	}
+	settings.frames = std::max(settings.frames, 1);
+	settings.warmup = std::max(settings.warmup, 0);
+	return true;
+}
+
+//--------------------------------------------------------------
+void ofApp::setup(){
+	ofSetVerticalSync(false);
+	ofSetFrameRate(0);
+
+	ofxOpenVRFakeBackendSettings fakeSettings;
+	fakeSettings.controllerCount = settings.controllers;
+	fakeSettings.trackerCount = settings.trackers;
+	fakeSettings.hasCamera = settings.camera;
+	fakeSettings.throttle = settings.throttle;
+	if (settings.replay.empty()) {
+		fakeVR = std::make_shared<ofxOpenVRFakeBackend>(fakeSettings);
+		scheduleEvents();
+	}
+	else {
+		fakeVR = std::make_shared<ofxOpenVRReplayBackend>(settings.replay, settings.throttle, true);
+	}
+
+	std::shared_ptr<ofxOpenVRBackend> backend = fakeVR;
+	if (!settings.record.empty()) {
+		backend = std::make_shared<ofxOpenVRRecordingBackend>(fakeVR, settings.record);
+	}
+	openVR.setup(std::bind(&ofApp::render, this, std::placeholders::_1), backend);
+	openVR.setDrawControllers(true);
+	openVR.setRenderModelForTrackedDevices(true);
+	if (settings.singlePass) {
+		openVR.setStereoRenderMode(StereoRenderMode::SinglePassInstanced);
+		openVR.setSinglePassRenderFunction(std::bind(&ofApp::renderStereo, this));
+	}
+	openVR.setProfilingEnabled(true);
+
+	// The camera streams only while it is shown, so show it to measure the passthrough
+	if (settings.camera) {
+		openVR.showCamera();
+	}
+
+	boxMesh = ofMesh::box(0.1f, 0.1f, 0.1f);
+
+	// Shader for single-pass stereo: instance is the eye, see addon's shader/controllerTransformStereo.vert
+	string vertex = "#version 410\n";
+	vertex += STRINGIFY(
+						uniform mat4 matrices[2];
+						uniform mat4 model;
+						in vec4 position;
+
+						void main() {
+							int eye = gl_InstanceID;
+							vec4 clipPos = matrices[eye] * model * position;
+							gl_ClipDistance[0] = (eye == 0) ? (clipPos.w - clipPos.x) : (clipPos.w + clipPos.x);
+							gl_Position = vec4(clipPos.x * 0.5 + ((eye == 0) ? -0.5 : 0.5) * clipPos.w, clipPos.yzw);
+						}
+						);
+
+	string fragment = "#version 410\n";
+	fragment += STRINGIFY(
+						out vec4 outputColor;
+						void main() {
+							outputColor = vec4(1.0, 1.0, 1.0, 1.0);
+						}
+						);
+
+	stereoShader.setupShaderFromSource(GL_VERTEX_SHADER, vertex);
+	stereoShader.setupShaderFromSource(GL_FRAGMENT_SHADER, fragment);
+	stereoShader.bindDefaults();
+	stereoShader.linkProgram();
+
+	frame = -settings.warmup;
+	eventCount = 0;
+	frameMs.reserve(settings.frames);
+	frameAllocations.reserve(settings.frames);
+	drawCalls[vr::Eye_Left].reserve(settings.frames);
+	drawCalls[vr::Eye_Right].reserve(settings.frames);
+	startTimeMicros = ofGetElapsedTimeMicros();
+}
+
+//--------------------------------------------------------------
+// Bursts of press/unpress pairs over all controllers, delivered at the fake runtime's frames
+//--------------------------------------------------------------
+void ofApp::scheduleEvents(){
+	if (settings.burstInterval <= 0 || settings.burstSize <= 0 || settings.controllers <= 0) return;
+
+	const vr::EVRButtonId buttons[] = { vr::k_EButton_SteamVR_Trigger, vr::k_EButton_SteamVR_Touchpad, vr::k_EButton_Grip, vr::k_EButton_ApplicationMenu };
+	int total = settings.warmup + settings.frames;
+	for (int f = settings.burstInterval; f <= total; f += settings.burstInterval) {
+		for (int i = 0; i < settings.burstSize; i++) {
+			vr::TrackedDeviceIndex_t device = 1 + i % settings.controllers;
+			vr::EVRButtonId button = buttons[(i / settings.controllers) % 4];
+			fakeVR->addButtonEvent(f, device, vr::VREvent_ButtonPress, button);
+			fakeVR->addButtonEvent(f + 1, device, vr::VREvent_ButtonUnpress, button);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofApp::exit(){
+	openVR.exit();
+}
+
+//--------------------------------------------------------------
+void ofApp::update(){
+	uint64_t allocations = getAllocationCount();
+	auto start = std::chrono::steady_clock::now();
+
+	openVR.update();
+	while (openVR.hasControllerEvents()) {
+		ofxOpenVRControllerEvent event;
+		openVR.getNextControllerEvent(event);
+		eventCount++;
+	}
+	openVR.render();
+
+	auto end = std::chrono::steady_clock::now();
+	allocations = getAllocationCount() - allocations;
+
+	if (frame >= 0) {
+		frameMs.push_back(std::chrono::duration<float, std::milli>(end - start).count());
+		frameAllocations.push_back(allocations);
+		drawCalls[vr::Eye_Left].push_back(openVR.getDrawCallCount(vr::Eye_Left));
+		drawCalls[vr::Eye_Right].push_back(openVR.getDrawCallCount(vr::Eye_Right));
+	}
+	if (frame == 0) {
+		openVR.getProfiler().clear();
+		startTimeMicros = ofGetElapsedTimeMicros();
+	}
+	frame++;
+
+	if (frame >= settings.frames) {
+		bool ok = saveResults();
+		int exitCode = ok ? 0 : 1;
+
+		// Steady-state frames must not touch the heap, allocator jitter shows up as missed frames
+		if (settings.checkAllocations) {
+			for (size_t i = 0; i < frameAllocations.size(); i++) {
+				if (frameAllocations[i] > 0) {
+					ofLogError() << "Frame " << i << " after warm-up made " << frameAllocations[i] << " heap allocation(s)";
+					exitCode = 2;
+					break;
+				}
+			}
+		}
+		ofExit(exitCode);
+	}
+}
+
+//--------------------------------------------------------------
+void ofApp::draw(){
+}
+
+//--------------------------------------------------------------
+glm::vec3 ofApp::getBoxPosition(int i){
+	// Grid of 10x10 boxes per layer in front of the user
+	return glm::vec3((i % 10) * 0.3f - 1.5f, 0.5f + (i / 10 % 10) * 0.3f, -2.0f - (i / 100) * 0.3f);
+}
+
+//--------------------------------------------------------------
+void ofApp::render(vr::Hmd_Eye nEye){
+	openVR.pushMatricesForRender(nEye);
+	ofSetColor(255);
+	for (int i = 0; i < settings.boxes; i++) {
+		ofPushMatrix();
+		ofTranslate(getBoxPosition(i));
+		boxMesh.draw();
+		ofPopMatrix();
+	}
+	openVR.popMatricesForRender();
+}
+
+//--------------------------------------------------------------
+void ofApp::renderStereo(){
+	const std::array<glm::mat4, 2> &matrices = openVR.getStereoViewProjectionMatrices();
+	stereoShader.begin();
+	stereoShader.setUniformMatrix4f("matrices", matrices[0], 2);
+	for (int i = 0; i < settings.boxes; i++) {
+		stereoShader.setUniformMatrix4f("model", glm::translate(glm::mat4(1.0f), getBoxPosition(i)));
+		boxMesh.drawInstanced(OF_MESH_FILL, 2);
+	}
+	stereoShader.end();
+}
+
+//--------------------------------------------------------------
+// Purpose: Writes config, per-function timings, allocations and draw calls as JSON
+//--------------------------------------------------------------
+bool ofApp::saveResults(){
+	float seconds = (ofGetElapsedTimeMicros() - startTimeMicros) / 1000000.0f;
+
+	auto stats = [](vector<float> values) {
+		ofxOpenVRStageStats s;
+		if (values.empty()) return s;
+		std::sort(values.begin(), values.end());
+		s.samples = values.size();
+		s.min = values.front();
+		s.max = values.back();
+		s.p99 = values[std::min(values.size() - 1, size_t(values.size() * 0.99f))];
+		for (float v : values) s.avg += v;
+		s.avg /= values.size();
+		return s;
+	};
+	auto writeStats = [](std::ostream &out, const ofxOpenVRStageStats &s) {
+		out << "{\"samples\": " << s.samples << ", \"min\": " << s.min << ", \"avg\": " << s.avg
+			<< ", \"p99\": " << s.p99 << ", \"max\": " << s.max << "}";
+	};
+
+	vector<float> allocations(frameAllocations.begin(), frameAllocations.end());
+	vector<float> drawCallsLeft(drawCalls[vr::Eye_Left].begin(), drawCalls[vr::Eye_Left].end());
+	vector<float> drawCallsRight(drawCalls[vr::Eye_Right].begin(), drawCalls[vr::Eye_Right].end());
+
+	std::ostringstream out;
+	out << "{" << endl;
+	out << "\t\"config\": {\"frames\": " << settings.frames << ", \"warmup\": " << settings.warmup
+		<< ", \"controllers\": " << settings.controllers << ", \"trackers\": " << settings.trackers
+		<< ", \"burstInterval\": " << settings.burstInterval << ", \"burstSize\": " << settings.burstSize
+		<< ", \"boxes\": " << settings.boxes << ", \"singlePass\": " << (settings.singlePass ? "true" : "false")
+		<< ", \"camera\": " << (settings.camera ? "true" : "false") << ", \"throttle\": " << (settings.throttle ? "true" : "false")
+		<< ", \"replay\": \"" << settings.replay << "\"}," << endl;
+	out << "\t\"seconds\": " << seconds << "," << endl;
+	out << "\t\"fps\": " << (seconds > 0 ? settings.frames / seconds : 0) << "," << endl;
+	out << "\t\"events\": " << eventCount << "," << endl;
+	out << "\t\"submits\": " << fakeVR->getSubmitCount() << "," << endl;
+	out << "\t\"frameMs\": ";
+	writeStats(out, stats(frameMs));
+	out << "," << endl;
+	out << "\t\"allocationsPerFrame\": ";
+	writeStats(out, stats(allocations));
+	out << "," << endl;
+	out << "\t\"drawCallsPerEye\": {\"left\": ";
+	writeStats(out, stats(drawCallsLeft));
+	out << ", \"right\": ";
+	writeStats(out, stats(drawCallsRight));
+	out << "}," << endl;
+
+	// Per-function times from the addon's profiler, over its last ofxOpenVRProfiler::kHistorySize frames
+	ofxOpenVRProfiler &profiler = openVR.getProfiler();
+	out << "\t\"stages\": {" << endl;
+	for (int i = 0; i < ofxOpenVRProfiler::kStageCount; i++) {
+		ofxOpenVRStage stage = ofxOpenVRStage(i);
+		out << "\t\t\"" << ofxOpenVRProfiler::getStageName(stage) << "\": {\"cpu\": ";
+		writeStats(out, profiler.getCpuStats(stage));
+		out << ", \"gpu\": ";
+		writeStats(out, profiler.getGpuStats(stage));
+		out << "}" << ((i + 1 < ofxOpenVRProfiler::kStageCount) ? "," : "") << endl;
+	}
+	out << "\t}" << endl;
+	out << "}" << endl;
+
+	cout << out.str();
+
+	ofBuffer buffer;
+	buffer.set(out.str());
+	if (!ofBufferToFile(settings.out, buffer)) {
+		ofLogError() << "Unable to write " << settings.out;
+		return false;
+	}
+	ofLogNotice() << "Benchmark results are saved to " << settings.out;
+	return true;
+}
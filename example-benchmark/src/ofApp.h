@@ -0,0 +1,85 @@
+#pragma once
+
+//Headless benchmark of the addon's frame loop.
+//Runs the fake OpenVR runtime (no SteamVR and headset needed) for a number of frames,
+//with configurable device count and bursts of controller events,
+//and writes the results to a JSON file, to compare performance between versions.
+//
+//Arguments (all optional):
+//	--frames N			simulated frames to measure (default 2000)
+//	--warmup N			frames before measuring (default 100)
+//	--controllers N		0..16 (default 2)
+//	--trackers N		0..16 (default 0)
+//	--burst-interval N	frames between event bursts, 0 - no events (default 30)
+//	--burst-size N		button events in a burst (default 8)
+//	--boxes N			boxes drawn in the scene (default 100)
+//	--single-pass		use single-pass instanced stereo
+//	--no-camera			disable the simulated camera, otherwise the passthrough is shown
+//	--throttle			wait for simulated 90 Hz vsync, as real runtime does
+//	--check-allocations	exit with code 2 if any measured frame allocates heap memory
+//	--record FILE		record the session to FILE (see ofxOpenVRRecorder.h)
+//	--replay FILE		replay a recorded session instead of the simulated devices and events,
+//						in a loop if it is shorter than warmup + frames
+//	--pose-math N		only run the micro-benchmark of batched pose math for N iterations, see poseMathBenchmark.h
+//	--distortion-mesh N	only compare the adaptive and uniform lens meshes at N points per eye, see distortionMeshBenchmark.h
+//	--out FILE			result file (default benchmark.json in bin/data)
+
+#include "ofMain.h"
+#include "ofxOpenVR.h"
+#include "ofxOpenVRFakeBackend.h"
+#include "ofxOpenVRRecorder.h"
+#include "ofxOpenVRReplayBackend.h"
+
+uint64_t getAllocationCount();	//see main.cpp
+
+struct BenchmarkSettings {
+	int frames = 2000;
+	int warmup = 100;
+	int controllers = 2;
+	int trackers = 0;
+	int burstInterval = 30;
+	int burstSize = 8;
+	int boxes = 100;
+	bool singlePass = false;
+	bool camera = true;
+	bool throttle = false;
+	bool checkAllocations = false;
+	string out = "benchmark.json";
+	string record;
+	string replay;
+	int poseMathIterations = 0;
+	int distortionMeshSamples = 0;
+};
+
+class ofApp : public ofBaseApp{
+
+	public:
+		bool parseArguments(int argc, char *argv[]);
+
+		void setup();
+		void exit();
+
+		void update();
+		void draw();
+
+		void render(vr::Hmd_Eye nEye);
+		void renderStereo();
+
+		ofxOpenVR openVR;
+		std::shared_ptr<ofxOpenVRFakeBackend> fakeVR;
+
+		BenchmarkSettings settings;
+		ofVboMesh boxMesh;
+		glm::vec3 getBoxPosition(int i);
+		ofShader stereoShader;
+
+		int frame;					//measured frames done, negative during warmup
+		uint64_t startTimeMicros;
+		vector<float> frameMs;		//update() + render() time of each measured frame
+		vector<uint64_t> frameAllocations;
+		vector<int> drawCalls[2];	//per eye
+		uint64_t eventCount;
+
+		void scheduleEvents();
+		bool saveResults();
+};
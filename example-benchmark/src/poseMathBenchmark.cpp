@@ -0,0 +1,154 @@
+#include "poseMathBenchmark.h"
+#include "ofxOpenVRPoseMath.h"
+
+namespace {
+	const uint32_t kDeviceCount = vr::k_unMaxTrackedDeviceCount;
+
+	//--------------------------------------------------------------
+	// Per-device code which was used before ofxOpenVRPoseMath
+	glm::mat4 glmConvert(const vr::HmdMatrix34_t &matPose) {
+		return glm::mat4(
+			matPose.m[0][0], matPose.m[1][0], matPose.m[2][0], 0.0,
+			matPose.m[0][1], matPose.m[1][1], matPose.m[2][1], 0.0,
+			matPose.m[0][2], matPose.m[1][2], matPose.m[2][2], 0.0,
+			matPose.m[0][3], matPose.m[1][3], matPose.m[2][3], 1.0f
+		);
+	}
+
+	glm::vec3 glmCenter(const glm::mat4 &pose) {
+		return glm::vec3(pose * glm::vec4(0, 0, 0, 1));
+	}
+
+	glm::vec3 glmAxe(const glm::mat4 &pose, int axe) {
+		glm::vec4 center(0, 0, 0, 1);
+		glm::vec4 point = center;
+		point[axe] += 0.05f;
+		point = pose * point - pose * center;
+		return glm::normalize(glm::vec3(point));
+	}
+
+	//--------------------------------------------------------------
+	// Random rigid poses, every 4th is invalid as unconnected devices are
+	void makePoses(vr::TrackedDevicePose_t *poses) {
+		memset(poses, 0, sizeof(vr::TrackedDevicePose_t) * kDeviceCount);
+		for (uint32_t i = 0; i < kDeviceCount; i++) {
+			glm::mat4 m = glm::translate(glm::mat4(1.0f), glm::vec3(ofRandom(-2, 2), ofRandom(0, 2), ofRandom(-2, 2)));
+			m = m * glm::mat4_cast(glm::angleAxis(ofRandom(0, TWO_PI), glm::normalize(glm::vec3(ofRandom(-1, 1), ofRandom(-1, 1), ofRandom(-1, 1)) + glm::vec3(0.01f))));
+			for (int r = 0; r < 3; r++) {
+				for (int c = 0; c < 4; c++) {
+					poses[i].mDeviceToAbsoluteTracking.m[r][c] = m[c][r];
+				}
+			}
+			poses[i].bPoseIsValid = (i % 4 != 3);
+		}
+	}
+
+	//--------------------------------------------------------------
+	float maxDifference(const glm::mat4 &a, const glm::mat4 &b) {
+		float d = 0;
+		for (int c = 0; c < 4; c++) {
+			for (int r = 0; r < 4; r++) {
+				d = std::max(d, std::abs(a[c][r] - b[c][r]));
+			}
+		}
+		return d;
+	}
+
+	float maxDifference(const glm::vec3 &a, const glm::vec3 &b) {
+		return std::max(std::abs(a.x - b.x), std::max(std::abs(a.y - b.y), std::abs(a.z - b.z)));
+	}
+
+	//--------------------------------------------------------------
+	template<class F> double measureNs(int iterations, F f) {
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; i++) {
+			f();
+		}
+		auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+	}
+}
+
+//--------------------------------------------------------------
+bool runPoseMathBenchmark(int iterations, const string &outFileName) {
+	iterations = std::max(iterations, 1);
+	ofSeedRandom(1);
+
+	vr::TrackedDevicePose_t poses[kDeviceCount];
+	makePoses(poses);
+
+	glm::mat4 glmMatrices[kDeviceCount], batchMatrices[kDeviceCount];
+	glm::mat4 glmInverses[kDeviceCount], batchInverses[kDeviceCount];
+	glm::vec3 glmCenters[kDeviceCount], batchCenters[kDeviceCount];
+	glm::vec3 glmAxes[kDeviceCount * 3], batchAxes[kDeviceCount * 3];
+	for (uint32_t i = 0; i < kDeviceCount; i++) {
+		glmMatrices[i] = batchMatrices[i] = glm::mat4(1.0f);
+	}
+
+	// Times are per pass over all devices, in nanoseconds
+	double glmConvertNs = measureNs(iterations, [&]() {
+		for (uint32_t i = 0; i < kDeviceCount; i++) {
+			if (poses[i].bPoseIsValid) glmMatrices[i] = glmConvert(poses[i].mDeviceToAbsoluteTracking);
+		}
+	});
+	double batchConvertNs = measureNs(iterations, [&]() {
+		ofxOpenVRPoseMath::convertPoses(poses, kDeviceCount, batchMatrices);
+	});
+
+	double glmInvertNs = measureNs(iterations, [&]() {
+		for (uint32_t i = 0; i < kDeviceCount; i++) {
+			glmInverses[i] = glm::inverse(glmMatrices[i]);
+		}
+	});
+	double batchInvertNs = measureNs(iterations, [&]() {
+		ofxOpenVRPoseMath::invertRigid(batchMatrices, kDeviceCount, batchInverses);
+	});
+
+	double glmAxesNs = measureNs(iterations, [&]() {
+		for (uint32_t i = 0; i < kDeviceCount; i++) {
+			glmCenters[i] = glmCenter(glmMatrices[i]);
+			for (int k = 0; k < 3; k++) {
+				glmAxes[i * 3 + k] = glmAxe(glmMatrices[i], k);
+			}
+		}
+	});
+	double batchAxesNs = measureNs(iterations, [&]() {
+		ofxOpenVRPoseMath::extractCentersAndAxes(batchMatrices, kDeviceCount, batchCenters, batchAxes);
+	});
+
+	// Results must match the glm path
+	float maxError = 0;
+	for (uint32_t i = 0; i < kDeviceCount; i++) {
+		maxError = std::max(maxError, maxDifference(glmMatrices[i], batchMatrices[i]));
+		maxError = std::max(maxError, maxDifference(glmInverses[i], batchInverses[i]));
+		maxError = std::max(maxError, maxDifference(glmCenters[i], batchCenters[i]));
+		for (int k = 0; k < 3; k++) {
+			maxError = std::max(maxError, maxDifference(glmAxes[i * 3 + k], batchAxes[i * 3 + k]));
+		}
+	}
+	bool ok = maxError < 1e-4f;
+
+	std::ostringstream out;
+	out << "{" << endl;
+	out << "\t\"config\": {\"iterations\": " << iterations << ", \"devices\": " << kDeviceCount
+		<< ", \"simd\": " << (ofxOpenVRPoseMath::isSimdEnabled() ? "true" : "false") << "}," << endl;
+	out << "\t\"nsPerPass\": {" << endl;
+	out << "\t\t\"convert\": {\"glm\": " << glmConvertNs << ", \"batched\": " << batchConvertNs << "}," << endl;
+	out << "\t\t\"invert\": {\"glm\": " << glmInvertNs << ", \"batched\": " << batchInvertNs << "}," << endl;
+	out << "\t\t\"centersAndAxes\": {\"glm\": " << glmAxesNs << ", \"batched\": " << batchAxesNs << "}" << endl;
+	out << "\t}," << endl;
+	out << "\t\"maxError\": " << maxError << endl;
+	out << "}" << endl;
+
+	cout << out.str();
+	ofBuffer buffer;
+	buffer.set(out.str());
+	if (!ofBufferToFile(outFileName, buffer)) {
+		ofLogError() << "Can't write " << outFileName;
+		return false;
+	}
+	if (!ok) {
+		ofLogError() << "Batched pose math differs from glm by " << maxError;
+	}
+	return ok;
+}
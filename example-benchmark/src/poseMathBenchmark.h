@@ -0,0 +1,8 @@
+#pragma once
+
+//Micro-benchmark of ofxOpenVRPoseMath batched kernels against the per-device glm code they replace,
+//run with --pose-math N (N - iterations over all 64 device slots), without window and runtime.
+
+#include "ofMain.h"
+
+bool runPoseMathBenchmark(int iterations, const string &outFileName);
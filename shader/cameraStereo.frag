@@ -0,0 +1,14 @@
+#version 410
+uniform sampler2D cam;
+uniform vec4 texBounds;	//uMin, vMin, uMax, vMax of the camera frame in the texture
+in vec4 v4CameraClip;
+flat in int eye;
+out vec4 outputColor;
+void main() {
+	vec2 camera = v4CameraClip.xy / v4CameraClip.w;
+	if (v4CameraClip.w <= 0.0 || any(greaterThan(abs(camera), vec2(1.0)))) discard;
+
+	// The frame holds both eyes: right eye in the first half of rows, left eye in the second one
+	vec2 frameCoord = vec2(camera.x * 0.5 + 0.5, camera.y * 0.25 + 0.25 + ((eye == 0) ? 0.5 : 0.0));
+	outputColor = texture(cam, mix(texBounds.xy, texBounds.zw, frameCoord));
+}
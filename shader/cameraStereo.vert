@@ -0,0 +1,30 @@
+#version 410
+uniform mat4 eyeInverseProjection[2];	//current eye's clip space to eye space
+uniform mat4 eyeToCamera[2];			//current eye space to camera clip space at the capture time
+uniform float depth;					//distance in meters of the plane the camera image is projected onto
+uniform int singleEye;	//-1 - both eyes in the double-wide target, 0 or 1 - only this eye in its own target
+out vec4 v4CameraClip;
+flat out int eye;
+
+void main()
+{
+	// Full-eye quad: corners come from gl_VertexID (triangle strip of 4 vertices), the eye from gl_InstanceID
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+	eye = (singleEye < 0) ? gl_InstanceID : singleEye;
+	vec2 pos = corner * 2.0 - 1.0;
+
+	// Point of the plane seen through this corner. Both steps are linear on the screen,
+	// so the camera's clip coordinates are interpolated and divided per fragment.
+	vec4 farPoint = eyeInverseProjection[eye] * vec4(pos, 1.0, 1.0);
+	vec3 ray = farPoint.xyz / farPoint.w;
+	v4CameraClip = eyeToCamera[eye] * vec4(ray * (depth / -ray.z), 1.0);
+
+	if (singleEye < 0) {
+		gl_ClipDistance[0] = (eye == 0) ? (1.0 - pos.x) : (1.0 + pos.x);
+		gl_Position = vec4(pos.x * 0.5 + ((eye == 0) ? -0.5 : 0.5), pos.y, 0.0, 1.0);
+	}
+	else {
+		gl_ClipDistance[0] = 1.0;
+		gl_Position = vec4(pos, 0.0, 1.0);
+	}
+}
@@ -0,0 +1,16 @@
+#version 410
+uniform mat4 matrices[2];
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec3 v3ColorIn;
+out vec4 v4Color;
+
+void main() {
+	v4Color.rgb = v3ColorIn;
+    v4Color.a = 1.0;
+
+	// gl_InstanceID is the eye, it is squeezed to its half of the double-wide target and clipped there
+	int eye = gl_InstanceID;
+	vec4 clipPos = matrices[eye] * position;
+	gl_ClipDistance[0] = (eye == 0) ? (clipPos.w - clipPos.x) : (clipPos.w + clipPos.x);
+	gl_Position = vec4(clipPos.x * 0.5 + ((eye == 0) ? -0.5 : 0.5) * clipPos.w, clipPos.yzw);
+}
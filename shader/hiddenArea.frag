@@ -0,0 +1,6 @@
+#version 410
+out vec4 outputColor;
+void main() {
+	//only stencil is written
+	outputColor = vec4(0.0);
+}
@@ -0,0 +1,8 @@
+#version 410
+uniform int stereo;		//1 - double-wide target, each vertex goes to its eye's half
+layout(location = 0) in vec3 position;	//xy - normalized device coordinates, z - eye
+void main()
+{
+	float x = (stereo == 1) ? position.x * 0.5 + ((position.z < 0.5) ? -0.5 : 0.5) : position.x;
+	gl_Position = vec4(x, position.y, 0.0, 1.0);
+}
@@ -1,5 +1,6 @@
 #version 410
 uniform sampler2D mytexture;
+uniform vec2 uvScale = vec2(1.0, 1.0);	//rendered part of the eye texture
 
 noperspective in vec2 v2UVred;
 noperspective in vec2 v2UVgreen;
@@ -16,9 +17,9 @@ void main()
 	}
 	else
 	{
-		float red = texture(mytexture, v2UVred).x;
-		float green = texture(mytexture, v2UVgreen).y;
-		float blue = texture(mytexture, v2UVblue).z;
+		float red = texture(mytexture, v2UVred * uvScale).x;
+		float green = texture(mytexture, v2UVgreen * uvScale).y;
+		float blue = texture(mytexture, v2UVblue * uvScale).z;
 		outputColor = vec4(red, green, blue, 1.0);
 	}
 }
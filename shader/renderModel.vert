@@ -1,5 +1,9 @@
 #version 410
 uniform mat4 matrix;
+uniform int firstModel;
+layout(std140) uniform DeviceModels {
+	mat4 models[64];
+};
 layout(location = 0) in vec4 position;
 layout(location = 1) in vec3 v3NormalIn;
 layout(location = 2) in vec2 v2TexCoordsIn;
@@ -7,5 +11,7 @@ out vec2 v2TexCoord;
 void main()
 {
 	v2TexCoord = v2TexCoordsIn;
-	gl_Position = matrix * vec4(position.xyz, 1);
+
+	// One instance per device drawn with this model
+	gl_Position = matrix * models[firstModel + gl_InstanceID] * vec4(position.xyz, 1);
 }
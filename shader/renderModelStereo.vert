@@ -0,0 +1,21 @@
+#version 410
+uniform mat4 matrices[2];
+uniform int firstModel;
+layout(std140) uniform DeviceModels {
+	mat4 models[64];
+};
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec3 v3NormalIn;
+layout(location = 2) in vec2 v2TexCoordsIn;
+out vec2 v2TexCoord;
+void main()
+{
+	v2TexCoord = v2TexCoordsIn;
+
+	// Two instances per device drawn with this model: gl_InstanceID % 2 is the eye,
+	// it is squeezed to its half of the double-wide target and clipped there
+	int eye = gl_InstanceID % 2;
+	vec4 clipPos = matrices[eye] * models[firstModel + gl_InstanceID / 2] * vec4(position.xyz, 1);
+	gl_ClipDistance[0] = (eye == 0) ? (clipPos.w - clipPos.x) : (clipPos.w + clipPos.x);
+	gl_Position = vec4(clipPos.x * 0.5 + ((eye == 0) ? -0.5 : 0.5) * clipPos.w, clipPos.yzw);
+}
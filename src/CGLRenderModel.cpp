@@ -1,4 +1,10 @@
 #include "CGLRenderModel.h"
+#include "ofxOpenVRRenderModelArena.h"
+#include "ofxOpenVRGpuMemory.h"
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
 
 //-----------------------------------------------------------------------------
 // Purpose: Create/destroy GL Render Models
@@ -10,6 +16,11 @@ CGLRenderModel::CGLRenderModel(const std::string & sRenderModelName)
 	m_glVertArray = 0;
 	m_glVertBuffer = 0;
 	m_glTexture = 0;
+	m_unTextureBytes = 0;
+	m_unVertexCount = 0;
+	m_unFirstIndex = 0;
+	m_nBaseVertex = 0;
+	m_bReady = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -22,6 +33,26 @@ CGLRenderModel::~CGLRenderModel()
 // Purpose: Allocates and populates the GL resources for a render model
 //-----------------------------------------------------------------------------
 bool CGLRenderModel::BInit(const vr::RenderModel_t & vrModel, const vr::RenderModel_TextureMap_t & vrDiffuseTexture)
+{
+	if (!BInitGeometry(vrModel) || !BInitTexture(vrDiffuseTexture.unWidth, vrDiffuseTexture.unHeight))
+	{
+		return false;
+	}
+	UploadTextureRows(vrDiffuseTexture, 0, vrDiffuseTexture.unHeight);
+	FinishTexture();
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: Creates the VAO, vertex and index buffers of a render model
+//-----------------------------------------------------------------------------
+bool CGLRenderModel::BInitGeometry(const vr::RenderModel_t & vrModel)
+{
+	return BInitGeometry(vrModel.rVertexData, vrModel.unVertexCount, vrModel.rIndexData, vrModel.unTriangleCount * 3);
+}
+
+//-----------------------------------------------------------------------------
+bool CGLRenderModel::BInitGeometry(const vr::RenderModel_Vertex_t * pVertices, uint32_t unVertexCount, const uint16_t * pIndices, uint32_t unIndexCount)
 {
 	// create and bind a VAO to hold state for this model
 	glGenVertexArrays(1, &m_glVertArray);
@@ -30,7 +61,8 @@ bool CGLRenderModel::BInit(const vr::RenderModel_t & vrModel, const vr::RenderMo
 	// Populate a vertex buffer
 	glGenBuffers(1, &m_glVertBuffer);
 	glBindBuffer(GL_ARRAY_BUFFER, m_glVertBuffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vr::RenderModel_Vertex_t) * vrModel.unVertexCount, vrModel.rVertexData, GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vr::RenderModel_Vertex_t) * unVertexCount, pVertices, GL_STATIC_DRAW);
+	ofxOpenVRGpuMemory::track(ofxOpenVRGpuMemory::Object::Buffer, m_glVertBuffer, ofxOpenVRGpuCategory::RenderModels, sizeof(vr::RenderModel_Vertex_t) * unVertexCount, "render model vertices");
 
 	// Identify the components in the vertex buffer
 	glEnableVertexAttribArray(0);
@@ -43,19 +75,130 @@ bool CGLRenderModel::BInit(const vr::RenderModel_t & vrModel, const vr::RenderMo
 	// Create and populate the index buffer
 	glGenBuffers(1, &m_glIndexBuffer);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_glIndexBuffer);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * vrModel.unTriangleCount * 3, vrModel.rIndexData, GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * unIndexCount, pIndices, GL_STATIC_DRAW);
+	ofxOpenVRGpuMemory::track(ofxOpenVRGpuMemory::Object::Buffer, m_glIndexBuffer, ofxOpenVRGpuCategory::RenderModels, sizeof(uint16_t) * unIndexCount, "render model indices");
 
 	glBindVertexArray(0);
+	ofxOpenVRGpuMemory::track(ofxOpenVRGpuMemory::Object::VertexArray, m_glVertArray, ofxOpenVRGpuCategory::RenderModels, 0, "render model");
+
+	m_unVertexCount = unIndexCount;
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: Appends the vertices and indices to the shared buffers of the arena
+//-----------------------------------------------------------------------------
+bool CGLRenderModel::BInitGeometry(ofxOpenVRRenderModelArena & arena, const vr::RenderModel_Vertex_t * pVertices, uint32_t unVertexCount, const uint16_t * pIndices, uint32_t unIndexCount)
+{
+	if (!arena.add(pVertices, unVertexCount, pIndices, unIndexCount, m_nBaseVertex, m_unFirstIndex))
+	{
+		return false;
+	}
+
+	m_glVertArray = arena.getVertexArray();
+	m_unVertexCount = unIndexCount;
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: Allocates the diffuse texture, its rows are uploaded by UploadTextureRows
+//-----------------------------------------------------------------------------
+bool CGLRenderModel::BInitTexture(uint32_t unWidth, uint32_t unHeight)
+{
+	if (unWidth == 0 || unHeight == 0)
+	{
+		return false;
+	}
+
+	if (!m_glTexture)
+	{
+		glGenTextures(1, &m_glTexture);
+	}
+	glBindTexture(GL_TEXTURE_2D, m_glTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, unWidth, unHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	m_unTextureBytes = ofxOpenVRGpuMemory::getImageSize(unWidth, unHeight, GL_RGBA8);
+	ofxOpenVRGpuMemory::track(ofxOpenVRGpuMemory::Object::Texture, m_glTexture, ofxOpenVRGpuCategory::RenderModels, m_unTextureBytes, "render model texture");
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: Uploads up to unMaxRows rows of the diffuse texture starting from unFirstRow
+//-----------------------------------------------------------------------------
+uint32_t CGLRenderModel::UploadTextureRows(const vr::RenderModel_TextureMap_t & vrDiffuseTexture, uint32_t unFirstRow, uint32_t unMaxRows)
+{
+	return UploadTextureRows(vrDiffuseTexture.rubTextureMapData, vrDiffuseTexture.unWidth, vrDiffuseTexture.unHeight, unFirstRow, unMaxRows);
+}
+
+//-----------------------------------------------------------------------------
+uint32_t CGLRenderModel::UploadTextureRows(const uint8_t * pRGBA, uint32_t unWidth, uint32_t unHeight, uint32_t unFirstRow, uint32_t unMaxRows)
+{
+	if (unFirstRow >= unHeight)
+	{
+		return 0;
+	}
+	uint32_t unRows = std::min(unMaxRows, unHeight - unFirstRow);
 
-	// create and populate the texture
-	glGenTextures(1, &m_glTexture);
 	glBindTexture(GL_TEXTURE_2D, m_glTexture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, unFirstRow, unWidth, unRows,
+		GL_RGBA, GL_UNSIGNED_BYTE, pRGBA + size_t(unFirstRow) * unWidth * 4);
+	glBindTexture(GL_TEXTURE_2D, 0);
 
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, vrDiffuseTexture.unWidth, vrDiffuseTexture.unHeight,
-		0, GL_RGBA, GL_UNSIGNED_BYTE, vrDiffuseTexture.rubTextureMapData);
+	return unRows;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: Uploads a whole mip level built in advance, see ofxOpenVRRenderModelCache
+//-----------------------------------------------------------------------------
+void CGLRenderModel::UploadTextureLevel(GLint nLevel, uint32_t unWidth, uint32_t unHeight, bool bCompressed, const void * pData, uint32_t unSize)
+{
+	if (!m_glTexture)
+	{
+		glGenTextures(1, &m_glTexture);
+	}
+	glBindTexture(GL_TEXTURE_2D, m_glTexture);
+	if (bCompressed)
+	{
+		glCompressedTexImage2D(GL_TEXTURE_2D, nLevel, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, unWidth, unHeight, 0, unSize, pData);
+	}
+	else
+	{
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glTexImage2D(GL_TEXTURE_2D, nLevel, GL_RGBA, unWidth, unHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, pData);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
 
-	// If this renders black ask McJohn what's wrong.
-	glGenerateMipmap(GL_TEXTURE_2D);
+	size_t unLevelBytes = ofxOpenVRGpuMemory::getImageSize(unWidth, unHeight, bCompressed ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_RGBA8);
+	m_unTextureBytes = (nLevel == 0) ? unLevelBytes : m_unTextureBytes + unLevelBytes;
+	ofxOpenVRGpuMemory::track(ofxOpenVRGpuMemory::Object::Texture, m_glTexture, ofxOpenVRGpuCategory::RenderModels, m_unTextureBytes, "render model texture");
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: Builds mipmaps of the uploaded texture unless they were uploaded,
+// after it the model can be drawn
+//-----------------------------------------------------------------------------
+void CGLRenderModel::FinishTexture(GLint nPrebuiltLevels)
+{
+	glBindTexture(GL_TEXTURE_2D, m_glTexture);
+
+	if (nPrebuiltLevels > 0)
+	{
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, nPrebuiltLevels - 1);
+	}
+	else
+	{
+		// If this renders black ask McJohn what's wrong.
+		glGenerateMipmap(GL_TEXTURE_2D);
+
+		// the mip chain adds a third of the base level
+		m_unTextureBytes += m_unTextureBytes / 3;
+		ofxOpenVRGpuMemory::track(ofxOpenVRGpuMemory::Object::Texture, m_glTexture, ofxOpenVRGpuCategory::RenderModels, m_unTextureBytes, "render model texture");
+	}
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -68,9 +211,7 @@ bool CGLRenderModel::BInit(const vr::RenderModel_t & vrModel, const vr::RenderMo
 
 	glBindTexture(GL_TEXTURE_2D, 0);
 
-	m_unVertexCount = vrModel.unTriangleCount * 3;
-
-	return true;
+	m_bReady = true;
 }
 
 //-----------------------------------------------------------------------------
@@ -80,6 +221,9 @@ void CGLRenderModel::Cleanup()
 {
 	if (m_glVertBuffer)
 	{
+		ofxOpenVRGpuMemory::untrack(ofxOpenVRGpuMemory::Object::Buffer, m_glIndexBuffer);
+		ofxOpenVRGpuMemory::untrack(ofxOpenVRGpuMemory::Object::VertexArray, m_glVertArray);
+		ofxOpenVRGpuMemory::untrack(ofxOpenVRGpuMemory::Object::Buffer, m_glVertBuffer);
 		glDeleteBuffers(1, &m_glIndexBuffer);
 		glDeleteVertexArrays(1, &m_glVertArray);
 		glDeleteBuffers(1, &m_glVertBuffer);
@@ -87,6 +231,15 @@ void CGLRenderModel::Cleanup()
 		m_glVertArray = 0;
 		m_glVertBuffer = 0;
 	}
+	m_glVertArray = 0;	//shared VAO of the arena is freed by the arena
+	if (m_glTexture)
+	{
+		ofxOpenVRGpuMemory::untrack(ofxOpenVRGpuMemory::Object::Texture, m_glTexture);
+		glDeleteTextures(1, &m_glTexture);
+		m_glTexture = 0;
+		m_unTextureBytes = 0;
+	}
+	m_bReady = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -99,7 +252,22 @@ void CGLRenderModel::Draw()
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, m_glTexture);
 
-	glDrawElements(GL_TRIANGLES, m_unVertexCount, GL_UNSIGNED_SHORT, 0);
+	glDrawElementsBaseVertex(GL_TRIANGLES, m_unVertexCount, GL_UNSIGNED_SHORT, (void *)(sizeof(uint16_t) * m_unFirstIndex), m_nBaseVertex);
+
+	glBindVertexArray(0);
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: Draws several instances of the render model
+//-----------------------------------------------------------------------------
+void CGLRenderModel::Draw(GLsizei nInstances)
+{
+	glBindVertexArray(m_glVertArray);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, m_glTexture);
+
+	glDrawElementsInstancedBaseVertex(GL_TRIANGLES, m_unVertexCount, GL_UNSIGNED_SHORT, (void *)(sizeof(uint16_t) * m_unFirstIndex), nInstances, m_nBaseVertex);
 
 	glBindVertexArray(0);
 }
@@ -3,6 +3,8 @@
 #include "ofMain.h"
 #include <openvr.h>
 
+class ofxOpenVRRenderModelArena;
+
 //--------------------------------------------------------------
 class CGLRenderModel {
 public:
@@ -10,15 +12,41 @@ public:
 	~CGLRenderModel();
 
 	bool BInit(const vr::RenderModel_t & vrModel, const vr::RenderModel_TextureMap_t & vrDiffuseTexture);
+
+	// Same as BInit in steps, so the upload can be spread over several frames:
+	// geometry, texture storage, rows of the texture, mipmaps
+	bool BInitGeometry(const vr::RenderModel_t & vrModel);
+	bool BInitGeometry(const vr::RenderModel_Vertex_t * pVertices, uint32_t unVertexCount, const uint16_t * pIndices, uint32_t unIndexCount);
+	// Geometry in a range of the shared buffers, the model doesn't own the VAO and buffers then
+	bool BInitGeometry(ofxOpenVRRenderModelArena & arena, const vr::RenderModel_Vertex_t * pVertices, uint32_t unVertexCount, const uint16_t * pIndices, uint32_t unIndexCount);
+	bool BInitTexture(uint32_t unWidth, uint32_t unHeight);	//RGBA8 level 0
+	uint32_t UploadTextureRows(const vr::RenderModel_TextureMap_t & vrDiffuseTexture, uint32_t unFirstRow, uint32_t unMaxRows);	//returns uploaded rows
+	uint32_t UploadTextureRows(const uint8_t * pRGBA, uint32_t unWidth, uint32_t unHeight, uint32_t unFirstRow, uint32_t unMaxRows);
+	// Whole prebuilt mip level, RGBA8 or BC1
+	void UploadTextureLevel(GLint nLevel, uint32_t unWidth, uint32_t unHeight, bool bCompressed, const void * pData, uint32_t unSize);
+	void FinishTexture(GLint nPrebuiltLevels = 0);	//0 - mipmaps are generated
+	bool IsReady() const { return m_bReady; }
+
 	void Cleanup();
 	void Draw();
+	void Draw(GLsizei nInstances);	//instanced drawing, used for single-pass stereo
 	const std::string & GetName() const { return m_sModelName; }
 
+	// For batched drawing with the shared VAO of the arena
+	GLuint GetTexture() const { return m_glTexture; }
+	GLsizei GetIndexCount() const { return m_unVertexCount; }
+	GLuint GetFirstIndex() const { return m_unFirstIndex; }
+	GLint GetBaseVertex() const { return m_nBaseVertex; }
+
 private:
 	GLuint m_glVertBuffer;
 	GLuint m_glIndexBuffer;
 	GLuint m_glVertArray;
 	GLuint m_glTexture;
+	size_t m_unTextureBytes;
 	GLsizei m_unVertexCount;
+	GLuint m_unFirstIndex;
+	GLint m_nBaseVertex;
+	bool m_bReady;
 	std::string m_sModelName;
 };
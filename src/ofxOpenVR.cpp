@@ -5,46 +5,36 @@
 #define STRINGIFY(A) #A
 #endif
 
+
 //--------------------------------------------------------------
-// Purpose: Helper to get a string from a tracked device 
-//          property and turn it into a std::string
 //--------------------------------------------------------------
-std::string getTrackedDeviceString(vr::IVRSystem *pHmd, vr::TrackedDeviceIndex_t unDevice, vr::TrackedDeviceProperty prop, vr::TrackedPropertyError *peError = NULL)
+void ofxOpenVR::setup(std::function< void(vr::Hmd_Eye) > f)
 {
-	uint32_t unRequiredBufferLen = pHmd->GetStringTrackedDeviceProperty(unDevice, prop, NULL, 0, peError);
-	if (unRequiredBufferLen == 0)
-		return "";
-
-	char *pchBuffer = new char[unRequiredBufferLen];
-	unRequiredBufferLen = pHmd->GetStringTrackedDeviceProperty(unDevice, prop, pchBuffer, unRequiredBufferLen, peError);
-	std::string sResult = pchBuffer;
-	delete[] pchBuffer;
-	return sResult;
+	setup(f, std::make_shared<ofxOpenVRSteamVRBackend>());
 }
 
-
 //--------------------------------------------------------------
-//--------------------------------------------------------------
-void ofxOpenVR::setup(std::function< void(vr::Hmd_Eye) > f)
+void ofxOpenVR::setup(std::function< void(vr::Hmd_Eye) > f, std::shared_ptr<ofxOpenVRBackend> backend)
 {
+	_backend = backend;
 	isCameraShown = false;
+	_bHasCamera = false;
+	_fCameraDepth = 2.0f;
 	// Store the user's callable render function 
 	_callableRenderFunction = f;
 
 	// Initialize vars
 	_bIsGLInit = false;
-	_pHMD = nullptr;
+	_pVR = nullptr;
 
-	trackedCamera = nullptr;
-	trackedCameraHandle = INVALID_TRACKED_CAMERA_HANDLE;
-	m_nCameraFrameWidth = 0;
-	m_nCameraFrameHeight = 0;
-	m_nCameraFrameBufferSize = 0;
-	m_pCameraFrameBuffer = nullptr;
-	frameCounter = 0;
+	_nFrameNumber = 0;
+	_bControllerEventQueue = true;
+	controller_events_.clear();
 
-	_pRenderModels = nullptr;
 	_unLensVAO = 0;
+	_glIDVertBuffer = 0;
+	_glIDIndexBuffer = 0;
+	_uiLensIndexCount.fill(0);
 	_iTrackedControllerCount = 0;
 	_leftControllerDeviceID = -1;
 	_rightControllerDeviceID = -1;
@@ -56,8 +46,43 @@ void ofxOpenVR::setup(std::function< void(vr::Hmd_Eye) > f)
 	_clearColor.set(.08f, .08f, .08f, 1.0f);
 	_bRenderModelForTrackedDevices = false;
 
+	_stereoRenderMode = StereoRenderMode::MultiPass;
+	_bEyeFbosResolved = false;
+	_unStereoQuadVAO = 0;
+	_bHiddenAreaMask = true;
+	_unHiddenAreaVAO = 0;
+	_glIDHiddenAreaBuffer = 0;
+	_uiHiddenAreaVertexCount[vr::Eye_Left] = 0;
+	_uiHiddenAreaVertexCount[vr::Eye_Right] = 0;
+	_iDrawCalls = 0;
+	_iRenderDrawCalls = 0;
+	_iEyeDrawCalls[vr::Eye_Left] = _iEyeDrawCalls[vr::Eye_Right] = 0;
+	_nRenderWidth = _nRenderHeight = 0;
+	_nTargetWidth = _nTargetHeight = 0;
+	_nViewportWidth = _nViewportHeight = 0;
+
+	// Axes of both controllers: 2 controllers x 3 lines, vertices are updated in place by drawControllers()
+	_controllersVbo.clear();
 	_controllersVbo.setMode(OF_PRIMITIVE_LINES);
+	_controllersVbo.setUsage(GL_DYNAMIC_DRAW);
 	_controllersVbo.disableTextures();
+	for (int i = 0; i < 12; i++) {
+		glm::vec3 color(0, 0, 0);
+		color[(i / 2) % 3] = 1.0;  // R, G, B
+		_controllersVbo.addVertex(glm::vec3(0, 0, 0));
+		_controllersVbo.addColor(ofFloatColor(color.x, color.y, color.z));
+	}
+
+	// Quad for draw_using_binded_shader(), vertices are updated in place
+	_previewQuad.clear();
+	_previewQuad.setMode(OF_PRIMITIVE_TRIANGLES);
+	_previewQuad.setUsage(GL_DYNAMIC_DRAW);
+	for (int i = 0; i < 4; i++) {
+		_previewQuad.addVertex(glm::vec3(0, 0, 0));
+		_previewQuad.addTexCoord(glm::vec2(0, 0));
+	}
+	_previewQuad.addTriangle(0, 1, 2);
+	_previewQuad.addTriangle(0, 2, 3);
 
 	init();
 }
@@ -67,44 +92,66 @@ void ofxOpenVR::exit()
 {
 
 	closeVideo();
-	trackedCamera = nullptr;
 
-	if (vr::VRCompositor()->IsMirrorWindowVisible()) {
+	if (_pVR && _pVR->IsMirrorWindowVisible()) {
 		hideMirrorWindow();
 	}
 
-	if (_pHMD)
-	{
-		vr::VR_Shutdown();
-		_pHMD = nullptr;
-	}
+	// Models being loaded hold runtime's data, so they are freed before shutdown
+	_renderModels.clear();
 
-	for (std::vector< CGLRenderModel * >::iterator i = _vecRenderModels.begin(); i != _vecRenderModels.end(); i++)
+	if (_pVR)
 	{
-		delete (*i);
+		_pVR->Shutdown();
+		_pVR = nullptr;
 	}
-	_vecRenderModels.clear();
+	_devices.clear();
+	_controllerStates.fill(ofxOpenVRControllerState());
+	_poseHistory.clear();
 
-	
 
 	if (_bIsGLInit)
 	{
 		glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_FALSE);
 		glDebugMessageCallback(nullptr, nullptr);
-		glDeleteBuffers(1, &_glIDVertBuffer);
-		glDeleteBuffers(1, &_glIDIndexBuffer);
+		releaseDistortion();
 
+		ofxOpenVRGpuMemory::untrackFbo(eyeFbo[vr::Eye_Left]);
+		ofxOpenVRGpuMemory::untrackFbo(eyeFbo[vr::Eye_Right]);
+		ofxOpenVRGpuMemory::untrackFbo(_stereoFbo);
 		eyeFbo[vr::Eye_Left].clear();
 		eyeFbo[vr::Eye_Right].clear();
+		_stereoFbo.clear();
+		_preview.clear();
 
-		if (_unLensVAO != 0)
+		if (_unStereoQuadVAO != 0)
 		{
-			glDeleteVertexArrays(1, &_unLensVAO);
+			ofxOpenVRGpuMemory::untrack(ofxOpenVRGpuMemory::Object::VertexArray, _unStereoQuadVAO);
+			glDeleteVertexArrays(1, &_unStereoQuadVAO);
 		}
 
-		_lensShader.unload();
-		_controllersTransformShader.unload();
-		_renderModelsShader.unload();
+		for (ofShader *pShader : { &_lensShader, &_controllersTransformShader, &_renderModelsShader, &contrast_shader_,
+			&_controllersTransformStereoShader, &_renderModelsStereoShader, &_cameraStereoShader, &_hiddenAreaShader })
+		{
+			ofxOpenVRGpuMemory::untrackShader(*pShader);
+			pShader->unload();
+		}
+		_renderGpuTimer.exit();
+		_profiler.exit();
+
+		if (_unHiddenAreaVAO != 0)
+		{
+			ofxOpenVRGpuMemory::untrack(ofxOpenVRGpuMemory::Object::VertexArray, _unHiddenAreaVAO);
+			ofxOpenVRGpuMemory::untrack(ofxOpenVRGpuMemory::Object::Buffer, _glIDHiddenAreaBuffer);
+			glDeleteVertexArrays(1, &_unHiddenAreaVAO);
+			glDeleteBuffers(1, &_glIDHiddenAreaBuffer);
+		}
+
+		// Everything the addon created is freed by now
+		int nLeaks = ofxOpenVRGpuMemory::reportLeaks();
+		if (nLeaks > 0) {
+			ofLogWarning("ofxOpenVR") << nLeaks << " GL object(s) were not freed on exit";
+		}
 	}
 
 	
@@ -113,11 +160,20 @@ void ofxOpenVR::exit()
 //--------------------------------------------------------------
 void ofxOpenVR::update()
 {
+	_nFrameNumber++;
+	_profiler.beginFrame();
+	_profiler.begin(ofxOpenVRStage::Update);
+
 	// for now as fast as possible
-	if (_pHMD)
+	if (_pVR)
 	{
+		_profiler.begin(ofxOpenVRStage::Events);
+		updateControllerStates();
 		handleInput();	//update controller events queue
+		_profiler.end(ofxOpenVRStage::Events);
+		_profiler.begin(ofxOpenVRStage::Controllers);
 		drawControllers();
+		_profiler.end(ofxOpenVRStage::Controllers);
 	}
 
 	// Spew out the controller and pose count whenever they change.
@@ -130,56 +186,49 @@ void ofxOpenVR::update()
 		printf("PoseCount:%d Controllers:%d\n", _iValidPoseCount, _iTrackedControllerCount);
 	}
 
+	_profiler.begin(ofxOpenVRStage::DevicePoses);
 	updateDevicesMatrixPose();
+	_profiler.end(ofxOpenVRStage::DevicePoses);
 
-	frameCounter++;
-	if (true) {
+	updateCamera();
 
-		frameCounter = 0;
+	if (_bRenderModelForTrackedDevices) {
+		_profiler.begin(ofxOpenVRStage::RenderModels);
+		_renderModels.update();
+		_renderModels.updateBatch(_devices.getActiveDevices(), _rTrackedDevicePose, _rmat4DevicePose);
+		_profiler.end(ofxOpenVRStage::RenderModels);
+	}
 
-		vr::CameraVideoStreamFrameHeader_t frameHeader;
-		vr::EVRTrackedCameraError nCameraError = trackedCamera->GetVideoStreamFrameBuffer(trackedCameraHandle, vr::VRTrackedCameraFrameType_Undistorted, nullptr, 0, &frameHeader, sizeof(frameHeader));
-		if (nCameraError != vr::VRTrackedCameraError_None) return;
-		if (frameHeader.nFrameSequence == m_nLastFrameSequence) {
-			// frame hasn't changed yet, nothing to do
-			return;
-		}
+	_profiler.end(ofxOpenVRStage::Update);
+}
 
-		// Frame has changed, do the more expensive frame buffer copy
-		nCameraError = trackedCamera->GetVideoStreamFrameBuffer(trackedCameraHandle, vr::VRTrackedCameraFrameType_Undistorted, m_pCameraFrameBuffer, m_nCameraFrameBufferSize, &frameHeader, sizeof(frameHeader));
-		if (nCameraError != vr::VRTrackedCameraError_None)
+//--------------------------------------------------------------
+// Purpose: Starts or stops camera streaming to follow its visibility,
+// gets a new camera frame (if any) and queues its upload into the camera texture
+//--------------------------------------------------------------
+void ofxOpenVR::updateCamera()
+{
+	bool bShow = isCameraShown && _bHasCamera;
+	if (bShow != _camera.isStreaming()) {
+		if (!bShow) {
+			closeVideo();
+		}
+		else if (!startVideo()) {
+			ofLogError() << "Unable to start the tracked camera, it is hidden";
+			isCameraShown = false;
 			return;
-
-		m_nLastFrameSequence = frameHeader.nFrameSequence;
-
-		if (isCameraShown) {
-			cameraImg.setFromPixels(m_pCameraFrameBuffer, m_nCameraFrameWidth, m_nCameraFrameHeight, OF_IMAGE_COLOR_ALPHA);
 		}
-		
+	}
+	if (!bShow) return;
 
-		camFbo[vr::Eye_Left].begin();
-		ofClear(0);
-		if (isCameraShown) {
-			ofPushMatrix();
-			ofScale(1, -1, 1);
-			ofTranslate(0, -(int)m_nCameraFrameHeight, 0);
-			cameraImg.draw(0, 0);
-			ofPopMatrix();
-		}
-		camFbo[vr::Eye_Left].end();
-
-		camFbo[vr::Eye_Right].begin();
-		ofClear(0);
-		if (isCameraShown) {
-			ofPushMatrix();
-			ofScale(1, -1, 1);
-			ofTranslate(0, -(int)m_nCameraFrameHeight * 0.5, 0);
-			cameraImg.draw(0, 0);
-			ofPopMatrix();
-		}
-		camFbo[vr::Eye_Right].end();
+	_profiler.begin(ofxOpenVRStage::CameraCopy);
+	bool bNewFrame = _camera.acquireFrame();
+	_profiler.end(ofxOpenVRStage::CameraCopy);
+	if (!bNewFrame) return;
 
-	}
+	_profiler.begin(ofxOpenVRStage::CameraUpload);
+	_camera.uploadFrame();
+	_profiler.end(ofxOpenVRStage::CameraUpload);
 }
 
 //--------------------------------------------------------------
@@ -204,14 +253,49 @@ void ofxOpenVR::popMatricesForRender() {
 void ofxOpenVR::render()
 {
 	// for now as fast as possible
-	if (_pHMD)
+	if (_pVR)
 	{
+		_profiler.begin(ofxOpenVRStage::Render);
+		_iDrawCalls = 0;
+		_renderGpuTimer.begin();
 		renderStereoTargets(); 
-
-		vr::Texture_t leftEyeTexture = { (void*)(uintptr_t)(eyeFbo[vr::Eye_Left].getTexture().getTextureData().textureID), vr::TextureType_OpenGL, vr::ColorSpace_Gamma };
-		vr::VRCompositor()->Submit(vr::Eye_Left, &leftEyeTexture);
-		vr::Texture_t rightEyeTexture = { (void*)(uintptr_t)(eyeFbo[vr::Eye_Right].getTexture().getTextureData().textureID), vr::TextureType_OpenGL, vr::ColorSpace_Gamma };
-		vr::VRCompositor()->Submit(vr::Eye_Right, &rightEyeTexture);
+		_renderGpuTimer.end();
+		_iRenderDrawCalls = _iDrawCalls;
+
+		_profiler.begin(ofxOpenVRStage::Submit);
+
+		// Only the rendered part of the FBOs is submitted (bounds are in GL texture coordinates, rendering starts at (0,0))
+		float uMax = float(_nViewportWidth) / _nTargetWidth;
+		float vMax = float(_nViewportHeight) / _nTargetHeight;
+
+		if (_stereoRenderMode == StereoRenderMode::SinglePassInstanced) {
+			// Both eyes share one texture, the compositor takes the halves
+			vr::Texture_t stereoTexture = { (void*)(uintptr_t)(_stereoFbo.getTexture().getTextureData().textureID), vr::TextureType_OpenGL, vr::ColorSpace_Gamma };
+			vr::VRTextureBounds_t leftBounds = { 0.0f, 0.0f, uMax * 0.5f, vMax };
+			vr::VRTextureBounds_t rightBounds = { uMax * 0.5f, 0.0f, uMax, vMax };
+			_pVR->Submit(vr::Eye_Left, &stereoTexture, &leftBounds);
+			_pVR->Submit(vr::Eye_Right, &stereoTexture, &rightBounds);
+		}
+		else {
+			vr::VRTextureBounds_t bounds = { 0.0f, 0.0f, uMax, vMax };
+			vr::Texture_t leftEyeTexture = { (void*)(uintptr_t)(eyeFbo[vr::Eye_Left].getTexture().getTextureData().textureID), vr::TextureType_OpenGL, vr::ColorSpace_Gamma };
+			_pVR->Submit(vr::Eye_Left, &leftEyeTexture, &bounds);
+			vr::Texture_t rightEyeTexture = { (void*)(uintptr_t)(eyeFbo[vr::Eye_Right].getTexture().getTextureData().textureID), vr::TextureType_OpenGL, vr::ColorSpace_Gamma };
+			_pVR->Submit(vr::Eye_Right, &rightEyeTexture, &bounds);
+		}
+		_profiler.end(ofxOpenVRStage::Submit);
+		_profiler.end(ofxOpenVRStage::Render);
+
+		// One update per measurement, frames without a new result add nothing; the new scale is used starting from the next frame
+		float fGpuMs = 0;
+		uint64_t ulTag = 0;
+		bool bScaleChanged = false;
+		while (_renderGpuTimer.getNextResult(fGpuMs, ulTag)) {
+			bScaleChanged |= _dynamicResolution.update(fGpuMs);
+		}
+		if (bScaleChanged) {
+			updateRenderViewport();
+		}
 	}
 
 	glViewport(0, 0, ofGetWidth(), ofGetHeight());
@@ -220,10 +304,10 @@ void ofxOpenVR::render()
 //--------------------------------------------------------------
 glm::mat4x4 ofxOpenVR::getHMDMatrixProjectionEye(vr::Hmd_Eye nEye)
 {
-	if (!_pHMD)
+	if (!_pVR)
 		return glm::mat4x4();
 
-	vr::HmdMatrix44_t mat = _pHMD->GetProjectionMatrix(nEye, nearClip.get(), farClip.get());
+	vr::HmdMatrix44_t mat = _pVR->GetProjectionMatrix(nEye, nearClip.get(), farClip.get());
 
 	return glm::mat4x4(
 		mat.m[0][0], mat.m[1][0], mat.m[2][0], mat.m[3][0],
@@ -236,9 +320,9 @@ glm::mat4x4 ofxOpenVR::getHMDMatrixProjectionEye(vr::Hmd_Eye nEye)
 //--------------------------------------------------------------
 glm::mat4x4 ofxOpenVR::getHMDMatrixPoseEye(vr::Hmd_Eye nEye)
 {
-	if (!_pHMD) return glm::mat4x4();
+	if (!_pVR) return glm::mat4x4();
 
-	vr::HmdMatrix34_t matEyeRight = _pHMD->GetEyeToHeadTransform(nEye);
+	vr::HmdMatrix34_t matEyeRight = _pVR->GetEyeToHeadTransform(nEye);
 	glm::mat4x4 matrixObj(
 		matEyeRight.m[0][0], matEyeRight.m[1][0], matEyeRight.m[2][0], 0.0,
 		matEyeRight.m[0][1], matEyeRight.m[1][1], matEyeRight.m[2][1], 0.0,
@@ -267,6 +351,13 @@ glm::mat4x4 ofxOpenVR::getCurrentViewMatrix(vr::Hmd_Eye nEye)
 	return _mat4eyePos[nEye] * _mat4HMDPose;
 }
 
+//--------------------------------------------------------------
+glm::mat4x4 ofxOpenVR::getDevicePose(vr::TrackedDeviceIndex_t unDevice)
+{
+	if (unDevice >= vr::k_unMaxTrackedDeviceCount) return glm::mat4x4();
+	return _rmat4DevicePose[unDevice];
+}
+
 //--------------------------------------------------------------
 glm::mat4x4 ofxOpenVR::getControllerPose(int controller)
 {
@@ -302,44 +393,68 @@ int ofxOpenVR::toDeviceId(int controller) {
 }
 
 //--------------------------------------------------------------
-float ofxOpenVR::getTriggerState(int controller) {
-	if (!_pHMD) return 0;
-	int id = toDeviceId(controller);
-	if (_pHMD->IsTrackedDeviceConnected(id)) {
+// Purpose: Reads state of all connected controllers, once per frame.
+// Accessors below and processVREvent() use this snapshot instead of calling the runtime.
+//--------------------------------------------------------------
+void ofxOpenVR::updateControllerStates() {
+	// Disconnected controllers lose their state, so a reconnected one starts from scratch
+	std::array<bool, vr::k_unMaxTrackedDeviceCount> bConnected = {};
+	for (vr::TrackedDeviceIndex_t nDevice : _devices.getActiveDevices()) {
+		bConnected[nDevice] = (_devices.getClass(nDevice) == vr::TrackedDeviceClass_Controller);
+	}
+	for (vr::TrackedDeviceIndex_t nDevice = 0; nDevice < vr::k_unMaxTrackedDeviceCount; nDevice++) {
+		if (!bConnected[nDevice]) _controllerStates[nDevice] = ofxOpenVRControllerState();
+	}
+
+	for (vr::TrackedDeviceIndex_t nDevice : _devices.getActiveDevices()) {
+		if (!bConnected[nDevice]) continue;
+
 		vr::VRControllerState_t state;
-		bool res = _pHMD->GetControllerState(id, &state, sizeof(state));
-		if (res) return state.rAxis[1].x;
-		/*cout << "controller " << controller + 1 << " id " << id << "  ";
-		if (!res) {
-			cout << "error" << endl;
+		ofxOpenVRControllerState &snapshot = _controllerStates[nDevice];
+		if (!_pVR->GetControllerState(nDevice, &state, sizeof(state))) {
+			snapshot = ofxOpenVRControllerState();
+			continue;
+		}
+
+		// bValid - the snapshot holds a received state; same packet - nothing changed since the last frame.
+		if (snapshot.bValid && state.unPacketNum == snapshot.unPacketNum) continue;
+
+		snapshot.bValid = true;
+		snapshot.unPacketNum = state.unPacketNum;
+		snapshot.nFrameChanged = _nFrameNumber;
+		snapshot.ulButtonPressed = state.ulButtonPressed;
+		snapshot.ulButtonTouched = state.ulButtonTouched;
+		for (uint32_t j = 0; j < vr::k_unControllerStateAxisCount; j++) {
+			snapshot.axis[j] = glm::vec2(state.rAxis[j].x, state.rAxis[j].y);
 		}
-		else {
-			cout << "packet " << state.unPacketNum
-				<< ", press " << state.ulButtonPressed
-				<< ", touch " << state.ulButtonTouched;
-			cout << "  axis ";
-			for (int j = 0; j < vr::k_unControllerStateAxisCount; j++) {
-				cout << "(" << state.rAxis[j].x << ", " << state.rAxis[j].y << ")";
-			}
-			cout << endl;
-		}*/
 	}
+}
+
+//--------------------------------------------------------------
+const ofxOpenVRControllerState &ofxOpenVR::getControllerStateForDevice(vr::TrackedDeviceIndex_t unDevice) {
+	static const ofxOpenVRControllerState empty;
+	if (unDevice >= vr::k_unMaxTrackedDeviceCount) return empty;
+	return _controllerStates[unDevice];
+}
+
+//--------------------------------------------------------------
+const ofxOpenVRControllerState &ofxOpenVR::getControllerState(int controller) {
+	return getControllerStateForDevice(toDeviceId(controller));
+}
+
+//--------------------------------------------------------------
+float ofxOpenVR::getTriggerState(int controller) {
+	const ofxOpenVRControllerState &state = getControllerState(controller);
+	if (state.bValid) return state.axis[1].x;
 	return 0;
 }
 
 //--------------------------------------------------------------
 glm::vec3 ofxOpenVR::getTrackPadState(int controller) {
-	if (!_pHMD) return ofPoint();
-	int id = (controller == 0) ? _leftControllerDeviceID : _rightControllerDeviceID;
-	if (_pHMD->IsTrackedDeviceConnected(id)) {
-		vr::VRControllerState_t state;
-		bool res = _pHMD->GetControllerState(id, &state, sizeof(state));
-		if (res) {
-			bool touched = state.ulButtonTouched & 4294967296;  //this constant is 2^vk::k_EButton_SteamVR_Touchpad
-			//cout << state.ulButtonTouched << endl;
-			if (touched) return glm::vec3(state.rAxis[0].x, state.rAxis[0].y, 0);
-			else return glm::vec3(-1000, -1000, 0);
-		}
+	const ofxOpenVRControllerState &state = getControllerState(controller);
+	if (state.bValid) {
+		if (state.isTouched(vr::k_EButton_SteamVR_Touchpad)) return glm::vec3(state.axis[0].x, state.axis[0].y, 0);
+		else return glm::vec3(-1000, -1000, 0);
 	}
 	return glm::vec3();
 }
@@ -356,13 +471,13 @@ glm::vec3 ofxOpenVR::getTrackPadState(int controller) {
 bool ofxOpenVR::isControllerConnected(int controller)
 {
 	vr::ETrackedControllerRole nController = toControllerRole(controller);
-	if (_pHMD) {
+	if (_pVR) {
 		if (_iTrackedControllerCount > 0) {
 			if (nController == vr::TrackedControllerRole_LeftHand) {
-				return _pHMD->IsTrackedDeviceConnected(_leftControllerDeviceID);
+				return _devices.isConnected(_leftControllerDeviceID);
 			}
 			else if (nController == vr::TrackedControllerRole_RightHand) {
-				return _pHMD->IsTrackedDeviceConnected(_rightControllerDeviceID);
+				return _devices.isConnected(_rightControllerDeviceID);
 			}
 		}
 	}
@@ -376,6 +491,85 @@ void ofxOpenVR::setDrawControllers(bool bDrawControllers)
 	_bDrawControllers = bDrawControllers;
 }
 
+//--------------------------------------------------------------
+void ofxOpenVR::setStereoRenderMode(StereoRenderMode mode)
+{
+	_stereoRenderMode = mode;
+
+	// The double-wide target is allocated only when it is needed
+	if (_stereoRenderMode == StereoRenderMode::SinglePassInstanced && _bIsGLInit && !_stereoFbo.isAllocated()) {
+		createStereoFrameBuffer(_nTargetWidth, _nTargetHeight);
+	}
+}
+
+//--------------------------------------------------------------
+void ofxOpenVR::setSinglePassRenderFunction(std::function< void() > f)
+{
+	_callableSinglePassRenderFunction = f;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVR::setDynamicResolution(const ofxOpenVRDynamicResolutionSettings &settings)
+{
+	_dynamicResolution.setup(settings);
+
+	if (_bIsGLInit) {
+		// Reallocate FBOs if they are too small (or too big) for the new maxScale
+		float maxScale = settings.enabled ? _dynamicResolution.getSettings().maxScale : 1.0f;
+		if ((uint32_t)ceil(_nRenderWidth * maxScale) != _nTargetWidth || (uint32_t)ceil(_nRenderHeight * maxScale) != _nTargetHeight) {
+			setupStereoRenderTargets();
+		}
+		updateRenderViewport();
+	}
+}
+
+//--------------------------------------------------------------
+void ofxOpenVR::setDistortionMesh(const ofxOpenVRDistortionMeshSettings &settings)
+{
+	_distortionMeshSettings = settings;
+
+	if (_bIsGLInit) {
+		releaseDistortion();
+		setupDistortion();
+	}
+}
+
+//--------------------------------------------------------------
+void ofxOpenVR::setProfilingEnabled(bool bEnabled)
+{
+	_profiler.setEnabled(bEnabled);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVR::setHiddenAreaMask(bool bMask)
+{
+	_bHiddenAreaMask = bMask;
+}
+
+//--------------------------------------------------------------
+float ofxOpenVR::getRenderGpuMs()
+{
+	return _renderGpuTimer.getLastMs();
+}
+
+//--------------------------------------------------------------
+void ofxOpenVR::updateRenderViewport()
+{
+	_nViewportWidth = min(_nTargetWidth, (uint32_t)round(_nRenderWidth * _dynamicResolution.getScale()));
+	_nViewportHeight = min(_nTargetHeight, (uint32_t)round(_nRenderHeight * _dynamicResolution.getScale()));
+	_bEyeFbosResolved = false;
+}
+
+//--------------------------------------------------------------
+// Purpose: Restricts rendering to the current part of an eye FBO, called after eyeFbo[].begin()
+//--------------------------------------------------------------
+void ofxOpenVR::setupRenderViewport()
+{
+	ofViewport(0, 0, _nViewportWidth, _nViewportHeight, false);
+	// 2D drawing keeps the coordinates of the recommended size
+	ofSetupScreenPerspective(_nRenderWidth, _nRenderHeight);
+}
+
 //--------------------------------------------------------------
 void ofxOpenVR::setClearColor(ofFloatColor color)
 {
@@ -385,23 +579,26 @@ void ofxOpenVR::setClearColor(ofFloatColor color)
 //--------------------------------------------------------------
 void ofxOpenVR::showMirrorWindow()
 {
-	vr::VRCompositor()->ShowMirrorWindow();
+	if (!_pVR) return;
+	_pVR->ShowMirrorWindow();
 }
 
 //--------------------------------------------------------------
 void ofxOpenVR::hideMirrorWindow()
 {
-	vr::VRCompositor()->HideMirrorWindow();
+	if (!_pVR) return;
+	_pVR->HideMirrorWindow();
 }
 
 //--------------------------------------------------------------
 void ofxOpenVR::toggleMirrorWindow()
 {
-	if (vr::VRCompositor()->IsMirrorWindowVisible()) {
-		vr::VRCompositor()->HideMirrorWindow();
+	if (!_pVR) return;
+	if (_pVR->IsMirrorWindowVisible()) {
+		_pVR->HideMirrorWindow();
 	}
 	else {
-		vr::VRCompositor()->ShowMirrorWindow();
+		_pVR->ShowMirrorWindow();
 	}
 }
 
@@ -409,7 +606,7 @@ void ofxOpenVR::toggleMirrorWindow()
 void ofxOpenVR::toggleGrid(float transitionDuration)
 {
 	_bIsGridVisible = !_bIsGridVisible;
-	vr::VRCompositor()->FadeGrid(transitionDuration, _bIsGridVisible);
+	if (_pVR) _pVR->FadeGrid(transitionDuration, _bIsGridVisible);
 }
 
 //--------------------------------------------------------------
@@ -417,7 +614,7 @@ void ofxOpenVR::showGrid(float transitionDuration)
 {
 	if (!_bIsGridVisible) {
 		_bIsGridVisible = true;
-		vr::VRCompositor()->FadeGrid(transitionDuration, _bIsGridVisible);
+		if (_pVR) _pVR->FadeGrid(transitionDuration, _bIsGridVisible);
 	}
 }
 
@@ -426,42 +623,37 @@ void ofxOpenVR::hideGrid(float transitionDuration)
 {
 	if (_bIsGridVisible) {
 		_bIsGridVisible = false;
-		vr::VRCompositor()->FadeGrid(transitionDuration, _bIsGridVisible);
+		if (_pVR) _pVR->FadeGrid(transitionDuration, _bIsGridVisible);
 	}
 }
 
 //--------------------------------------------------------------
 bool ofxOpenVR::init()
 {
-	// Loading the SteamVR Runtime
-	vr::EVRInitError eError = vr::VRInitError_None;
-	_pHMD = vr::VR_Init(&eError, vr::VRApplication_Scene);
-
-	if (eError != vr::VRInitError_None)
-	{
-		_pHMD = NULL;
-		char buf[1024];
-		sprintf_s(buf, sizeof(buf), "Unable to init VR runtime: %s", vr::VR_GetVRInitErrorAsEnglishDescription(eError));
+	// Loading the runtime (SteamVR or fake)
+	if (!_backend) {
+		ofLogError() << "Unable to init VR runtime: no backend";
 		return false;
 	}
 
-	// This is not used for now
-	_pRenderModels = (vr::IVRRenderModels *)vr::VR_GetGenericInterface(vr::IVRRenderModels_Version, &eError);
-	if (!_pRenderModels)
+	vr::EVRInitError eError = _backend->Init();
+	if (eError != vr::VRInitError_None)
 	{
-		_pHMD = NULL;
-		vr::VR_Shutdown();
-
-		char buf[1024];
-		sprintf_s(buf, sizeof(buf), "Unable to get render model interface: %s", vr::VR_GetVRInitErrorAsEnglishDescription(eError));
+		ofLogError() << "Unable to init VR runtime: " << _backend->GetInitErrorDescription(eError);
 		return false;
 	}
+	_pVR = _backend.get();
+	_devices.setup(_pVR);
 
 	_strTrackingSystemName = "No Driver";
 	_strTrackingSystemModelNumber = "No Display";
 
-	_strTrackingSystemName = getTrackedDeviceString(_pHMD, vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_TrackingSystemName_String);
-	_strTrackingSystemModelNumber = getTrackedDeviceString(_pHMD, vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_ModelNumber_String);
+	_strTrackingSystemName = ofxOpenVRDeviceRegistry::getDeviceString(_pVR, vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_TrackingSystemName_String);
+	_strTrackingSystemModelNumber = ofxOpenVRDeviceRegistry::getDeviceString(_pVR, vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_ModelNumber_String);
+
+	// IVRSystem_019 has no GetRuntimeVersion(), the HMD driver's version changes with runtime updates
+	_strRuntimeVersion = _strTrackingSystemName + " " + ofxOpenVRDeviceRegistry::getDeviceString(_pVR, vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_DriverVersion_String);
+	_renderModels.setup(_pVR, _strRuntimeVersion);
 
 	// TODO: parameterize!
 	nearClip = 0.1f;
@@ -480,35 +672,28 @@ bool ofxOpenVR::init()
 		return false;
 	}
 
-	// Init tracked camera
-	trackedCamera = vr::VRTrackedCamera();
-	
-	if (!trackedCamera) {
-		ofLogError() << "Unable to get Tracked Camera interface.";
-		return false;
+	// Init tracked camera. It is optional: without it the passthrough can't be shown.
+	// Streaming starts only when the camera is shown, see updateCamera()
+	_bHasCamera = false;
+	if (!_pVR->HasTrackedCamera()) {
+		ofLogNotice() << "Unable to get Tracked Camera interface.";
+		return true;
 	}
 
-	bool bHasCamera = false;
-	vr::EVRTrackedCameraError nCameraError = trackedCamera->HasCamera(vr::k_unTrackedDeviceIndex_Hmd, &bHasCamera);
-	
-
-
-	if (nCameraError != vr::VRTrackedCameraError_None || !bHasCamera) {
-		ofLogError() << "No Tracked Camera Available! ( " << trackedCamera->GetCameraErrorNameFromEnum(nCameraError) << ")";
-		return false;
+	vr::EVRTrackedCameraError nCameraError = _pVR->HasCamera(vr::k_unTrackedDeviceIndex_Hmd, &_bHasCamera);
+	if (nCameraError != vr::VRTrackedCameraError_None || !_bHasCamera) {
+		ofLogNotice() << "No Tracked Camera Available! ( " << _pVR->GetCameraErrorNameFromEnum(nCameraError) << ")";
+		_bHasCamera = false;
+		return true;
 	}
 
 	vr::ETrackedPropertyError propertyError;
 	char buffer[128];
-	_pHMD->GetStringTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_CameraFirmwareDescription_String, buffer, sizeof(buffer), &propertyError);
-	if (propertyError != vr::TrackedProp_Success) {
-		ofLogError() << "Failed to get tracked camera firmware description!\n";
-		return false;
+	_pVR->GetStringTrackedDeviceProperty(vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_CameraFirmwareDescription_String, buffer, sizeof(buffer), &propertyError);
+	if (propertyError == vr::TrackedProp_Success) {
+		ofLogNotice() << "Camera Firmware: " << buffer;
 	}
 
-	ofLogNotice() << "Camera Firmware: " << buffer;
-	if (bHasCamera) startVideo();
-
 	return true;
 }
 
@@ -522,6 +707,14 @@ bool ofxOpenVR::initGL()
 		return false;
 
 	setupDistortion();
+	setupHiddenAreaMesh();
+
+	_renderGpuTimer.setup();
+	_profiler.setup();
+
+	// Camera quad is generated from gl_VertexID, but core profile still needs a VAO
+	glGenVertexArrays(1, &_unStereoQuadVAO);
+	ofxOpenVRGpuMemory::track(ofxOpenVRGpuMemory::Object::VertexArray, _unStereoQuadVAO, ofxOpenVRGpuCategory::Other, 0, "stereo quad");
 
 	return true;
 }
@@ -531,7 +724,7 @@ bool ofxOpenVR::initCompositor()
 {
 	vr::EVRInitError peError = vr::VRInitError_None;
 
-	if (!vr::VRCompositor())
+	if (!_pVR->HasCompositor())
 	{
 		printf("Compositor initialization failed. See log file for details\n");
 		return false;
@@ -551,154 +744,138 @@ bool ofxOpenVR::createAllShaders()
 	_renderModelsShader.load(shaderPath + "renderModel");
 	contrast_shader_.load(shaderPath + "contrast");
 
+	// Single-pass stereo versions, fragment shaders are shared
+	_controllersTransformStereoShader.load(shaderPath + "controllerTransformStereo.vert", shaderPath + "controllerTransform.frag");
+	_renderModelsStereoShader.load(shaderPath + "renderModelStereo.vert", shaderPath + "renderModel.frag");
+	_cameraStereoShader.load(shaderPath + "cameraStereo");
+	_hiddenAreaShader.load(shaderPath + "hiddenArea");
+
+	// Render models take device matrices from the batch's uniform buffer
+	ofxOpenVRRenderModels::setupShader(_renderModelsShader);
+	ofxOpenVRRenderModels::setupShader(_renderModelsStereoShader);
+
+	ofxOpenVRGpuMemory::trackShader(_controllersTransformShader, "controllerTransform");
+	ofxOpenVRGpuMemory::trackShader(_lensShader, "lens");
+	ofxOpenVRGpuMemory::trackShader(_renderModelsShader, "renderModel");
+	ofxOpenVRGpuMemory::trackShader(contrast_shader_, "contrast");
+	ofxOpenVRGpuMemory::trackShader(_controllersTransformStereoShader, "controllerTransformStereo");
+	ofxOpenVRGpuMemory::trackShader(_renderModelsStereoShader, "renderModelStereo");
+	ofxOpenVRGpuMemory::trackShader(_cameraStereoShader, "cameraStereo");
+	ofxOpenVRGpuMemory::trackShader(_hiddenAreaShader, "hiddenArea");
+
 	return true;
 }
 
 //--------------------------------------------------------------
 bool ofxOpenVR::createFrameBuffer(int nWidth, int nHeight, vr::Hmd_Eye eye)
 {
-	ofDisableArbTex();
-	eyeFbo[eye].allocate(nWidth, nHeight, GL_RGBA);
-	ofEnableArbTex();
+	ofFbo::Settings settings = getEyeFboSettings(nWidth, nHeight);
+	ofxOpenVRGpuMemory::untrackFbo(eyeFbo[eye]);
+	eyeFbo[eye].allocate(settings);
+	ofxOpenVRGpuMemory::trackFbo(eyeFbo[eye], settings, ofxOpenVRGpuCategory::EyeBuffers, (eye == vr::Eye_Left) ? "left eye" : "right eye");
 
 	return true;
 }
 
 //--------------------------------------------------------------
-bool ofxOpenVR::setupStereoRenderTargets()
+bool ofxOpenVR::createStereoFrameBuffer(int nWidth, int nHeight)
 {
-	if (!_pHMD) return false;
-	_pHMD->GetRecommendedRenderTargetSize(&_nRenderWidth, &_nRenderHeight);
-
-	ofLogNotice() << "render size (per eye): " << _nRenderWidth << " x " << _nRenderHeight;
-
-	if (!createFrameBuffer(_nRenderWidth, _nRenderHeight, vr::Eye_Left)) return false;
-	if (!createFrameBuffer(_nRenderWidth, _nRenderHeight, vr::Eye_Right)) return false;
+	ofFbo::Settings settings = getEyeFboSettings(nWidth * 2, nHeight);
+	ofxOpenVRGpuMemory::untrackFbo(_stereoFbo);
+	_stereoFbo.allocate(settings);
+	ofxOpenVRGpuMemory::trackFbo(_stereoFbo, settings, ofxOpenVRGpuCategory::EyeBuffers, "stereo");
 
 	return true;
 }
 
 //--------------------------------------------------------------
-void ofxOpenVR::setupDistortion()
+// Purpose: Eye targets have a packed depth-stencil buffer, 
+//          depth for renderScene() and stencil for the hidden area mask
+//--------------------------------------------------------------
+ofFbo::Settings ofxOpenVR::getEyeFboSettings(int nWidth, int nHeight)
 {
-	if (!_pHMD)
-		return;
-
-	GLushort _iLensGridSegmentCountH = 43;
-	GLushort _iLensGridSegmentCountV = 43;
-
-	float w = (float)(1.0 / float(_iLensGridSegmentCountH - 1));
-	float h = (float)(1.0 / float(_iLensGridSegmentCountV - 1));
-
-	float u, v = 0;
-
-	std::vector<VertexDataLens> vVerts(0);
-	VertexDataLens vert;
-
-	//left eye distortion verts
-	float Xoffset = -1;
-	for (int y = 0; y<_iLensGridSegmentCountV; y++)
-	{
-		for (int x = 0; x<_iLensGridSegmentCountH; x++)
-		{
-			u = x*w; v = 1 - y*h;
-			vert.position = glm::vec2(Xoffset + u, -1 + 2 * y*h);
+	ofFbo::Settings settings;
+	settings.width = nWidth;
+	settings.height = nHeight;
+	settings.internalformat = GL_RGBA;
+	settings.textureTarget = GL_TEXTURE_2D;
+	settings.useDepth = true;
+	settings.useStencil = true;
+	settings.depthStencilInternalFormat = GL_DEPTH24_STENCIL8;
+	return settings;
+}
 
-			vr::DistortionCoordinates_t dc0;
-			_pHMD->ComputeDistortion(vr::Eye_Left, u, v, &dc0);
+//--------------------------------------------------------------
+bool ofxOpenVR::setupStereoRenderTargets()
+{
+	if (!_pVR) return false;
+	_pVR->GetRecommendedRenderTargetSize(&_nRenderWidth, &_nRenderHeight);
 
-			vert.texCoordRed = glm::vec2(dc0.rfRed[0], 1 - dc0.rfRed[1]);
-			vert.texCoordGreen = glm::vec2(dc0.rfGreen[0], 1 - dc0.rfGreen[1]);
-			vert.texCoordBlue = glm::vec2(dc0.rfBlue[0], 1 - dc0.rfBlue[1]);
+	ofLogNotice() << "render size (per eye): " << _nRenderWidth << " x " << _nRenderHeight;
 
-			vVerts.push_back(vert);
-		}
+	// With dynamic resolution FBOs are allocated for the maximal scale, and only a part of them is rendered
+	float maxScale = _dynamicResolution.getSettings().enabled ? _dynamicResolution.getSettings().maxScale : 1.0f;
+	_nTargetWidth = (uint32_t)ceil(_nRenderWidth * maxScale);
+	_nTargetHeight = (uint32_t)ceil(_nRenderHeight * maxScale);
+	if (_nTargetWidth != _nRenderWidth || _nTargetHeight != _nRenderHeight) {
+		ofLogNotice() << "eye FBO size: " << _nTargetWidth << " x " << _nTargetHeight;
 	}
 
-	//right eye distortion verts
-	Xoffset = 0;
-	for (int y = 0; y<_iLensGridSegmentCountV; y++)
-	{
-		for (int x = 0; x<_iLensGridSegmentCountH; x++)
-		{
-			u = x*w; v = 1 - y*h;
-			vert.position = glm::vec2(Xoffset + u, -1 + 2 * y*h);
+	if (!createFrameBuffer(_nTargetWidth, _nTargetHeight, vr::Eye_Left)) return false;
+	if (!createFrameBuffer(_nTargetWidth, _nTargetHeight, vr::Eye_Right)) return false;
 
-			vr::DistortionCoordinates_t dc0;
-			_pHMD->ComputeDistortion(vr::Eye_Right, u, v, &dc0);
+	if (_stereoRenderMode == StereoRenderMode::SinglePassInstanced) {
+		if (!createStereoFrameBuffer(_nTargetWidth, _nTargetHeight)) return false;
+	}
 
-			vert.texCoordRed = glm::vec2(dc0.rfRed[0], 1 - dc0.rfRed[1]);
-			vert.texCoordGreen = glm::vec2(dc0.rfGreen[0], 1 - dc0.rfGreen[1]);
-			vert.texCoordBlue = glm::vec2(dc0.rfBlue[0], 1 - dc0.rfBlue[1]);
+	updateRenderViewport();
 
-			vVerts.push_back(vert);
-		}
-	}
+	return true;
+}
 
-	std::vector<GLushort> vIndices;
-	GLushort a, b, c, d;
+//--------------------------------------------------------------
+// Purpose: Loads the lens mesh from the cache or computes it, see ofxOpenVRDistortionMesh.h
+//--------------------------------------------------------------
+void ofxOpenVR::setupDistortion()
+{
+	if (!_pVR)
+		return;
 
-	GLushort offset = 0;
-	for (GLushort y = 0; y<_iLensGridSegmentCountV - 1; y++)
-	{
-		for (GLushort x = 0; x<_iLensGridSegmentCountH - 1; x++)
-		{
-			a = _iLensGridSegmentCountH*y + x + offset;
-			b = _iLensGridSegmentCountH*y + x + 1 + offset;
-			c = (y + 1)*_iLensGridSegmentCountH + x + 1 + offset;
-			d = (y + 1)*_iLensGridSegmentCountH + x + offset;
-			vIndices.push_back(a);
-			vIndices.push_back(b);
-			vIndices.push_back(c);
-
-			vIndices.push_back(a);
-			vIndices.push_back(c);
-			vIndices.push_back(d);
-		}
-	}
+	std::string sSerial = ofxOpenVRDeviceRegistry::getDeviceString(_pVR, vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_SerialNumber_String);
+	ofxOpenVRDistortionMesh mesh;
+	if (!mesh.build(_pVR, sSerial, _strRuntimeVersion, _distortionMeshSettings))
+		return;
 
-	offset = (_iLensGridSegmentCountH)*(_iLensGridSegmentCountV);
-	for (GLushort y = 0; y<_iLensGridSegmentCountV - 1; y++)
-	{
-		for (GLushort x = 0; x<_iLensGridSegmentCountH - 1; x++)
-		{
-			a = _iLensGridSegmentCountH*y + x + offset;
-			b = _iLensGridSegmentCountH*y + x + 1 + offset;
-			c = (y + 1)*_iLensGridSegmentCountH + x + 1 + offset;
-			d = (y + 1)*_iLensGridSegmentCountH + x + offset;
-			vIndices.push_back(a);
-			vIndices.push_back(b);
-			vIndices.push_back(c);
-
-			vIndices.push_back(a);
-			vIndices.push_back(c);
-			vIndices.push_back(d);
-		}
-	}
-	_uiIndexSize = vIndices.size();
+	const std::vector<ofxOpenVRLensVertex> &vVerts = mesh.getVertices();
+	const std::vector<GLushort> &vIndices = mesh.getIndices();
+	_uiLensIndexCount[vr::Eye_Left] = mesh.getIndexCount(vr::Eye_Left);
+	_uiLensIndexCount[vr::Eye_Right] = mesh.getIndexCount(vr::Eye_Right);
 
 	glGenVertexArrays(1, &_unLensVAO);
 	glBindVertexArray(_unLensVAO);
+	ofxOpenVRGpuMemory::track(ofxOpenVRGpuMemory::Object::VertexArray, _unLensVAO, ofxOpenVRGpuCategory::Lens, 0, "lens");
 
 	glGenBuffers(1, &_glIDVertBuffer);
 	glBindBuffer(GL_ARRAY_BUFFER, _glIDVertBuffer);
-	glBufferData(GL_ARRAY_BUFFER, vVerts.size() * sizeof(VertexDataLens), &vVerts[0], GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, vVerts.size() * sizeof(ofxOpenVRLensVertex), &vVerts[0], GL_STATIC_DRAW);
+	ofxOpenVRGpuMemory::track(ofxOpenVRGpuMemory::Object::Buffer, _glIDVertBuffer, ofxOpenVRGpuCategory::Lens, vVerts.size() * sizeof(ofxOpenVRLensVertex), "lens vertices");
 
 	glGenBuffers(1, &_glIDIndexBuffer);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _glIDIndexBuffer);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, vIndices.size() * sizeof(GLushort), &vIndices[0], GL_STATIC_DRAW);
+	ofxOpenVRGpuMemory::track(ofxOpenVRGpuMemory::Object::Buffer, _glIDIndexBuffer, ofxOpenVRGpuCategory::Lens, vIndices.size() * sizeof(GLushort), "lens indices");
 
 	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(VertexDataLens), (void *)offsetof(VertexDataLens, position));
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(ofxOpenVRLensVertex), (void *)offsetof(ofxOpenVRLensVertex, position));
 
 	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(VertexDataLens), (void *)offsetof(VertexDataLens, texCoordRed));
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(ofxOpenVRLensVertex), (void *)offsetof(ofxOpenVRLensVertex, texCoordRed));
 
 	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(VertexDataLens), (void *)offsetof(VertexDataLens, texCoordGreen));
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(ofxOpenVRLensVertex), (void *)offsetof(ofxOpenVRLensVertex, texCoordGreen));
 
 	glEnableVertexAttribArray(3);
-	glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(VertexDataLens), (void *)offsetof(VertexDataLens, texCoordBlue));
+	glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(ofxOpenVRLensVertex), (void *)offsetof(ofxOpenVRLensVertex, texCoordBlue));
 
 	glBindVertexArray(0);
 
@@ -711,6 +888,74 @@ void ofxOpenVR::setupDistortion()
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
+//--------------------------------------------------------------
+void ofxOpenVR::releaseDistortion()
+{
+	if (_unLensVAO != 0)
+	{
+		ofxOpenVRGpuMemory::untrack(ofxOpenVRGpuMemory::Object::VertexArray, _unLensVAO);
+		ofxOpenVRGpuMemory::untrack(ofxOpenVRGpuMemory::Object::Buffer, _glIDVertBuffer);
+		ofxOpenVRGpuMemory::untrack(ofxOpenVRGpuMemory::Object::Buffer, _glIDIndexBuffer);
+		glDeleteVertexArrays(1, &_unLensVAO);
+		glDeleteBuffers(1, &_glIDVertBuffer);
+		glDeleteBuffers(1, &_glIDIndexBuffer);
+	}
+	_unLensVAO = 0;
+	_glIDVertBuffer = 0;
+	_glIDIndexBuffer = 0;
+	_uiLensIndexCount.fill(0);
+}
+
+//--------------------------------------------------------------
+// Purpose: Loads hidden area meshes of both eyes into one vertex buffer,
+//          left eye's triangles go first
+//--------------------------------------------------------------
+void ofxOpenVR::setupHiddenAreaMesh()
+{
+	if (!_pVR)
+		return;
+
+	std::array<vr::HiddenAreaMesh_t, 2> meshes;
+	for (int i = 0; i < 2; i++) {
+		vr::Hmd_Eye nEye = toEye(i);
+		meshes[i] = _pVR->GetHiddenAreaMesh(nEye, vr::k_eHiddenAreaMesh_Standard);
+		_uiHiddenAreaVertexCount[nEye] = (meshes[i].pVertexData) ? meshes[i].unTriangleCount * 3 : 0;
+	}
+
+	// x, y - normalized device coordinates, z - eye
+	std::vector<glm::vec3> vVerts;
+	vVerts.reserve(_uiHiddenAreaVertexCount[vr::Eye_Left] + _uiHiddenAreaVertexCount[vr::Eye_Right]);
+	for (int i = 0; i < 2; i++) {
+		vr::Hmd_Eye nEye = toEye(i);
+		const vr::HiddenAreaMesh_t &mesh = meshes[i];
+		for (uint32_t v = 0; v < _uiHiddenAreaVertexCount[nEye]; v++) {
+			// Mesh is in [0,1] with (0,0) at the upper left of the eye's image
+			const vr::HmdVector2_t &p = mesh.pVertexData[v];
+			vVerts.push_back(glm::vec3(p.v[0] * 2 - 1, 1 - p.v[1] * 2, float(i)));
+		}
+	}
+
+	if (vVerts.empty()) {
+		ofLogNotice() << "Hidden area mesh is not provided by the HMD";
+		return;
+	}
+
+	glGenVertexArrays(1, &_unHiddenAreaVAO);
+	glBindVertexArray(_unHiddenAreaVAO);
+
+	glGenBuffers(1, &_glIDHiddenAreaBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, _glIDHiddenAreaBuffer);
+	glBufferData(GL_ARRAY_BUFFER, vVerts.size() * sizeof(glm::vec3), &vVerts[0], GL_STATIC_DRAW);
+	ofxOpenVRGpuMemory::track(ofxOpenVRGpuMemory::Object::VertexArray, _unHiddenAreaVAO, ofxOpenVRGpuCategory::Lens, 0, "hidden area");
+	ofxOpenVRGpuMemory::track(ofxOpenVRGpuMemory::Object::Buffer, _glIDHiddenAreaBuffer, ofxOpenVRGpuCategory::Lens, vVerts.size() * sizeof(glm::vec3), "hidden area vertices");
+
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void *)0);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 //--------------------------------------------------------------
 void ofxOpenVR::setupCameras()
 {
@@ -723,111 +968,71 @@ void ofxOpenVR::setupCameras()
 //--------------------------------------------------------------
 void ofxOpenVR::updateDevicesMatrixPose()
 {
-	if (!_pHMD) return;
+	if (!_pVR) return;
 	
 	// Reset some vars.
 	_iValidPoseCount = 0;
 	_iTrackedControllerCount = 0;
 	_leftControllerDeviceID = -1;
 	_rightControllerDeviceID = -1;
-
-	_strPoseClassesOSS.str("");
-	_strPoseClassesOSS.clear();
-	_strPoseClassesOSS << "FPS " << ofToString(ofGetFrameRate()) << endl;
-	_strPoseClassesOSS << "Frame #" << ofToString(ofGetFrameNum()) << endl;
-	_strPoseClassesOSS << endl;
-	_strPoseClassesOSS << "Connected Device(s): " << endl;
+	_devicePoses.clear();
 
 	// Retrieve all tracked devices' matrix/pose.
-	vr::VRCompositor()->WaitGetPoses(_rTrackedDevicePose, vr::k_unMaxTrackedDeviceCount, NULL, 0);
+	_profiler.begin(ofxOpenVRStage::WaitGetPoses);
+	_pVR->WaitGetPoses(_rTrackedDevicePose, vr::k_unMaxTrackedDeviceCount, NULL, 0);
+	_profiler.end(ofxOpenVRStage::WaitGetPoses);
+	double dPoseTime = ofGetElapsedTimeMicros() / 1000000.0;
 
-	// Go through all the tracked devices.
-	for (int nDevice = 0; nDevice < vr::k_unMaxTrackedDeviceCount; ++nDevice)
+	// Keep all valid matrices, converted in one pass.
+	ofxOpenVRPoseMath::convertPoses(_rTrackedDevicePose, vr::k_unMaxTrackedDeviceCount, _rmat4DevicePose);
+
+	// Go through the connected devices, class and role are cached in _devices.
+	for (vr::TrackedDeviceIndex_t nDevice : _devices.getActiveDevices())
 	{
+		const ofxOpenVRDeviceInfo &device = _devices.get(nDevice);
+
 		if (_rTrackedDevicePose[nDevice].bPoseIsValid)
 		{
 			_iValidPoseCount++;
-
-			// Keep all valid matrices.
-			_rmat4DevicePose[nDevice] = convertSteamVRMatrixToMatrix4(_rTrackedDevicePose[nDevice].mDeviceToAbsoluteTracking);
-
-			// Add info to the debug panel.
-			switch (_pHMD->GetTrackedDeviceClass(nDevice))
-			{
-				case vr::TrackedDeviceClass_Controller:
-					if (_pHMD->GetControllerRoleForTrackedDeviceIndex(nDevice) == vr::TrackedControllerRole_LeftHand) {
-						_strPoseClassesOSS << "Controller Left" << endl;
-					}
-					else if (_pHMD->GetControllerRoleForTrackedDeviceIndex(nDevice) == vr::TrackedControllerRole_RightHand) {
-						_strPoseClassesOSS << "Controller Right" << endl;
-					}
-					else {
-						_strPoseClassesOSS << "Controller" << endl;
-					}
-					break;
-
-				case vr::TrackedDeviceClass_HMD:
-					_strPoseClassesOSS << "HMD" << endl;
-					break;
-
-				case vr::TrackedDeviceClass_Invalid:
-					_strPoseClassesOSS << "Invalid Device Class" << endl;
-					break;
-
-				case vr::TrackedDeviceClass_GenericTracker:
-					_strPoseClassesOSS << "Generic trackers, similar to controllers" << endl;
-					break;
-
-				case vr::TrackedDeviceClass_TrackingReference:
-					_strPoseClassesOSS << "Tracking Reference - Camera" << endl;
-					break;
-
-				default:
-					_strPoseClassesOSS << "Unknown Device Class" << endl;
-					break;
-			}
+			_poseHistory.add(nDevice, dPoseTime, _rTrackedDevicePose[nDevice], _rmat4DevicePose[nDevice]);
 
 			// Store HMD matrix. 
-			if (_pHMD->GetTrackedDeviceClass(nDevice) == vr::TrackedDeviceClass_HMD) {
+			if (device.deviceClass == vr::TrackedDeviceClass_HMD) {
 				_mat4HMDPose_world = _rmat4DevicePose[nDevice];
 			}
 
 			// Store controllers' ID and matrix. 
-			if (_pHMD->GetTrackedDeviceClass(nDevice) == vr::TrackedDeviceClass_Controller) {
+			if (device.deviceClass == vr::TrackedDeviceClass_Controller) {
 				_iTrackedControllerCount += 1;
 
-				if (_pHMD->GetControllerRoleForTrackedDeviceIndex(nDevice) == vr::TrackedControllerRole_LeftHand) {
+				if (device.role == vr::TrackedControllerRole_LeftHand) {
 					_leftControllerDeviceID = nDevice;
 					_mat4LeftControllerPose = _rmat4DevicePose[nDevice];
 				}
-				else if (_pHMD->GetControllerRoleForTrackedDeviceIndex(nDevice) == vr::TrackedControllerRole_RightHand) {
+				else if (device.role == vr::TrackedControllerRole_RightHand) {
 					_rightControllerDeviceID = nDevice;
 					_mat4RightControllerPose = _rmat4DevicePose[nDevice];
 				}
 			}
 		}
+
+		// Pose slot for every connected device, invalid poses keep the last valid matrix.
+		_devicePoses.add(nDevice, device.deviceClass, device.role, _rTrackedDevicePose[nDevice], _rmat4DevicePose[nDevice]);
 	}
 
 	// Store HDM's matrix
 	if (_rTrackedDevicePose[vr::k_unTrackedDeviceIndex_Hmd].bPoseIsValid)
 	{
-		_mat4HMDPose = glm::inverse(_rmat4DevicePose[vr::k_unTrackedDeviceIndex_Hmd]);
+		_mat4HMDPose = ofxOpenVRPoseMath::invertRigid(_rmat4DevicePose[vr::k_unTrackedDeviceIndex_Hmd]);
 	}
-
-	// Aad more info to the debug panel.
-	_strPoseClassesOSS << endl;
-	_strPoseClassesOSS << "Pose Count: " << _iValidPoseCount << endl;
-    _strPoseClassesOSS << "Controller Count: " << _iTrackedControllerCount << endl;
-
 }
 
 //--------------------------------------------------------------
 void ofxOpenVR::handleInput()
 {
-	controller_events_.clear();
 	// Process SteamVR events
 	vr::VREvent_t event;
-	while (_pHMD->PollNextEvent(&event, sizeof(event)))
+	while (_pVR->PollNextEvent(&event, sizeof(event)))
 	{
 		processVREvent(event);
 	}
@@ -835,17 +1040,17 @@ void ofxOpenVR::handleInput()
 
 //--------------------------------------------------------------
 bool ofxOpenVR::hasControllerEvents() {
-	return controller_events_.size() > 0;
+	return !controller_events_.empty();
 }
 
 //--------------------------------------------------------------
 bool ofxOpenVR::getNextControllerEvent(ofxOpenVRControllerEvent &event) {
-	if (hasControllerEvents()) {
-		event = controller_events_[0];
-		controller_events_.erase(controller_events_.begin());
-		return true;
-	}
-	return false;
+	return controller_events_.pop(event);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVR::setControllerEventQueueEnabled(bool bEnabled) {
+	_bControllerEventQueue = bEnabled;
 }
 
 
@@ -854,26 +1059,30 @@ bool ofxOpenVR::getNextControllerEvent(ofxOpenVRControllerEvent &event) {
 //--------------------------------------------------------------
 void ofxOpenVR::processVREvent(const vr::VREvent_t & event)
 {		
+	// Refresh cached device info on (de)activation, update and role change.
+	_devices.processEvent(event);
+	const ofxOpenVRDeviceInfo &device = _devices.get(event.trackedDeviceIndex);
+
 	// Check device's class.
-	switch (_pHMD->GetTrackedDeviceClass(event.trackedDeviceIndex))
+	switch (device.deviceClass)
 	{
 		case vr::TrackedDeviceClass_Controller:
+		{
 			ofxOpenVRControllerEvent _args;
 
 			// Controller's role.
-			if (_pHMD->GetControllerRoleForTrackedDeviceIndex(event.trackedDeviceIndex) == vr::TrackedControllerRole_LeftHand) {
+			if (device.role == vr::TrackedControllerRole_LeftHand) {
 				_args.controllerRole = ControllerRole::Left;
 			}
-			else if (_pHMD->GetControllerRoleForTrackedDeviceIndex(event.trackedDeviceIndex) == vr::TrackedControllerRole_RightHand) {
+			else if (device.role == vr::TrackedControllerRole_RightHand) {
 				_args.controllerRole = ControllerRole::Right;
 			}
 			else {
 				_args.controllerRole = ControllerRole::Unknown;
 			}
 
-			// Get extra data about the controller.
-			vr::VRControllerState_t pControllerState;
-			vr::VRSystem()->GetControllerState(event.trackedDeviceIndex, &pControllerState, sizeof(pControllerState));
+			// Get extra data about the controller from this frame's snapshot.
+			const ofxOpenVRControllerState &controllerState = getControllerStateForDevice(event.trackedDeviceIndex);
 
 			_args.analogInput_xAxis = -1;
 			_args.analogInput_yAxis = -1;
@@ -902,8 +1111,8 @@ void ofxOpenVR::processVREvent(const vr::VREvent_t & event)
 				{
 					_args.buttonType = ButtonType::ButtonTouchpad;
 
-					_args.analogInput_xAxis = pControllerState.rAxis->x;
-					_args.analogInput_yAxis = pControllerState.rAxis->y;
+					_args.analogInput_xAxis = controllerState.axis[0].x;
+					_args.analogInput_yAxis = controllerState.axis[0].y;
 				}
 				break;
 
@@ -941,9 +1150,16 @@ void ofxOpenVR::processVREvent(const vr::VREvent_t & event)
 				break;
 			}
 
-			controller_events_.push_back(_args);		//Send to queue
-			//ofNotifyEvent(ofxOpenVRControllerEvent, _args);
-			break;
+			_args.eventAgeSeconds = event.eventAgeSeconds;
+			_args.frameNumber = _nFrameNumber;
+			_args.deviceIndex = event.trackedDeviceIndex;
+
+			if (_bControllerEventQueue) {
+				controller_events_.push(_args);		//Send to queue, dropped and counted if the queue is full
+			}
+			ofNotifyEvent(controllerEvents, _args);
+		}
+		break;
 
 		case vr::TrackedDeviceClass_HMD:
 			break;
@@ -972,12 +1188,15 @@ void ofxOpenVR::processVREvent(const vr::VREvent_t & event)
 
 		case vr::VREvent_TrackedDeviceDeactivated:
 		{
+			_renderModels.release(event.trackedDeviceIndex);
 			printf("Device %u detached.\n", event.trackedDeviceIndex);
 		}
 		break;	
 
 		case vr::VREvent_TrackedDeviceUpdated:
 		{
+			// The render model name may have changed
+			setupRenderModelForTrackedDevice(event.trackedDeviceIndex);
 			printf("Device %u updated.\n", event.trackedDeviceIndex);
 		}
 		break;
@@ -987,101 +1206,254 @@ void ofxOpenVR::processVREvent(const vr::VREvent_t & event)
 //--------------------------------------------------------------
 void ofxOpenVR::renderStereoTargets()
 {
+	if (_stereoRenderMode == StereoRenderMode::SinglePassInstanced) {
+		renderStereoTargetsSinglePass();
+		return;
+	}
 	
 	//glEnable(GL_MULTISAMPLE);
-	bool b = cameraImg.isAllocated();
-	float camScale = 1.8;
+	bool b = isCameraShown && _camera.hasFrame();
 
 	// Left Eye
+	int iDrawCallsStart = _iDrawCalls;
+	_profiler.begin(ofxOpenVRStage::RenderLeft);
 	eyeFbo[vr::Eye_Left].begin();
+	setupRenderViewport();
 	ofClear(_clearColor);
+	drawHiddenAreaMask(vr::Eye_Left);
 	ofEnableAlphaBlending();
 	if (b) {
-		ofPushMatrix();
-		ofTranslate(eyeFbo[vr::Eye_Left].getWidth()/2, eyeFbo[vr::Eye_Left].getHeight()/2);
-		ofScale(camScale);
-		ofTranslate(- camFbo[vr::Eye_Left].getWidth()/2, -camFbo[vr::Eye_Left].getHeight()/2);
-		camFbo[vr::Eye_Left].draw(0, 0);
-		ofPopMatrix();
+		drawCamera(vr::Eye_Left);
 	}
 	
 	renderScene(vr::Eye_Left);
 	ofDisableAlphaBlending();
+	glDisable(GL_STENCIL_TEST);
 	eyeFbo[vr::Eye_Left].end();
+	_profiler.end(ofxOpenVRStage::RenderLeft);
+	_iEyeDrawCalls[vr::Eye_Left] = _iDrawCalls - iDrawCallsStart;
+	iDrawCallsStart = _iDrawCalls;
 
 	// Right Eye
+	_profiler.begin(ofxOpenVRStage::RenderRight);
 	eyeFbo[vr::Eye_Right].begin();
+	setupRenderViewport();
 	ofClear(_clearColor);
+	drawHiddenAreaMask(vr::Eye_Right);
 	ofEnableAlphaBlending();
 	if (b) {
-		ofPushMatrix();
-		ofTranslate(eyeFbo[vr::Eye_Right].getWidth() / 2, eyeFbo[vr::Eye_Right].getHeight() / 2);
-		ofScale(camScale);
-		ofTranslate(-camFbo[vr::Eye_Right].getWidth() / 2, -camFbo[vr::Eye_Right].getHeight() / 2);
-		camFbo[vr::Eye_Right].draw(0, 0);
-		ofPopMatrix();
+		drawCamera(vr::Eye_Right);
 	}
 	renderScene(vr::Eye_Right);
 	ofDisableAlphaBlending();
+	glDisable(GL_STENCIL_TEST);
 	eyeFbo[vr::Eye_Right].end();
+	_profiler.end(ofxOpenVRStage::RenderRight);
+	_iEyeDrawCalls[vr::Eye_Right] = _iDrawCalls - iDrawCallsStart;
 }
 
-
 //--------------------------------------------------------------
-glm::vec3 ofxOpenVR::get_center(const glm::mat4x4& pose) {
-	return glm::vec3(pose * glm::vec4(0, 0, 0, 1));
+// Purpose: Renders both eyes into the double-wide _stereoFbo at once
+//--------------------------------------------------------------
+void ofxOpenVR::renderStereoTargetsSinglePass()
+{
+	int iDrawCallsStart = _iDrawCalls;
+	_profiler.begin(ofxOpenVRStage::RenderStereo);
+	_stereoFbo.begin();
+	ofViewport(0, 0, _nViewportWidth * 2, _nViewportHeight, false);
+	ofClear(_clearColor);
+	drawHiddenAreaMask(-1);
+	ofEnableAlphaBlending();
+	if (isCameraShown && _camera.hasFrame()) {
+		drawCamera(-1);
+	}
+	renderSceneStereo();
+	ofDisableAlphaBlending();
+	glDisable(GL_STENCIL_TEST);
+	_stereoFbo.end();
+	_profiler.end(ofxOpenVRStage::RenderStereo);
+
+	// Each draw call covers both eyes
+	_iEyeDrawCalls[vr::Eye_Left] = _iEyeDrawCalls[vr::Eye_Right] = _iDrawCalls - iDrawCallsStart;
+
+	_bEyeFbosResolved = false;
 }
 
 //--------------------------------------------------------------
-glm::vec3 ofxOpenVR::get_axe(const glm::mat4x4 &pose, int axe) {	//axe 0,1,2 - OX,OY,OZ result is normalized
-	glm::vec4 center(0, 0, 0, 1);
-	glm::vec4 point = center;
-	point[axe] += 0.05f;
-	point = pose * point - pose * center;
-	return glm::normalize(glm::vec3(point));
+// Purpose: Draws camera image straight from the camera texture, reprojected from the HMD pose at the capture time
+// to the current eye pose. nEye -1 - for both eyes by one instanced draw call
+//--------------------------------------------------------------
+void ofxOpenVR::drawCamera(int nEye)
+{
+	const vr::TrackedDevicePose_t &capturePose = _camera.getFrameHeader().standingTrackedDevicePose;
+	glm::mat4 matCaptureHMD = capturePose.bPoseIsValid ? ofxOpenVRPoseMath::toMatrix(capturePose.mDeviceToAbsoluteTracking) : _rmat4DevicePose[vr::k_unTrackedDeviceIndex_Hmd];
+	glm::mat4 matCaptureView = ofxOpenVRPoseMath::invertRigid(matCaptureHMD);
+
+	// Each half of the frame is seen by its camera at the capture time. The runtime gives the pose of the first (left) one,
+	// the right one is at its offset mirrored across the head's center. Without that pose the cameras are taken to be at the eyes,
+	// without a camera projection the frame fills the eye's field of view
+	glm::mat4 matInverseProjection[2];
+	glm::mat4 matEyeToCamera[2];
+	for (int i = 0; i < 2; i++) {
+		vr::Hmd_Eye eye = vr::Hmd_Eye(i);
+		glm::mat4 matHeadToCamera = _mat4eyePos[eye];
+		if (_camera.hasCameraToHead()) {
+			glm::mat4 matCameraToHead = _camera.getCameraToHead();
+			if (eye == vr::Eye_Right) matCameraToHead[3].x = -matCameraToHead[3].x;
+			matHeadToCamera = ofxOpenVRPoseMath::invertRigid(matCameraToHead);
+		}
+		glm::mat4 matCameraProjection = _camera.hasProjection() ? _camera.getProjection() : _mat4Projection[eye];
+		matInverseProjection[i] = glm::inverse(_mat4Projection[eye]);
+		matEyeToCamera[i] = matCameraProjection * matHeadToCamera * matCaptureView * ofxOpenVRPoseMath::invertRigid(getCurrentViewMatrix(eye));
+	}
+
+	glEnable(GL_CLIP_DISTANCE0);
+	_cameraStereoShader.begin();
+	_cameraStereoShader.setUniformTexture("cam", _camera.getTexture(), 0);
+	_cameraStereoShader.setUniform4f("texBounds", _camera.getTextureBounds());
+	_cameraStereoShader.setUniformMatrix4f("eyeInverseProjection", matInverseProjection[0], 2);
+	_cameraStereoShader.setUniformMatrix4f("eyeToCamera", matEyeToCamera[0], 2);
+	_cameraStereoShader.setUniform1f("depth", _fCameraDepth);
+	_cameraStereoShader.setUniform1i("singleEye", nEye);
+
+	glBindVertexArray(_unStereoQuadVAO);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (nEye < 0) ? 2 : 1);
+	glBindVertexArray(0);
+	_iDrawCalls++;
+
+	_cameraStereoShader.end();
+	glDisable(GL_CLIP_DISTANCE0);
 }
 
-bool ofxOpenVR::startVideo() {
-	ofLogNotice() << "StartVideoPreview()";
+//--------------------------------------------------------------
+// Purpose: Renders the scene for both eyes into the currently bound double-wide target
+//--------------------------------------------------------------
+void ofxOpenVR::renderSceneStereo()
+{
+	ofEnableDepthTest();
 
-	// Allocate for camera frame buffer requirements
-	uint32_t nCameraFrameBufferSize = 0;
-	if (trackedCamera->GetCameraFrameSize(vr::k_unTrackedDeviceIndex_Hmd, vr::VRTrackedCameraFrameType_Undistorted, 
-		&m_nCameraFrameWidth,
-		&m_nCameraFrameHeight,
-		&nCameraFrameBufferSize
-	) != vr::VRTrackedCameraError_None) {
-		ofLogError() << "GetCameraFrameBounds() Failed!";
-		return false;
+	_mat4StereoViewProjection[vr::Eye_Left] = getCurrentViewProjectionMatrix(vr::Eye_Left);
+	_mat4StereoViewProjection[vr::Eye_Right] = getCurrentViewProjectionMatrix(vr::Eye_Right);
+
+	// Stereo shaders clip each eye's instance to its half of the target
+	glEnable(GL_CLIP_DISTANCE0);
+
+	// Draw the controllers
+	if (_bDrawControllers) {
+		_controllersTransformStereoShader.begin();
+		_controllersTransformStereoShader.setUniformMatrix4f("matrices", _mat4StereoViewProjection[0], 2);
+		_controllersVbo.drawInstanced(OF_MESH_FILL, 2);
+		_controllersTransformStereoShader.end();
+		_iDrawCalls++;
 	}
-	ofLogNotice() << "camera input size: " << m_nCameraFrameWidth << " x " << m_nCameraFrameHeight;
 
-	if (nCameraFrameBufferSize && nCameraFrameBufferSize != m_nCameraFrameBufferSize) {
-		delete[] m_pCameraFrameBuffer;
-		m_nCameraFrameBufferSize = nCameraFrameBufferSize;
-		m_pCameraFrameBuffer = new uint8_t[m_nCameraFrameBufferSize];
-		memset(m_pCameraFrameBuffer, 0, m_nCameraFrameBufferSize);
+	// Render default devices models 
+	if (_bRenderModelForTrackedDevices) {
+		_renderModelsStereoShader.begin();
+		_renderModelsStereoShader.setUniformMatrix4f("matrices", _mat4StereoViewProjection[0], 2);
+		_iDrawCalls += _renderModels.drawBatch(_renderModelsStereoShader, 2);
+		_renderModelsStereoShader.end();
 	}
 
-	m_nLastFrameSequence = 0;
+	glDisable(GL_CLIP_DISTANCE0);
 
-	trackedCamera->AcquireVideoStreamingService(vr::k_unTrackedDeviceIndex_Hmd, &trackedCameraHandle);
-	if (trackedCameraHandle == INVALID_TRACKED_CAMERA_HANDLE) {
-		ofLogError() << "AcquireVideoStreamingService() Failed!";
-		return false;
+	// User's render function
+	if (_callableSinglePassRenderFunction) {
+		_callableSinglePassRenderFunction();
+		_iDrawCalls++;
+	}
+	else {
+		// Fallback for per-eye functions: render each eye into its half
+		for (int i = 0; i < 2; i++) {
+			vr::Hmd_Eye nEye = toEye(i);
+			ofPushView();
+			ofViewport(i * _nViewportWidth, 0, _nViewportWidth, _nViewportHeight, false);
+			_callableRenderFunction(nEye);
+			ofPopView();
+			_iDrawCalls++;
+		}
 	}
 
-	camFbo[vr::Eye_Left].allocate(m_nCameraFrameWidth, m_nCameraFrameHeight/2, GL_RGB);
-	camFbo[vr::Eye_Right].allocate(m_nCameraFrameWidth, m_nCameraFrameHeight/2, GL_RGB);
+	ofDisableDepthTest();
+}
 
-	return true;
+//--------------------------------------------------------------
+// Purpose: Marks pixels which are never visible through the lenses in the stencil buffer,
+//          and leaves stencil test enabled, so the following drawing skips them.
+//          nEye = -1 draws the mask for both halves of _stereoFbo
+//--------------------------------------------------------------
+void ofxOpenVR::drawHiddenAreaMask(int nEye)
+{
+	// ofClear() does not clear stencil
+	glClearStencil(0);
+	glClear(GL_STENCIL_BUFFER_BIT);
+
+	if (!_bHiddenAreaMask || !_unHiddenAreaVAO) return;
+
+	GLint first = (nEye == vr::Eye_Right) ? GLint(_uiHiddenAreaVertexCount[vr::Eye_Left]) : 0;
+	GLsizei count = GLsizei((nEye < 0) ? _uiHiddenAreaVertexCount[vr::Eye_Left] + _uiHiddenAreaVertexCount[vr::Eye_Right] : _uiHiddenAreaVertexCount[nEye]);
+	if (count == 0) return;
+
+	glEnable(GL_STENCIL_TEST);
+	glStencilFunc(GL_ALWAYS, 1, 0xFF);
+	glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glDepthMask(GL_FALSE);
+	glDisable(GL_DEPTH_TEST);
+
+	_hiddenAreaShader.begin();
+	_hiddenAreaShader.setUniform1i("stereo", (nEye < 0) ? 1 : 0);
+	glBindVertexArray(_unHiddenAreaVAO);
+	glDrawArrays(GL_TRIANGLES, first, count);
+	glBindVertexArray(0);
+	_hiddenAreaShader.end();
+	_iDrawCalls++;
+
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glDepthMask(GL_TRUE);
+
+	// Everything else is drawn only outside of the mask
+	glStencilFunc(GL_EQUAL, 0, 0xFF);
+	glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+}
+
+//--------------------------------------------------------------
+// Purpose: Copies halves of _stereoFbo to eyeFbo, used by functions drawing eye buffers on the screen
+//--------------------------------------------------------------
+void ofxOpenVR::resolveEyeFbos()
+{
+	if (_stereoRenderMode != StereoRenderMode::SinglePassInstanced || _bEyeFbosResolved) return;
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, _stereoFbo.getId());
+	for (int i = 0; i < 2; i++) {
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, eyeFbo[i].getId());
+		glBlitFramebuffer(i * _nViewportWidth, 0, (i + 1) * _nViewportWidth, _nViewportHeight, 0, 0, _nViewportWidth, _nViewportHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	}
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+
+	_bEyeFbosResolved = true;
+}
+
+
+//--------------------------------------------------------------
+glm::vec3 ofxOpenVR::get_center(const glm::mat4x4& pose) {
+	return glm::vec3(pose[3]);
+}
+
+//--------------------------------------------------------------
+glm::vec3 ofxOpenVR::get_axe(const glm::mat4x4 &pose, int axe) {	//axe 0,1,2 - OX,OY,OZ result is normalized
+	return ofxOpenVRPoseMath::getAxis(pose, axe);
+}
+
+bool ofxOpenVR::startVideo() {
+	ofLogNotice() << "StartVideoPreview()";
+	return _camera.start(_pVR, vr::k_unTrackedDeviceIndex_Hmd);
 }
 
 void ofxOpenVR::closeVideo() {
 	ofLogNotice() << "StopVideoPreview()";
-
-	trackedCamera->ReleaseVideoStreamingService(trackedCameraHandle);
-	trackedCameraHandle = INVALID_TRACKED_CAMERA_HANDLE;
+	_camera.stop();
 }
 
 //--------------------------------------------------------------
@@ -1115,52 +1487,34 @@ glm::vec3 ofxOpenVR::getControllerAxe(int controller, int axe) {	//axe 0,1,2 - O
 void ofxOpenVR::drawControllers()
 {
 	// Don't draw controllers if somebody else has input focus
-	/*if (_pHMD->IsInputFocusCapturedByAnotherProcess()) {
+	/*if (_pVR->IsInputFocusCapturedByAnotherProcess()) {
 		return;
 	}*/
-		
-	_controllersVbo.clear();
-	
-	// Left controller
-	if (_pHMD->IsTrackedDeviceConnected(_leftControllerDeviceID)) {
-		glm::vec4 center = _mat4LeftControllerPose * glm::vec4(0, 0, 0, 1);
 
-		for (int i = 0; i < 3; ++i)
-		{
-			glm::vec3 color(0, 0, 0);
-			glm::vec4 point(0, 0, 0, 1);
-			point[i] += 0.05f;  // offset in X, Y, Z
-			color[i] = 1.0;  // R, G, B
-			point = _mat4LeftControllerPose * point;
-
-			_controllersVbo.addVertex(ofVec3f(center.x, center.y, center.z));
-			_controllersVbo.addColor(ofFloatColor(color.x, color.y, color.z));
+	// Vertices are updated in place, so the VBO is not reallocated
+	setControllerAxesVertices(0, _devices.isConnected(_leftControllerDeviceID), _mat4LeftControllerPose);
+	setControllerAxesVertices(6, _devices.isConnected(_rightControllerDeviceID), _mat4RightControllerPose);
+}
 
-			_controllersVbo.addVertex(ofVec3f(point.x, point.y, point.z));
-			_controllersVbo.addColor(ofFloatColor(color.x, color.y, color.z));
-		}
-	}
-	
-	// Right controller
-	if (_pHMD->IsTrackedDeviceConnected(_rightControllerDeviceID)) {
-		glm::vec4 center = _mat4RightControllerPose * glm::vec4(0, 0, 0, 1);
+//--------------------------------------------------------------
+// Purpose: Sets 3 lines of controller's axes starting from iFirstVertex,
+//          lines of disconnected controller are collapsed to a point
+//--------------------------------------------------------------
+void ofxOpenVR::setControllerAxesVertices(int iFirstVertex, bool bConnected, const glm::mat4x4 &matPose)
+{
+	glm::vec4 center = bConnected ? matPose * glm::vec4(0, 0, 0, 1) : glm::vec4(0, 0, 0, 1);
 
-		for (int i = 0; i < 3; ++i)
-		{
-			glm::vec3 color(0, 0, 0);
-			glm::vec4 point(0, 0, 0, 1);
+	for (int i = 0; i < 3; ++i)
+	{
+		glm::vec4 point = center;
+		if (bConnected) {
+			point = glm::vec4(0, 0, 0, 1);
 			point[i] += 0.05f;  // offset in X, Y, Z
-			color[i] = 1.0;  // R, G, B
-			point = _mat4RightControllerPose * point;
-
-			_controllersVbo.addVertex(ofVec3f(center.x, center.y, center.z));
-			_controllersVbo.addColor(ofFloatColor(color.x, color.y, color.z));
-
-			_controllersVbo.addVertex(ofVec3f(point.x, point.y, point.z));
-			_controllersVbo.addColor(ofFloatColor(color.x, color.y, color.z));
+			point = matPose * point;
 		}
+		_controllersVbo.setVertex(iFirstVertex + 2 * i, glm::vec3(center));
+		_controllersVbo.setVertex(iFirstVertex + 2 * i + 1, glm::vec3(point));
 	}
-
 }
 
 //--------------------------------------------------------------
@@ -1170,7 +1524,7 @@ void ofxOpenVR::renderScene(vr::Hmd_Eye nEye)
 	ofEnableDepthTest();
 
 	// Don't continue if somebody else has input focus
-	/*if (_pHMD->IsInputFocusCapturedByAnotherProcess()) {
+	/*if (_pVR->IsInputFocusCapturedByAnotherProcess()) {
 		return;
 	}*/
 
@@ -1180,37 +1534,21 @@ void ofxOpenVR::renderScene(vr::Hmd_Eye nEye)
 		_controllersTransformShader.setUniformMatrix4f("matrix", getCurrentViewProjectionMatrix(nEye), 1);
 		_controllersVbo.draw();
 		_controllersTransformShader.end();
+		_iDrawCalls++;
 	}
 
 
 	// Render default devices models 
 	if (_bRenderModelForTrackedDevices) {
 		_renderModelsShader.begin();
-
-		for (uint32_t unTrackedDevice = 0; unTrackedDevice < vr::k_unMaxTrackedDeviceCount; unTrackedDevice++) {
-			if (!_rTrackedDeviceToRenderModel[unTrackedDevice])
-				continue;
-
-			const vr::TrackedDevicePose_t & pose = _rTrackedDevicePose[unTrackedDevice];
-			if (!pose.bPoseIsValid) {
-				continue;
-			}
-				
-			/*if (_pHMD->IsInputFocusCapturedByAnotherProcess() && _pHMD->GetTrackedDeviceClass(unTrackedDevice) == vr::TrackedDeviceClass_Controller) {
-				continue;
-			}*/
-				
-			glm::mat4x4 matMVP = getCurrentViewProjectionMatrix(nEye) * _rmat4DevicePose[unTrackedDevice];
-
-			_renderModelsShader.setUniformMatrix4f("matrix", matMVP, 1);
-			_rTrackedDeviceToRenderModel[unTrackedDevice]->Draw();
-		}
-
+		_renderModelsShader.setUniformMatrix4f("matrix", getCurrentViewProjectionMatrix(nEye), 1);
+		_iDrawCalls += _renderModels.drawBatch(_renderModelsShader, 1);
 		_renderModelsShader.end();
 	}
 
 	// User's render function
 	_callableRenderFunction(nEye);
+	_iDrawCalls++;
 
 	ofDisableDepthTest();
 
@@ -1231,7 +1569,36 @@ void ofxOpenVR::draw_using_contrast_shader(float w, float h, float contrast0, fl
 }
 
 //--------------------------------------------------------------
-//NOTE: currently size of rendering texture is limited render_width,render_heigth (SOME BUG)
+void ofxOpenVR::setPreview(const ofxOpenVRPreviewSettings &settings)
+{
+	_preview.setSettings(settings);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVR::drawPreview()
+{
+	drawPreview(0, 0, ofGetWidth(), ofGetHeight());
+}
+
+//--------------------------------------------------------------
+// Purpose: Blits the rendered part of the eye's target; in SinglePassInstanced mode
+// it is read from its half of _stereoFbo, so eyeFbo is not resolved
+//--------------------------------------------------------------
+void ofxOpenVR::drawPreview(float x, float y, float w, float h)
+{
+	if (!_bIsGLInit) return;
+
+	int eye = _preview.getSettings().eye;
+	ofRectangle src(0, 0, _nViewportWidth, _nViewportHeight);
+	GLuint glSrcFramebuffer = eyeFbo[eye].getId();
+	if (_stereoRenderMode == StereoRenderMode::SinglePassInstanced && !_bEyeFbosResolved) {
+		src.x = eye * _nViewportWidth;
+		glSrcFramebuffer = _stereoFbo.getId();
+	}
+	_preview.draw(glSrcFramebuffer, src, ofRectangle(x, y, w, h));
+}
+
+//--------------------------------------------------------------
 void ofxOpenVR::draw_using_binded_shader(float w, float h, int eye) {
 	//ofDisableArbTex();
 
@@ -1239,6 +1606,8 @@ void ofxOpenVR::draw_using_binded_shader(float w, float h, int eye) {
 	glViewport(0, 0, ofGetWidth(), ofGetHeight());
 
 	//ofPushMatrix();
+	resolveEyeFbos();
+
 	float W = render_width();
 	float H = render_height();
 	W = max(W, 1.0f);
@@ -1250,19 +1619,16 @@ void ofxOpenVR::draw_using_binded_shader(float w, float h, int eye) {
 	float x0 = (w - w1) / 2;
 	float y0 = (h - h1) / 2;
 
-	int texw = 1; //W
-	int texh = 1; //H;
-	ofMesh mesh;
-	mesh.addVertex(ofPoint(x0, y0));
-	mesh.addVertex(ofPoint(x0+w1, y0));
-	mesh.addVertex(ofPoint(x0+w1, y0+h1));
-	mesh.addVertex(ofPoint(x0, y0+h1));
-	mesh.addTexCoord(ofVec2f(0, 1));
-	mesh.addTexCoord(ofVec2f(texw, 1));
-	mesh.addTexCoord(ofVec2f(texw, 0));
-	mesh.addTexCoord(ofVec2f(0, 0));
-	mesh.addTriangle(0, 1, 2);
-	mesh.addTriangle(0, 2, 3);
+	float texw = float(_nViewportWidth) / max(_nTargetWidth, 1u);	//rendered part of the eye FBO
+	float texh = float(_nViewportHeight) / max(_nTargetHeight, 1u);
+	_previewQuad.setVertex(0, glm::vec3(x0, y0, 0));
+	_previewQuad.setVertex(1, glm::vec3(x0 + w1, y0, 0));
+	_previewQuad.setVertex(2, glm::vec3(x0 + w1, y0 + h1, 0));
+	_previewQuad.setVertex(3, glm::vec3(x0, y0 + h1, 0));
+	_previewQuad.setTexCoord(0, glm::vec2(0, texh));
+	_previewQuad.setTexCoord(1, glm::vec2(texw, texh));
+	_previewQuad.setTexCoord(2, glm::vec2(texw, 0));
+	_previewQuad.setTexCoord(3, glm::vec2(0, 0));
 
 	GLuint texture_id = eyeFbo[eye].getTexture().getTextureData().textureID;
 	glBindTexture(GL_TEXTURE_2D, texture_id);
@@ -1272,7 +1638,7 @@ void ofxOpenVR::draw_using_binded_shader(float w, float h, int eye) {
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	//glActiveTexture(GL_TEXTURE0);
 
-	mesh.drawFaces();
+	_previewQuad.drawFaces();
 	
 }
 
@@ -1280,20 +1646,23 @@ void ofxOpenVR::draw_using_binded_shader(float w, float h, int eye) {
 //--------------------------------------------------------------
 void ofxOpenVR::renderDistortion()
 {
+	resolveEyeFbos();
+
 	glDisable(GL_DEPTH_TEST);
 	glViewport(0, 0, ofGetWidth(), ofGetHeight());
 
 	glBindVertexArray(_unLensVAO);
 	_lensShader.begin();
+	_lensShader.setUniform2f("uvScale", float(_nViewportWidth) / max(_nTargetWidth, 1u), float(_nViewportHeight) / max(_nTargetHeight, 1u));
 
-	//render left lens (first half of index array )
+	//render left lens (first part of index array )
 	eyeFbo[vr::Eye_Left].getTexture().bind();
-	glDrawElements(GL_TRIANGLES, _uiIndexSize / 2, GL_UNSIGNED_SHORT, 0);
+	glDrawElements(GL_TRIANGLES, _uiLensIndexCount[vr::Eye_Left], GL_UNSIGNED_SHORT, 0);
 	eyeFbo[vr::Eye_Left].getTexture().unbind();
 
-	//render right lens (second half of index array )
+	//render right lens (rest of index array, the offset is in bytes)
 	eyeFbo[vr::Eye_Right].getTexture().bind();
-	glDrawElements(GL_TRIANGLES, _uiIndexSize / 2, GL_UNSIGNED_SHORT, (const void *)(_uiIndexSize));
+	glDrawElements(GL_TRIANGLES, _uiLensIndexCount[vr::Eye_Right], GL_UNSIGNED_SHORT, (const void *)(_uiLensIndexCount[vr::Eye_Left] * sizeof(GLushort)));
 	eyeFbo[vr::Eye_Right].getTexture().unbind();
 
 	glBindVertexArray(0);
@@ -1303,22 +1672,90 @@ void ofxOpenVR::renderDistortion()
 //--------------------------------------------------------------
 void ofxOpenVR::drawDebugInfo(float x, float y)
 {
+	// The text is built here and not in update(), so frames without debug output don't allocate memory for it
+	_strPoseClassesOSS.str("");
+	_strPoseClassesOSS.clear();
+	_strPoseClassesOSS << "FPS " << ofToString(ofGetFrameRate()) << endl;
+	_strPoseClassesOSS << "Frame #" << ofToString(ofGetFrameNum()) << endl;
+	_strPoseClassesOSS << endl;
+	_strPoseClassesOSS << "Connected Device(s): " << endl;
+
+	for (vr::TrackedDeviceIndex_t nDevice : _devices.getActiveDevices())
+	{
+		if (!_rTrackedDevicePose[nDevice].bPoseIsValid) continue;
+
+		const ofxOpenVRDeviceInfo &device = _devices.get(nDevice);
+		switch (device.deviceClass)
+		{
+			case vr::TrackedDeviceClass_Controller:
+				if (device.role == vr::TrackedControllerRole_LeftHand) {
+					_strPoseClassesOSS << "Controller Left" << endl;
+				}
+				else if (device.role == vr::TrackedControllerRole_RightHand) {
+					_strPoseClassesOSS << "Controller Right" << endl;
+				}
+				else {
+					_strPoseClassesOSS << "Controller" << endl;
+				}
+				break;
+
+			case vr::TrackedDeviceClass_HMD:
+				_strPoseClassesOSS << "HMD" << endl;
+				break;
+
+			case vr::TrackedDeviceClass_Invalid:
+				_strPoseClassesOSS << "Invalid Device Class" << endl;
+				break;
+
+			case vr::TrackedDeviceClass_GenericTracker:
+				_strPoseClassesOSS << "Generic trackers, similar to controllers" << endl;
+				break;
+
+			case vr::TrackedDeviceClass_TrackingReference:
+				_strPoseClassesOSS << "Tracking Reference - Camera" << endl;
+				break;
+
+			default:
+				_strPoseClassesOSS << "Unknown Device Class" << endl;
+				break;
+		}
+	}
+
+	_strPoseClassesOSS << endl;
+	_strPoseClassesOSS << "Pose Count: " << _iValidPoseCount << endl;
+	_strPoseClassesOSS << "Controller Count: " << _iTrackedControllerCount << endl;
+
 	_strPoseClassesOSS << endl;
 	_strPoseClassesOSS << "System Name: " << _strTrackingSystemName << endl;
 	_strPoseClassesOSS << "System S/N: " << _strTrackingSystemModelNumber << endl;
 
+	if (_bRenderModelForTrackedDevices && _renderModels.isLoading()) {
+		_strPoseClassesOSS << endl;
+		_strPoseClassesOSS << "Render Models Loading: " << _renderModels.getPendingCount() << endl;
+	}
+
+	if (_camera.isStreaming()) {
+		ofxOpenVRCameraStats cameraStats = _camera.getStats();
+		_strPoseClassesOSS << endl;
+		_strPoseClassesOSS << "Camera Frames: " << cameraStats.framesReceived << " received, " << cameraStats.framesDropped << " dropped, " << cameraStats.framesMissed << " missed" << endl;
+		_strPoseClassesOSS << "Camera Frame Age: " << ofToString(cameraStats.lastAgeMs, 1) << " ms, avg " << ofToString(cameraStats.avgAgeMs, 1) << " ms, max " << ofToString(cameraStats.maxAgeMs, 1) << " ms" << endl;
+	}
+
+	_strPoseClassesOSS << endl;
+	_strPoseClassesOSS << ofxOpenVRGpuMemory::getSummary();
+
+	if (_profiler.isEnabled()) {
+		_strPoseClassesOSS << endl;
+		_strPoseClassesOSS << _profiler.getSummary();
+	}
+
 	ofDrawBitmapStringHighlight(_strPoseClassesOSS.str(), ofPoint(x, y), ofColor(ofColor::black, 100.0f));
 }
 
 //--------------------------------------------------------------
 glm::mat4x4 ofxOpenVR::convertSteamVRMatrixToMatrix4(const vr::HmdMatrix34_t &matPose)
 {
-	return glm::mat4x4(
-		matPose.m[0][0], matPose.m[1][0], matPose.m[2][0], 0.0,
-		matPose.m[0][1], matPose.m[1][1], matPose.m[2][1], 0.0,
-		matPose.m[0][2], matPose.m[1][2], matPose.m[2][2], 0.0,
-		matPose.m[0][3], matPose.m[1][3], matPose.m[2][3], 1.0f
-	);;
+	return ofxOpenVRPoseMath::toMatrix(matPose);
 }
 
 //--------------------------------------------------------------
@@ -1338,84 +1775,16 @@ bool ofxOpenVR::getRenderModelForTrackedDevices()
 }
 
 //-----------------------------------------------------------------------------
-// Purpose: Finds a render model we've already loaded or loads a new one
-//-----------------------------------------------------------------------------
-CGLRenderModel *ofxOpenVR::findOrLoadRenderModel(const char *pchRenderModelName)
-{
-	CGLRenderModel *pRenderModel = NULL;
-	for (std::vector< CGLRenderModel * >::iterator i = _vecRenderModels.begin(); i != _vecRenderModels.end(); i++) {
-		if (!stricmp((*i)->GetName().c_str(), pchRenderModelName)) {
-			pRenderModel = *i;
-			break;
-		}
-	}
-
-	// load the model if we didn't find one
-	if (!pRenderModel) {
-		vr::RenderModel_t *pModel;
-		vr::EVRRenderModelError error;
-		while (1) {
-			error = vr::VRRenderModels()->LoadRenderModel_Async(pchRenderModelName, &pModel);
-			if (error != vr::VRRenderModelError_Loading)
-				break;
-
-			Sleep(1);
-		}
-
-		if (error != vr::VRRenderModelError_None) {
-			printf("Unable to load render model %s - %s\n", pchRenderModelName, vr::VRRenderModels()->GetRenderModelErrorNameFromEnum(error));
-			return NULL; // move on to the next tracked device
-		}
-
-		vr::RenderModel_TextureMap_t *pTexture;
-		while (1) {
-			error = vr::VRRenderModels()->LoadTexture_Async(pModel->diffuseTextureId, &pTexture);
-			if (error != vr::VRRenderModelError_Loading)
-				break;
-
-			Sleep(1);
-		}
-
-		if (error != vr::VRRenderModelError_None) {
-			printf("Unable to load render texture id:%d for render model %s\n", pModel->diffuseTextureId, pchRenderModelName);
-			vr::VRRenderModels()->FreeRenderModel(pModel);
-			return NULL; // move on to the next tracked device
-		}
-
-		pRenderModel = new CGLRenderModel(pchRenderModelName);
-		if (!pRenderModel->BInit(*pModel, *pTexture)) {
-			printf("Unable to create GL model from render model %s\n", pchRenderModelName);
-			delete pRenderModel;
-			pRenderModel = NULL;
-		}
-		else {
-			_vecRenderModels.push_back(pRenderModel);
-		}
-		vr::VRRenderModels()->FreeRenderModel(pModel);
-		vr::VRRenderModels()->FreeTexture(pTexture);
-	}
-	return pRenderModel;
-}
-
-//-----------------------------------------------------------------------------
-// Purpose: Create/destroy GL a Render Model for a single tracked device
+// Purpose: Assigns the render model to a single tracked device. The model is loaded
+// and uploaded in the next frames by _renderModels.update(), the device is drawn when it is ready
 //-----------------------------------------------------------------------------
 void ofxOpenVR::setupRenderModelForTrackedDevice(vr::TrackedDeviceIndex_t unTrackedDeviceIndex)
 {
-	if (unTrackedDeviceIndex >= vr::k_unMaxTrackedDeviceCount) {
+	if (unTrackedDeviceIndex >= vr::k_unMaxTrackedDeviceCount || !_bRenderModelForTrackedDevices) {
 		return;
 	}
-		
-	// try to find a model we've already set up
-	std::string sRenderModelName = getTrackedDeviceString(_pHMD, unTrackedDeviceIndex, vr::Prop_RenderModelName_String);
-	CGLRenderModel *pRenderModel = findOrLoadRenderModel(sRenderModelName.c_str());	
-	if (!pRenderModel) {
-		std::string sTrackingSystemName = getTrackedDeviceString(_pHMD, unTrackedDeviceIndex, vr::Prop_TrackingSystemName_String);
-		printf("Unable to load render model for tracked device %d (%s.%s)", unTrackedDeviceIndex, sTrackingSystemName.c_str(), sRenderModelName.c_str());
-	}
-	else {
-		_rTrackedDeviceToRenderModel[unTrackedDeviceIndex] = pRenderModel;
-	}
+
+	_renderModels.request(unTrackedDeviceIndex, _devices.get(unTrackedDeviceIndex).renderModelName);
 }
 
 //-----------------------------------------------------------------------------
@@ -1423,19 +1792,19 @@ void ofxOpenVR::setupRenderModelForTrackedDevice(vr::TrackedDeviceIndex_t unTrac
 //-----------------------------------------------------------------------------
 void ofxOpenVR::setupRenderModels()
 {	
-	memset(_rTrackedDeviceToRenderModel, 0, sizeof(_rTrackedDeviceToRenderModel));
+	_renderModels.releaseAll();
 
-	if (!_pHMD) {
+	if (!_pVR) {
 		return;
 	}
 		
-	for (uint32_t unTrackedDevice = vr::k_unTrackedDeviceIndex_Hmd + 1; unTrackedDevice < vr::k_unMaxTrackedDeviceCount; unTrackedDevice++) {
-		if (!_pHMD->IsTrackedDeviceConnected(unTrackedDevice)) {
+	for (vr::TrackedDeviceIndex_t unTrackedDevice : _devices.getActiveDevices()) {
+		if (unTrackedDevice == vr::k_unTrackedDeviceIndex_Hmd) {
 			continue;
 		}
 
 		//do not show bases!
-		if (_pHMD->GetTrackedDeviceClass(unTrackedDevice) == vr::ETrackedDeviceClass::TrackedDeviceClass_TrackingReference) {
+		if (_devices.getClass(unTrackedDevice) == vr::TrackedDeviceClass_TrackingReference) {
 			continue;	
 		}
 		
@@ -2,7 +2,20 @@
 
 #include "ofMain.h"
 #include <openvr.h>
-#include "CGLRenderModel.h"
+#include "ofxOpenVRGpuTimer.h"
+#include "ofxOpenVRGpuMemory.h"
+#include "ofxOpenVRDynamicResolution.h"
+#include "ofxOpenVRDistortionMesh.h"
+#include "ofxOpenVRPreview.h"
+#include "ofxOpenVRProfiler.h"
+#include "ofxOpenVRBackend.h"
+#include "ofxOpenVRCamera.h"
+#include "ofxOpenVRRenderModels.h"
+#include "ofxOpenVRDeviceRegistry.h"
+#include "ofxOpenVRDevicePoses.h"
+#include "ofxOpenVRPoseHistory.h"
+#include "ofxOpenVRPoseMath.h"
+#include "ofxOpenVRSpscQueue.h"
 
 /*
 ofxOpenVR addon, adopted by Kuflex, 2017
@@ -36,6 +49,13 @@ enum class EventType
 	ButtonUntouch = 3
 };
 
+//--------------------------------------------------------------
+enum class StereoRenderMode
+{
+	MultiPass = 0,				//each eye is rendered into its own FBO, renderScene() is called per eye
+	SinglePassInstanced = 1		//both eyes are rendered into one double-wide FBO with instanced draws
+};
+
 //--------------------------------------------------------------
 enum class ButtonType
 {
@@ -56,6 +76,26 @@ public:
 	EventType eventType;
 	float analogInput_xAxis;
 	float analogInput_yAxis;
+	float eventAgeSeconds = 0;		//how long ago the runtime generated the event
+	uint64_t frameNumber = 0;		//ofxOpenVR::getFrameNumber() of the update() which received the event
+	vr::TrackedDeviceIndex_t deviceIndex = vr::k_unTrackedDeviceIndexInvalid;
+};
+
+//--------------------------------------------------------------
+//--------------------------------------------------------------
+//Controller state, read from the runtime once per update() for each connected controller
+class ofxOpenVRControllerState
+{
+public:
+	bool bValid = false;				//false if the controller is not connected or the state was not received
+	uint32_t unPacketNum = 0;			//changes when the runtime has a new state
+	uint64_t nFrameChanged = 0;			//ofxOpenVR::getFrameNumber() when unPacketNum last changed
+	uint64_t ulButtonPressed = 0;		//bit vr::ButtonMaskFromId(button) for each pressed button
+	uint64_t ulButtonTouched = 0;
+	std::array<glm::vec2, vr::k_unControllerStateAxisCount> axis;	//axis 0 - touchpad/joystick, 1 - trigger
+
+	bool isPressed(vr::EVRButtonId button) const { return (ulButtonPressed & vr::ButtonMaskFromId(button)) != 0; }
+	bool isTouched(vr::EVRButtonId button) const { return (ulButtonTouched & vr::ButtonMaskFromId(button)) != 0; }
 };
 
 //--------------------------------------------------------------
@@ -64,6 +104,8 @@ class ofxOpenVR {
 
 public:
 	void setup(std::function< void(vr::Hmd_Eye) > f);
+	//Use given runtime instead of SteamVR, for example ofxOpenVRFakeBackend for running without headset
+	void setup(std::function< void(vr::Hmd_Eye) > f, std::shared_ptr<ofxOpenVRBackend> backend);
 	void exit();
 
 	void update();
@@ -87,21 +129,84 @@ public:
 								//Also it fills buffers, which are used by renderDistortion() and draw()
 	void renderDistortion();	//Can be called after render(), renders distorted stereo picture on the screen
 	void renderScene(vr::Hmd_Eye nEye); //renders image for each eye, direct calling for drawing on screen 
-							//can reduce your app performance, so please use draw() instead.
+							//renders the scene once more, so please use drawPreview() instead.
 
-	//Render left eye (prepared buffer) on the screen - faster than calling renderScene 
+	//---- Desktop preview, see ofxOpenVRPreview.h
+	//Copies the eye image submitted by render() to the window, costs a blit per frame
+	void setPreview(const ofxOpenVRPreviewSettings &settings);
+	const ofxOpenVRPreviewSettings &getPreview() { return _preview.getSettings(); }
+	void drawPreview();		//whole window
+	void drawPreview(float x, float y, float w, float h);
+
+	//Render eye (prepared buffer) on the screen through a shader, cropped to w x h
 	//render() must be called before draw()
-	//NOTE: currently size of rendering texture is limited render_width,render_heigth (SOME BUG)
 	void draw_using_contrast_shader(float w, float h, float contrast0 = 0, float contrast1 = 1, int eye = vr::Eye_Left);
 	void draw_using_binded_shader(float w, float h, int eye = vr::Eye_Left);	//for custom shader drawing, see create_contrast_shader() for example
 
+	//---- Single-pass stereo rendering
+	//In SinglePassInstanced mode both eyes are rendered into one double-wide FBO (left half - left eye).
+	//Controllers, render models and camera are drawn once using instancing, gl_InstanceID is the eye index.
+	//The function set by setSinglePassRenderFunction() is called once per frame, 
+	//use getStereoViewProjectionMatrices() in its shaders, see shader/controllerTransformStereo.vert for example
+	//(enable GL_CLIP_DISTANCE0 in your code if your shader writes gl_ClipDistance[0]).
+	//If this function is not set, the setup() function is called for each eye with viewport set to its half.
+	void setStereoRenderMode(StereoRenderMode mode);
+	StereoRenderMode getStereoRenderMode() { return _stereoRenderMode; }
+	void setSinglePassRenderFunction(std::function< void() > f);
+	const std::array<glm::mat4, 2> &getStereoViewProjectionMatrices() { return _mat4StereoViewProjection; }
+
+	//Number of draw calls issued by the last render(), user's function call counts as one
+	int getDrawCallCount() { return _iRenderDrawCalls; }
+	//Draw calls into the eye's target by the last render(); in single-pass mode both eyes share the same calls
+	int getDrawCallCount(vr::Hmd_Eye nEye) { return _iEyeDrawCalls[nEye]; }
+
+	//---- Dynamic resolution, see ofxOpenVRDynamicResolution.h
+	//Call after setup(), changing maxScale reallocates eye FBOs
+	void setDynamicResolution(const ofxOpenVRDynamicResolutionSettings &settings);
+	const ofxOpenVRDynamicResolutionSettings &getDynamicResolution() { return _dynamicResolution.getSettings(); }
+	float getRenderScale() { return _dynamicResolution.getScale(); }	//rendered part of the recommended size
+	float getRenderGpuMs();		//GPU time of rendering both eyes, measured a few frames ago
+
+	//---- Lens distortion mesh used by renderDistortion(), see ofxOpenVRDistortionMesh.h
+	//Call before setup() to build the mesh once, later calls rebuild it
+	void setDistortionMesh(const ofxOpenVRDistortionMeshSettings &settings);
+	const ofxOpenVRDistortionMeshSettings &getDistortionMesh() { return _distortionMeshSettings; }
+
+	//---- Hidden area mask
+	//Pixels never visible through the lenses are masked in the stencil buffer before rendering,
+	//so camera, render models and user's drawing skip them. Enabled by default.
+	void setHiddenAreaMask(bool bMask);
+	bool getHiddenAreaMask() { return _bHiddenAreaMask; }
+
+	//Models are loaded without blocking rendering, a device is drawn once its model is ready, see ofxOpenVRRenderModels.h
 	void setRenderModelForTrackedDevices(bool bRender);		
 	bool getRenderModelForTrackedDevices();
+	ofxOpenVRRenderModels &getRenderModels() { return _renderModels; }
 
 
 	//---- debug output
 	void drawDebugInfo(float x = 10.0f, float y = 20.0f);
 
+	//---- Profiling of update() and render() stages, see ofxOpenVRProfiler.h
+	//When enabled, drawDebugInfo() also prints average and 99th percentile times of the stages
+	void setProfilingEnabled(bool bEnabled);
+	ofxOpenVRProfiler &getProfiler() { return _profiler; }
+
+	//---- GPU memory held by the addon per category, see ofxOpenVRGpuMemory.h
+	//Also printed by drawDebugInfo(), objects not freed by exit() are logged as leaks
+	ofxOpenVRGpuMemoryStats getGpuMemoryStats() const { return ofxOpenVRGpuMemory::getStats(); }
+
+	//---- Tracked devices: cached class, role, serial number and render model name, see ofxOpenVRDeviceRegistry.h
+	const ofxOpenVRDeviceRegistry &getDevices() { return _devices; }
+
+	//---- Poses of all connected devices (controllers, trackers, ...) updated in update(), see ofxOpenVRDevicePoses.h
+	const ofxOpenVRDevicePoses &getDevicePoses() { return _devicePoses; }
+	int getDeviceCount(vr::ETrackedDeviceClass deviceClass) { return _devicePoses.countOf(deviceClass); }
+	glm::mat4x4 getDevicePose(vr::TrackedDeviceIndex_t unDevice);	//last valid pose, identity if never tracked
+
+	//---- Recent poses of all devices for querying at any time (ofGetElapsedTimeMicros() clock), see ofxOpenVRPoseHistory.h
+	const ofxOpenVRPoseHistory &getPoseHistory() { return _poseHistory; }
+
 	//HMD
 	glm::mat4x4 getHDMPose();
 	glm::vec3 getHDMCenter();
@@ -119,15 +224,28 @@ public:
 	void hideMirrorWindow();
 	void toggleMirrorWindow();
 
+	//Camera passthrough. The camera streams only while it is shown, streaming starts and stops in update()
+	bool hasCamera() const { return _bHasCamera; }
+	void showCamera() { isCameraShown = true; }
+	void hideCamera() { isCameraShown = false; }
 	void toggleCamera() {
 		isCameraShown = !isCameraShown;
 	}
+	bool isCameraVisible() const { return isCameraShown; }
+	void setCameraFrameType(vr::EVRTrackedCameraFrameType eFrameType) { _camera.setFrameType(eFrameType); }
+	void setCameraFrameRate(float fFps) { _camera.setFrameRate(fFps); }	//0 - every camera frame
+
+	//Camera image is reprojected as a plane at this distance in meters, the right value removes swimming of objects at it
+	void setCameraDepth(float fMeters) { _fCameraDepth = fMeters; }
+	float getCameraDepth() const { return _fCameraDepth; }
 
 	void toggleGrid(float transitionDuration = 2.0f);
 	void showGrid(float transitionDuration = 2.0f);
 	void hideGrid(float transitionDuration = 2.0f);
 
 	//---- Controllers
+	//Functions below address left and right hand controllers (0 - left, 1 - right),
+	//other controllers and trackers are available via getDevicePoses()
 	int controllersCount() { return 2; }
 	bool isControllerConnected(int controller);
 	void setDrawControllers(bool bDrawControllers);
@@ -139,9 +257,25 @@ public:
 	glm::vec3 getTrackPadState(int controller); //if touched[-1..1]x[-1..1], else (-1000,-1000). 
 	//Note, at the touch start, there are 2-3 frames this function returns values near to (0,0).
 
-	//Controllers events. Note: the queue of events is cleared at each update call.
+	//Full state (all axes, pressed and touched buttons) read in the last update()
+	const ofxOpenVRControllerState &getControllerState(int controller);	//controller 0 - left, 1 - right
+	const ofxOpenVRControllerState &getControllerStateForDevice(vr::TrackedDeviceIndex_t unDevice);
+
+	//Controllers events. Events are kept in the queue until read, up to kControllerEventQueueSize;
+	//events which don't fit are dropped and counted by getControllerEventOverflowCount().
+	//The queue is filled in update() and may be read from one other thread.
+	static const size_t kControllerEventQueueSize = 256;
 	bool hasControllerEvents();
 	bool getNextControllerEvent(ofxOpenVRControllerEvent &event);
+	uint64_t getControllerEventOverflowCount() { return controller_events_.getOverflowCount(); }
+	//Events are also sent to this ofEvent from update(), 
+	//disable the queue if they are consumed only by listeners:
+	//	ofAddListener(openVR.controllerEvents, this, &ofApp::controllerEvent);
+	//	openVR.setControllerEventQueueEnabled(false);
+	ofEvent<ofxOpenVRControllerEvent> controllerEvents;
+	void setControllerEventQueueEnabled(bool bEnabled);
+
+	uint64_t getFrameNumber() { return _nFrameNumber; }	//number of update() calls
 
 	//---- Convert i to left/right type
 	vr::ETrackedControllerRole toControllerRole(int controller);	//0 - left, 1 - right
@@ -156,12 +290,19 @@ public:
 	int render_width() { return _nRenderWidth; }
 	int render_height() { return _nRenderHeight; }
 
+	//Size of the rendered part of each eye's FBO, differs from render_width(), render_height() with dynamic resolution
+	int viewport_width() { return _nViewportWidth; }
+	int viewport_height() { return _nViewportHeight; }
+
 	const ofTexture& getCameraTexture() const {
-		return cameraImg.getTexture();
+		return _camera.getTexture();
 	}
+	const ofxOpenVRCamera& getCamera() const { return _camera; }
 
 protected:
-	vector<ofxOpenVRControllerEvent> controller_events_;
+	ofxOpenVRSpscQueue<ofxOpenVRControllerEvent, kControllerEventQueueSize> controller_events_;
+	bool _bControllerEventQueue;
+	uint64_t _nFrameNumber;
 
 
 	struct VertexDataScene
@@ -170,47 +311,62 @@ protected:
 		glm::vec2 texCoord;
 	};
 
-	struct VertexDataLens
-	{
-		glm::vec2 position;
-		glm::vec2 texCoordRed;
-		glm::vec2 texCoordGreen;
-		glm::vec2 texCoordBlue;
-	};
-
 	std::array<ofFbo, 2> eyeFbo;
 
 	std::function< void(vr::Hmd_Eye) > _callableRenderFunction;
+	std::function< void() > _callableSinglePassRenderFunction;
+
+	StereoRenderMode _stereoRenderMode;
+	ofFbo _stereoFbo;			//double-wide target for SinglePassInstanced mode
+	bool _bEyeFbosResolved;		//eyeFbo contains the halves of _stereoFbo
+	std::array<glm::mat4, 2> _mat4StereoViewProjection;
+	ofShader _controllersTransformStereoShader;
+	ofShader _renderModelsStereoShader;
+	ofShader _cameraStereoShader;
+	GLuint _unStereoQuadVAO;	//empty VAO, camera quad is generated in the vertex shader
+	int _iDrawCalls;
+	int _iRenderDrawCalls;
+	int _iEyeDrawCalls[2];
+
+	bool _bHiddenAreaMask;
+	ofShader _hiddenAreaShader;
+	GLuint _unHiddenAreaVAO;
+	GLuint _glIDHiddenAreaBuffer;
+	std::array<uint32_t, 2> _uiHiddenAreaVertexCount;
 
 	bool _bIsGLInit;
 	bool _bIsGridVisible;
 	
 	ofFloatColor _clearColor;
-	uint32_t _nRenderWidth, _nRenderHeight;
+	uint32_t _nRenderWidth, _nRenderHeight;		//recommended size
+	uint32_t _nTargetWidth, _nTargetHeight;		//allocated size of eye FBOs
+	uint32_t _nViewportWidth, _nViewportHeight;	//rendered part of eye FBOs
+
+	ofxOpenVRDynamicResolution _dynamicResolution;
+	ofxOpenVRGpuTimer _renderGpuTimer;
+	ofxOpenVRProfiler _profiler;
+	void updateRenderViewport();
+	void setupRenderViewport();
 
 	ofParameter<float> nearClip, farClip;
 	
-	vr::IVRSystem *_pHMD;
+	std::shared_ptr<ofxOpenVRBackend> _backend;
+	ofxOpenVRBackend *_pVR;		//_backend after successful init, nullptr otherwise
+	ofxOpenVRDeviceRegistry _devices;
 	
 	bool startVideo();
 	void closeVideo();
 
-	vr::IVRTrackedCamera * trackedCamera;
-	vr::TrackedCameraHandle_t trackedCameraHandle;
-	uint32_t m_nCameraFrameWidth;
-	uint32_t m_nCameraFrameHeight;
-	uint32_t m_nCameraFrameBufferSize;
-	uint8_t * m_pCameraFrameBuffer;
-	uint32_t m_nLastFrameSequence;
-	int frameCounter;
-	ofImage cameraImg;
-	std::array<ofFbo, 2> camFbo;
-
-	vr::IVRRenderModels *_pRenderModels;
+	ofxOpenVRCamera _camera;
+
 	std::string _strTrackingSystemName;
 	std::string _strTrackingSystemModelNumber;
+	std::string _strRuntimeVersion;	//tracking system and HMD driver version, keys on-disk caches
 	vr::TrackedDevicePose_t _rTrackedDevicePose[vr::k_unMaxTrackedDeviceCount];
 	glm::mat4x4 _rmat4DevicePose[vr::k_unMaxTrackedDeviceCount];
+	ofxOpenVRDevicePoses _devicePoses;
+	ofxOpenVRPoseHistory _poseHistory;
+	std::array<ofxOpenVRControllerState, vr::k_unMaxTrackedDeviceCount> _controllerStates;
 
 	int _iTrackedControllerCount;
 	int _iTrackedControllerCount_Last;
@@ -223,7 +379,8 @@ protected:
 	GLuint _unLensVAO;
 	GLuint _glIDVertBuffer;
 	GLuint _glIDIndexBuffer;
-	unsigned int _uiIndexSize;
+	std::array<unsigned int, 2> _uiLensIndexCount;	//left eye's indices go first
+	ofxOpenVRDistortionMeshSettings _distortionMeshSettings;
 
 	glm::mat4x4 _mat4HMDPose_world;	//for using this pose in world rendering
 
@@ -240,6 +397,8 @@ protected:
 
 	bool _bDrawControllers;
 	ofVboMesh _controllersVbo;
+	ofVboMesh _previewQuad;
+	ofxOpenVRPreview _preview;
 	ofShader _controllersTransformShader;
 
 	bool init();
@@ -248,30 +407,42 @@ protected:
 
 	bool createAllShaders();
 	bool createFrameBuffer(int nWidth, int nHeight, vr::Hmd_Eye eye);
+	bool createStereoFrameBuffer(int nWidth, int nHeight);
+	ofFbo::Settings getEyeFboSettings(int nWidth, int nHeight);
 
 	bool setupStereoRenderTargets();
 	void setupDistortion();
+	void releaseDistortion();
+	void setupHiddenAreaMesh();
 	void setupCameras();
 
 	void updateDevicesMatrixPose();
+	void updateCamera();
+	void updateControllerStates();
 	void handleInput();
 	void processVREvent(const vr::VREvent_t & event);
 
 	void renderStereoTargets();
+	void renderStereoTargetsSinglePass();
+	void renderSceneStereo();
+	void drawCamera(int nEye);
+	void resolveEyeFbos();
+	void drawHiddenAreaMask(int nEye);
 	
 	void drawControllers();
+	void setControllerAxesVertices(int iFirstVertex, bool bConnected, const glm::mat4x4 &matPose);
 
 	glm::mat4x4 convertSteamVRMatrixToMatrix4(const vr::HmdMatrix34_t &matPose);
 
 	bool _bRenderModelForTrackedDevices;
 	ofShader _renderModelsShader;
-	CGLRenderModel* findOrLoadRenderModel(const char *pchRenderModelName);
 	void setupRenderModelForTrackedDevice(vr::TrackedDeviceIndex_t unTrackedDeviceIndex);
 	void setupRenderModels();
 
-	std::vector< CGLRenderModel * > _vecRenderModels;
-	CGLRenderModel *_rTrackedDeviceToRenderModel[vr::k_unMaxTrackedDeviceCount];
+	ofxOpenVRRenderModels _renderModels;
 
 	ofShader contrast_shader_;	//shader used in draw_using_contrast_shader
 	bool isCameraShown;
+	bool _bHasCamera;
+	float _fCameraDepth;
 };
@@ -0,0 +1,227 @@
+#include "ofxOpenVRBackend.h"
+
+//--------------------------------------------------------------
+ofxOpenVRSteamVRBackend::ofxOpenVRSteamVRBackend() {
+	_pHMD = nullptr;
+	_pCompositor = nullptr;
+	_pRenderModels = nullptr;
+	_pTrackedCamera = nullptr;
+}
+
+//--------------------------------------------------------------
+vr::EVRInitError ofxOpenVRSteamVRBackend::Init() {
+	// Loading the SteamVR Runtime
+	vr::EVRInitError eError = vr::VRInitError_None;
+	_pHMD = vr::VR_Init(&eError, vr::VRApplication_Scene);
+	if (eError != vr::VRInitError_None) {
+		_pHMD = nullptr;
+		return eError;
+	}
+
+	_pRenderModels = (vr::IVRRenderModels *)vr::VR_GetGenericInterface(vr::IVRRenderModels_Version, &eError);
+	if (!_pRenderModels) {
+		Shutdown();
+		return eError;
+	}
+
+	_pCompositor = vr::VRCompositor();
+	_pTrackedCamera = vr::VRTrackedCamera();
+
+	return vr::VRInitError_None;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRSteamVRBackend::Shutdown() {
+	if (_pHMD) {
+		vr::VR_Shutdown();
+	}
+	_pHMD = nullptr;
+	_pCompositor = nullptr;
+	_pRenderModels = nullptr;
+	_pTrackedCamera = nullptr;
+}
+
+//--------------------------------------------------------------
+const char *ofxOpenVRSteamVRBackend::GetInitErrorDescription(vr::EVRInitError eError) {
+	return vr::VR_GetVRInitErrorAsEnglishDescription(eError);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRSteamVRBackend::GetRecommendedRenderTargetSize(uint32_t *pnWidth, uint32_t *pnHeight) {
+	_pHMD->GetRecommendedRenderTargetSize(pnWidth, pnHeight);
+}
+
+//--------------------------------------------------------------
+vr::HmdMatrix44_t ofxOpenVRSteamVRBackend::GetProjectionMatrix(vr::EVREye eEye, float fNearZ, float fFarZ) {
+	return _pHMD->GetProjectionMatrix(eEye, fNearZ, fFarZ);
+}
+
+//--------------------------------------------------------------
+vr::HmdMatrix34_t ofxOpenVRSteamVRBackend::GetEyeToHeadTransform(vr::EVREye eEye) {
+	return _pHMD->GetEyeToHeadTransform(eEye);
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRSteamVRBackend::ComputeDistortion(vr::EVREye eEye, float fU, float fV, vr::DistortionCoordinates_t *pDistortionCoordinates) {
+	return _pHMD->ComputeDistortion(eEye, fU, fV, pDistortionCoordinates);
+}
+
+//--------------------------------------------------------------
+vr::HiddenAreaMesh_t ofxOpenVRSteamVRBackend::GetHiddenAreaMesh(vr::EVREye eEye, vr::EHiddenAreaMeshType type) {
+	return _pHMD->GetHiddenAreaMesh(eEye, type);
+}
+
+//--------------------------------------------------------------
+vr::ETrackedDeviceClass ofxOpenVRSteamVRBackend::GetTrackedDeviceClass(vr::TrackedDeviceIndex_t unDeviceIndex) {
+	return _pHMD->GetTrackedDeviceClass(unDeviceIndex);
+}
+
+//--------------------------------------------------------------
+vr::ETrackedControllerRole ofxOpenVRSteamVRBackend::GetControllerRoleForTrackedDeviceIndex(vr::TrackedDeviceIndex_t unDeviceIndex) {
+	return _pHMD->GetControllerRoleForTrackedDeviceIndex(unDeviceIndex);
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRSteamVRBackend::IsTrackedDeviceConnected(vr::TrackedDeviceIndex_t unDeviceIndex) {
+	return _pHMD->IsTrackedDeviceConnected(unDeviceIndex);
+}
+
+//--------------------------------------------------------------
+uint32_t ofxOpenVRSteamVRBackend::GetStringTrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, char *pchValue, uint32_t unBufferSize, vr::ETrackedPropertyError *pError) {
+	return _pHMD->GetStringTrackedDeviceProperty(unDeviceIndex, prop, pchValue, unBufferSize, pError);
+}
+
+//--------------------------------------------------------------
+vr::HmdMatrix34_t ofxOpenVRSteamVRBackend::GetMatrix34TrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError *pError) {
+	return _pHMD->GetMatrix34TrackedDeviceProperty(unDeviceIndex, prop, pError);
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRSteamVRBackend::GetControllerState(vr::TrackedDeviceIndex_t unControllerDeviceIndex, vr::VRControllerState_t *pControllerState, uint32_t unControllerStateSize) {
+	return _pHMD->GetControllerState(unControllerDeviceIndex, pControllerState, unControllerStateSize);
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRSteamVRBackend::PollNextEvent(vr::VREvent_t *pEvent, uint32_t uncbVREvent) {
+	return _pHMD->PollNextEvent(pEvent, uncbVREvent);
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRSteamVRBackend::HasCompositor() {
+	return _pCompositor != nullptr;
+}
+
+//--------------------------------------------------------------
+vr::EVRCompositorError ofxOpenVRSteamVRBackend::WaitGetPoses(vr::TrackedDevicePose_t *pRenderPoseArray, uint32_t unRenderPoseArrayCount, vr::TrackedDevicePose_t *pGamePoseArray, uint32_t unGamePoseArrayCount) {
+	return _pCompositor->WaitGetPoses(pRenderPoseArray, unRenderPoseArrayCount, pGamePoseArray, unGamePoseArrayCount);
+}
+
+//--------------------------------------------------------------
+vr::EVRCompositorError ofxOpenVRSteamVRBackend::Submit(vr::EVREye eEye, const vr::Texture_t *pTexture, const vr::VRTextureBounds_t *pBounds, vr::EVRSubmitFlags nSubmitFlags) {
+	return _pCompositor->Submit(eEye, pTexture, pBounds, nSubmitFlags);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRSteamVRBackend::FadeGrid(float fSeconds, bool bFadeIn) {
+	_pCompositor->FadeGrid(fSeconds, bFadeIn);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRSteamVRBackend::ShowMirrorWindow() {
+	_pCompositor->ShowMirrorWindow();
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRSteamVRBackend::HideMirrorWindow() {
+	_pCompositor->HideMirrorWindow();
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRSteamVRBackend::IsMirrorWindowVisible() {
+	return _pCompositor && _pCompositor->IsMirrorWindowVisible();
+}
+
+//--------------------------------------------------------------
+vr::EVRRenderModelError ofxOpenVRSteamVRBackend::LoadRenderModel_Async(const char *pchRenderModelName, vr::RenderModel_t **ppRenderModel) {
+	return _pRenderModels->LoadRenderModel_Async(pchRenderModelName, ppRenderModel);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRSteamVRBackend::FreeRenderModel(vr::RenderModel_t *pRenderModel) {
+	_pRenderModels->FreeRenderModel(pRenderModel);
+}
+
+//--------------------------------------------------------------
+vr::EVRRenderModelError ofxOpenVRSteamVRBackend::LoadTexture_Async(vr::TextureID_t textureId, vr::RenderModel_TextureMap_t **ppTexture) {
+	return _pRenderModels->LoadTexture_Async(textureId, ppTexture);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRSteamVRBackend::FreeTexture(vr::RenderModel_TextureMap_t *pTexture) {
+	_pRenderModels->FreeTexture(pTexture);
+}
+
+//--------------------------------------------------------------
+const char *ofxOpenVRSteamVRBackend::GetRenderModelErrorNameFromEnum(vr::EVRRenderModelError error) {
+	return _pRenderModels->GetRenderModelErrorNameFromEnum(error);
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRSteamVRBackend::HasTrackedCamera() {
+	return _pTrackedCamera != nullptr;
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRSteamVRBackend::IsCameraThreadSafe() {
+	return true;
+}
+
+//--------------------------------------------------------------
+const char *ofxOpenVRSteamVRBackend::GetCameraErrorNameFromEnum(vr::EVRTrackedCameraError eCameraError) {
+	return _pTrackedCamera->GetCameraErrorNameFromEnum(eCameraError);
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRSteamVRBackend::HasCamera(vr::TrackedDeviceIndex_t nDeviceIndex, bool *pHasCamera) {
+	return _pTrackedCamera->HasCamera(nDeviceIndex, pHasCamera);
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRSteamVRBackend::GetCameraFrameSize(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, uint32_t *pnWidth, uint32_t *pnHeight, uint32_t *pnFrameBufferSize) {
+	return _pTrackedCamera->GetCameraFrameSize(nDeviceIndex, eFrameType, pnWidth, pnHeight, pnFrameBufferSize);
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRSteamVRBackend::GetCameraProjection(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, float flZNear, float flZFar, vr::HmdMatrix44_t *pProjection) {
+	return _pTrackedCamera->GetCameraProjection(nDeviceIndex, eFrameType, flZNear, flZFar, pProjection);
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRSteamVRBackend::AcquireVideoStreamingService(vr::TrackedDeviceIndex_t nDeviceIndex, vr::TrackedCameraHandle_t *pHandle) {
+	return _pTrackedCamera->AcquireVideoStreamingService(nDeviceIndex, pHandle);
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRSteamVRBackend::ReleaseVideoStreamingService(vr::TrackedCameraHandle_t hTrackedCamera) {
+	return _pTrackedCamera->ReleaseVideoStreamingService(hTrackedCamera);
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRSteamVRBackend::GetVideoStreamFrameBuffer(vr::TrackedCameraHandle_t hTrackedCamera, vr::EVRTrackedCameraFrameType eFrameType, void *pFrameBuffer, uint32_t nFrameBufferSize, vr::CameraVideoStreamFrameHeader_t *pFrameHeader, uint32_t nFrameHeaderSize) {
+	return _pTrackedCamera->GetVideoStreamFrameBuffer(hTrackedCamera, eFrameType, pFrameBuffer, nFrameBufferSize, pFrameHeader, nFrameHeaderSize);
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRSteamVRBackend::GetVideoStreamTextureSize(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, vr::VRTextureBounds_t *pTextureBounds, uint32_t *pnWidth, uint32_t *pnHeight) {
+	return _pTrackedCamera->GetVideoStreamTextureSize(nDeviceIndex, eFrameType, pTextureBounds, pnWidth, pnHeight);
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRSteamVRBackend::GetVideoStreamTextureGL(vr::TrackedCameraHandle_t hTrackedCamera, vr::EVRTrackedCameraFrameType eFrameType, vr::glUInt_t *pglTextureId, vr::CameraVideoStreamFrameHeader_t *pFrameHeader, uint32_t nFrameHeaderSize) {
+	return _pTrackedCamera->GetVideoStreamTextureGL(hTrackedCamera, eFrameType, pglTextureId, pFrameHeader, nFrameHeaderSize);
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRSteamVRBackend::ReleaseVideoStreamTextureGL(vr::TrackedCameraHandle_t hTrackedCamera, vr::glUInt_t glTextureId) {
+	return _pTrackedCamera->ReleaseVideoStreamTextureGL(hTrackedCamera, glTextureId);
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "ofMain.h"
+#include <openvr.h>
+
+/*
+	OpenVR backend used by ofxOpenVR.
+
+	The interface covers the subset of IVRSystem, IVRCompositor, IVRRenderModels and IVRTrackedCamera
+	which the addon calls. Method names and arguments are the same as in openvr.h.
+
+	ofxOpenVRSteamVRBackend (default) calls the real runtime,
+	ofxOpenVRFakeBackend (see ofxOpenVRFakeBackend.h) simulates it without SteamVR and a headset.
+
+	Usage:
+		openVR.setup(std::bind(&ofApp::render, this, std::placeholders::_1), std::make_shared<ofxOpenVRFakeBackend>());
+*/
+
+//--------------------------------------------------------------
+class ofxOpenVRBackend {
+public:
+	virtual ~ofxOpenVRBackend() {}
+
+	//---- Runtime
+	virtual vr::EVRInitError Init() = 0;
+	virtual void Shutdown() = 0;
+	virtual const char *GetInitErrorDescription(vr::EVRInitError eError) = 0;
+
+	//---- System
+	virtual void GetRecommendedRenderTargetSize(uint32_t *pnWidth, uint32_t *pnHeight) = 0;
+	virtual vr::HmdMatrix44_t GetProjectionMatrix(vr::EVREye eEye, float fNearZ, float fFarZ) = 0;
+	virtual vr::HmdMatrix34_t GetEyeToHeadTransform(vr::EVREye eEye) = 0;
+	virtual bool ComputeDistortion(vr::EVREye eEye, float fU, float fV, vr::DistortionCoordinates_t *pDistortionCoordinates) = 0;
+	virtual vr::HiddenAreaMesh_t GetHiddenAreaMesh(vr::EVREye eEye, vr::EHiddenAreaMeshType type = vr::k_eHiddenAreaMesh_Standard) = 0;
+
+	virtual vr::ETrackedDeviceClass GetTrackedDeviceClass(vr::TrackedDeviceIndex_t unDeviceIndex) = 0;
+	virtual vr::ETrackedControllerRole GetControllerRoleForTrackedDeviceIndex(vr::TrackedDeviceIndex_t unDeviceIndex) = 0;
+	virtual bool IsTrackedDeviceConnected(vr::TrackedDeviceIndex_t unDeviceIndex) = 0;
+	virtual uint32_t GetStringTrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, char *pchValue, uint32_t unBufferSize, vr::ETrackedPropertyError *pError = 0L) = 0;
+	virtual vr::HmdMatrix34_t GetMatrix34TrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError *pError = 0L) = 0;
+	virtual bool GetControllerState(vr::TrackedDeviceIndex_t unControllerDeviceIndex, vr::VRControllerState_t *pControllerState, uint32_t unControllerStateSize) = 0;
+	virtual bool PollNextEvent(vr::VREvent_t *pEvent, uint32_t uncbVREvent) = 0;
+
+	//---- Compositor
+	virtual bool HasCompositor() = 0;
+	virtual vr::EVRCompositorError WaitGetPoses(vr::TrackedDevicePose_t *pRenderPoseArray, uint32_t unRenderPoseArrayCount, vr::TrackedDevicePose_t *pGamePoseArray, uint32_t unGamePoseArrayCount) = 0;
+	virtual vr::EVRCompositorError Submit(vr::EVREye eEye, const vr::Texture_t *pTexture, const vr::VRTextureBounds_t *pBounds = 0, vr::EVRSubmitFlags nSubmitFlags = vr::Submit_Default) = 0;
+	virtual void FadeGrid(float fSeconds, bool bFadeIn) = 0;
+	virtual void ShowMirrorWindow() = 0;
+	virtual void HideMirrorWindow() = 0;
+	virtual bool IsMirrorWindowVisible() = 0;
+
+	//---- Render models
+	virtual vr::EVRRenderModelError LoadRenderModel_Async(const char *pchRenderModelName, vr::RenderModel_t **ppRenderModel) = 0;
+	virtual void FreeRenderModel(vr::RenderModel_t *pRenderModel) = 0;
+	virtual vr::EVRRenderModelError LoadTexture_Async(vr::TextureID_t textureId, vr::RenderModel_TextureMap_t **ppTexture) = 0;
+	virtual void FreeTexture(vr::RenderModel_TextureMap_t *pTexture) = 0;
+	virtual const char *GetRenderModelErrorNameFromEnum(vr::EVRRenderModelError error) = 0;
+
+	//---- Tracked camera
+	virtual bool HasTrackedCamera() = 0;	//false if the camera interface is not available
+	virtual bool IsCameraThreadSafe() = 0;	//true if camera frames may be polled from a worker thread
+	virtual const char *GetCameraErrorNameFromEnum(vr::EVRTrackedCameraError eCameraError) = 0;
+	virtual vr::EVRTrackedCameraError HasCamera(vr::TrackedDeviceIndex_t nDeviceIndex, bool *pHasCamera) = 0;
+	virtual vr::EVRTrackedCameraError GetCameraFrameSize(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, uint32_t *pnWidth, uint32_t *pnHeight, uint32_t *pnFrameBufferSize) = 0;
+	virtual vr::EVRTrackedCameraError GetCameraProjection(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, float flZNear, float flZFar, vr::HmdMatrix44_t *pProjection) = 0;
+	virtual vr::EVRTrackedCameraError AcquireVideoStreamingService(vr::TrackedDeviceIndex_t nDeviceIndex, vr::TrackedCameraHandle_t *pHandle) = 0;
+	virtual vr::EVRTrackedCameraError ReleaseVideoStreamingService(vr::TrackedCameraHandle_t hTrackedCamera) = 0;
+	virtual vr::EVRTrackedCameraError GetVideoStreamFrameBuffer(vr::TrackedCameraHandle_t hTrackedCamera, vr::EVRTrackedCameraFrameType eFrameType, void *pFrameBuffer, uint32_t nFrameBufferSize, vr::CameraVideoStreamFrameHeader_t *pFrameHeader, uint32_t nFrameHeaderSize) = 0;
+	virtual vr::EVRTrackedCameraError GetVideoStreamTextureSize(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, vr::VRTextureBounds_t *pTextureBounds, uint32_t *pnWidth, uint32_t *pnHeight) = 0;
+	virtual vr::EVRTrackedCameraError GetVideoStreamTextureGL(vr::TrackedCameraHandle_t hTrackedCamera, vr::EVRTrackedCameraFrameType eFrameType, vr::glUInt_t *pglTextureId, vr::CameraVideoStreamFrameHeader_t *pFrameHeader, uint32_t nFrameHeaderSize) = 0;
+	virtual vr::EVRTrackedCameraError ReleaseVideoStreamTextureGL(vr::TrackedCameraHandle_t hTrackedCamera, vr::glUInt_t glTextureId) = 0;
+};
+
+//--------------------------------------------------------------
+//Backend calling SteamVR runtime
+class ofxOpenVRSteamVRBackend : public ofxOpenVRBackend {
+public:
+	ofxOpenVRSteamVRBackend();
+
+	vr::EVRInitError Init() override;
+	void Shutdown() override;
+	const char *GetInitErrorDescription(vr::EVRInitError eError) override;
+
+	void GetRecommendedRenderTargetSize(uint32_t *pnWidth, uint32_t *pnHeight) override;
+	vr::HmdMatrix44_t GetProjectionMatrix(vr::EVREye eEye, float fNearZ, float fFarZ) override;
+	vr::HmdMatrix34_t GetEyeToHeadTransform(vr::EVREye eEye) override;
+	bool ComputeDistortion(vr::EVREye eEye, float fU, float fV, vr::DistortionCoordinates_t *pDistortionCoordinates) override;
+	vr::HiddenAreaMesh_t GetHiddenAreaMesh(vr::EVREye eEye, vr::EHiddenAreaMeshType type = vr::k_eHiddenAreaMesh_Standard) override;
+
+	vr::ETrackedDeviceClass GetTrackedDeviceClass(vr::TrackedDeviceIndex_t unDeviceIndex) override;
+	vr::ETrackedControllerRole GetControllerRoleForTrackedDeviceIndex(vr::TrackedDeviceIndex_t unDeviceIndex) override;
+	bool IsTrackedDeviceConnected(vr::TrackedDeviceIndex_t unDeviceIndex) override;
+	uint32_t GetStringTrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, char *pchValue, uint32_t unBufferSize, vr::ETrackedPropertyError *pError = 0L) override;
+	vr::HmdMatrix34_t GetMatrix34TrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError *pError = 0L) override;
+	bool GetControllerState(vr::TrackedDeviceIndex_t unControllerDeviceIndex, vr::VRControllerState_t *pControllerState, uint32_t unControllerStateSize) override;
+	bool PollNextEvent(vr::VREvent_t *pEvent, uint32_t uncbVREvent) override;
+
+	bool HasCompositor() override;
+	vr::EVRCompositorError WaitGetPoses(vr::TrackedDevicePose_t *pRenderPoseArray, uint32_t unRenderPoseArrayCount, vr::TrackedDevicePose_t *pGamePoseArray, uint32_t unGamePoseArrayCount) override;
+	vr::EVRCompositorError Submit(vr::EVREye eEye, const vr::Texture_t *pTexture, const vr::VRTextureBounds_t *pBounds = 0, vr::EVRSubmitFlags nSubmitFlags = vr::Submit_Default) override;
+	void FadeGrid(float fSeconds, bool bFadeIn) override;
+	void ShowMirrorWindow() override;
+	void HideMirrorWindow() override;
+	bool IsMirrorWindowVisible() override;
+
+	vr::EVRRenderModelError LoadRenderModel_Async(const char *pchRenderModelName, vr::RenderModel_t **ppRenderModel) override;
+	void FreeRenderModel(vr::RenderModel_t *pRenderModel) override;
+	vr::EVRRenderModelError LoadTexture_Async(vr::TextureID_t textureId, vr::RenderModel_TextureMap_t **ppTexture) override;
+	void FreeTexture(vr::RenderModel_TextureMap_t *pTexture) override;
+	const char *GetRenderModelErrorNameFromEnum(vr::EVRRenderModelError error) override;
+
+	bool HasTrackedCamera() override;
+	bool IsCameraThreadSafe() override;
+	const char *GetCameraErrorNameFromEnum(vr::EVRTrackedCameraError eCameraError) override;
+	vr::EVRTrackedCameraError HasCamera(vr::TrackedDeviceIndex_t nDeviceIndex, bool *pHasCamera) override;
+	vr::EVRTrackedCameraError GetCameraFrameSize(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, uint32_t *pnWidth, uint32_t *pnHeight, uint32_t *pnFrameBufferSize) override;
+	vr::EVRTrackedCameraError GetCameraProjection(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, float flZNear, float flZFar, vr::HmdMatrix44_t *pProjection) override;
+	vr::EVRTrackedCameraError AcquireVideoStreamingService(vr::TrackedDeviceIndex_t nDeviceIndex, vr::TrackedCameraHandle_t *pHandle) override;
+	vr::EVRTrackedCameraError ReleaseVideoStreamingService(vr::TrackedCameraHandle_t hTrackedCamera) override;
+	vr::EVRTrackedCameraError GetVideoStreamFrameBuffer(vr::TrackedCameraHandle_t hTrackedCamera, vr::EVRTrackedCameraFrameType eFrameType, void *pFrameBuffer, uint32_t nFrameBufferSize, vr::CameraVideoStreamFrameHeader_t *pFrameHeader, uint32_t nFrameHeaderSize) override;
+	vr::EVRTrackedCameraError GetVideoStreamTextureSize(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, vr::VRTextureBounds_t *pTextureBounds, uint32_t *pnWidth, uint32_t *pnHeight) override;
+	vr::EVRTrackedCameraError GetVideoStreamTextureGL(vr::TrackedCameraHandle_t hTrackedCamera, vr::EVRTrackedCameraFrameType eFrameType, vr::glUInt_t *pglTextureId, vr::CameraVideoStreamFrameHeader_t *pFrameHeader, uint32_t nFrameHeaderSize) override;
+	vr::EVRTrackedCameraError ReleaseVideoStreamTextureGL(vr::TrackedCameraHandle_t hTrackedCamera, vr::glUInt_t glTextureId) override;
+
+protected:
+	vr::IVRSystem *_pHMD;
+	vr::IVRCompositor *_pCompositor;
+	vr::IVRRenderModels *_pRenderModels;
+	vr::IVRTrackedCamera *_pTrackedCamera;
+};
@@ -0,0 +1,410 @@
+#include "ofxOpenVRCamera.h"
+#include "ofxOpenVRPoseMath.h"
+#include "ofxOpenVRGpuMemory.h"
+
+//--------------------------------------------------------------
+ofxOpenVRCamera::ofxOpenVRCamera() {
+	_pVR = nullptr;
+	_unDevice = vr::k_unTrackedDeviceIndex_Hmd;
+	_hCamera = INVALID_TRACKED_CAMERA_HANDLE;
+	_mode = Mode::None;
+	_nFrameWidth = 0;
+	_nFrameHeight = 0;
+	_nFrameBufferSize = 0;
+	memset(&_frameHeader, 0, sizeof(_frameHeader));
+	_bHasFrame = false;
+	_textureBounds = glm::vec4(0, 0, 1, 1);
+	_bHasProjection = false;
+	_bHasCameraToHead = false;
+	_unSharedTexture = 0;
+	_bPersistentMapping = false;
+	_bThreadRunning = false;
+	_eFrameType = vr::VRTrackedCameraFrameType_Undistorted;
+	_ulFrameIntervalMicros = 0;
+	resetSlots();
+}
+
+//--------------------------------------------------------------
+ofxOpenVRCamera::~ofxOpenVRCamera() {
+	stop();
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRCamera::resetSlots() {
+	_iWriteSlot = 0;
+	_iReadySlot = 1;
+	_iReadSlot = 2;
+	_bUploadPending = false;
+	_nLastFrameSequence = 0;
+	_ulLastReceivedMicros = 0;
+	_nFramesReceived = 0;
+	_nFramesDropped = 0;
+	_nFramesMissed = 0;
+	_nFramesDisplayed = 0;
+	_dAgeSumMs = 0;
+	_fLastAgeMs = 0;
+	_fMaxAgeMs = 0;
+}
+
+//--------------------------------------------------------------
+// Purpose: Call with GL context
+//--------------------------------------------------------------
+bool ofxOpenVRCamera::start(ofxOpenVRBackend *pVR, vr::TrackedDeviceIndex_t unDevice) {
+	stop();
+	_pVR = pVR;
+	_unDevice = unDevice;
+
+	if (_pVR->GetCameraFrameSize(_unDevice, _eFrameType, &_nFrameWidth, &_nFrameHeight, &_nFrameBufferSize) != vr::VRTrackedCameraError_None) {
+		ofLogError("ofxOpenVR") << "GetCameraFrameSize() failed";
+		return false;
+	}
+
+	// Only x and y of the projection are used, so the clip range doesn't matter
+	vr::HmdMatrix44_t projection;
+	_bHasProjection = _pVR->GetCameraProjection(_unDevice, _eFrameType, 0.1f, 100.0f, &projection) == vr::VRTrackedCameraError_None;
+	_projection = _bHasProjection ? ofxOpenVRPoseMath::toMatrix(projection) : glm::mat4();
+	if (!_bHasProjection) {
+		ofLogNotice("ofxOpenVR") << "GetCameraProjection() failed, camera frame is not reprojected";
+	}
+
+	vr::ETrackedPropertyError propertyError = vr::TrackedProp_Success;
+	vr::HmdMatrix34_t cameraToHead = _pVR->GetMatrix34TrackedDeviceProperty(_unDevice, vr::Prop_CameraToHeadTransform_Matrix34, &propertyError);
+	_bHasCameraToHead = (propertyError == vr::TrackedProp_Success);
+	_cameraToHead = _bHasCameraToHead ? ofxOpenVRPoseMath::toMatrix(cameraToHead) : glm::mat4();
+	if (!_bHasCameraToHead) {
+		ofLogNotice("ofxOpenVR") << "Camera to head transform is not provided, the camera is taken to be at the eyes";
+	}
+
+	if (_pVR->AcquireVideoStreamingService(_unDevice, &_hCamera) != vr::VRTrackedCameraError_None || _hCamera == INVALID_TRACKED_CAMERA_HANDLE) {
+		ofLogError("ofxOpenVR") << "AcquireVideoStreamingService() failed";
+		_hCamera = INVALID_TRACKED_CAMERA_HANDLE;
+		return false;
+	}
+
+	// The shared texture may be bigger than the frame, bounds give the frame inside it
+	vr::VRTextureBounds_t bounds;
+	uint32_t nTextureWidth = 0;
+	uint32_t nTextureHeight = 0;
+	if (preferSharedTexture && _pVR->GetVideoStreamTextureSize(_unDevice, _eFrameType, &bounds, &nTextureWidth, &nTextureHeight) == vr::VRTrackedCameraError_None) {
+		_mode = Mode::SharedTexture;
+		_textureBounds = glm::vec4(bounds.uMin, bounds.vMin, bounds.uMax, bounds.vMax);
+		ofTextureData &data = _texture.getTextureData();
+		data.textureTarget = GL_TEXTURE_2D;
+		data.glInternalFormat = GL_RGBA8;
+		data.width = data.tex_w = nTextureWidth;
+		data.height = data.tex_h = nTextureHeight;
+		data.tex_t = data.tex_u = 1;
+	}
+	else if (!setupPixelBuffers()) {
+		stop();
+		return false;
+	}
+
+	resetSlots();
+	if (useThread && _pVR->IsCameraThreadSafe()) {
+		startThread();
+	}
+
+	ofLogNotice("ofxOpenVR") << "Camera frame " << _nFrameWidth << " x " << _nFrameHeight << ", "
+		<< ((_mode == Mode::SharedTexture) ? "shared texture" : _bPersistentMapping ? "persistent mapped pixel buffers" : "pixel buffers in memory")
+		<< (isThreaded() ? ", worker thread" : "");
+	return true;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRCamera::stop() {
+	stopThread();
+	releaseSharedTexture();
+	releasePixelBuffers();
+	if (_pVR && _hCamera != INVALID_TRACKED_CAMERA_HANDLE) {
+		_pVR->ReleaseVideoStreamingService(_hCamera);
+	}
+	_hCamera = INVALID_TRACKED_CAMERA_HANDLE;
+	_mode = Mode::None;
+	_bHasFrame = false;
+	_textureBounds = glm::vec4(0, 0, 1, 1);
+}
+
+//--------------------------------------------------------------
+// Purpose: Frame size and projection depend on the frame type, so streaming is restarted
+//--------------------------------------------------------------
+void ofxOpenVRCamera::setFrameType(vr::EVRTrackedCameraFrameType eFrameType) {
+	if (eFrameType == _eFrameType) return;
+	_eFrameType = eFrameType;
+	if (isStreaming()) {
+		start(_pVR, _unDevice);
+	}
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRCamera::setFrameRate(float fFps) {
+	_ulFrameIntervalMicros = (fFps > 0) ? uint64_t(1000000.0 / fFps) : 0;
+}
+
+//--------------------------------------------------------------
+float ofxOpenVRCamera::getFrameRate() const {
+	uint64_t ulInterval = _ulFrameIntervalMicros;
+	return ulInterval ? float(1000000.0 / ulInterval) : 0.0f;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRCamera::startThread() {
+	_bThreadRunning = true;
+	_thread = std::thread(&ofxOpenVRCamera::threadedFunction, this);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRCamera::stopThread() {
+	_bThreadRunning = false;
+	if (_thread.joinable()) {
+		_thread.join();
+	}
+}
+
+//--------------------------------------------------------------
+// Purpose: The runtime has no call waiting for a camera frame, so the header is polled
+//--------------------------------------------------------------
+void ofxOpenVRCamera::threadedFunction() {
+	while (_bThreadRunning) {
+		if (receiveFrame()) continue;
+
+		// With a target rate, sleep till the next frame is due; the sleep is limited, so stop() doesn't wait long
+		uint64_t ulSleepMicros = std::min(std::max(getMicrosToNextFrame(), uint64_t(kPollIntervalMicros)), uint64_t(kMaxSleepMicros));
+		std::this_thread::sleep_for(std::chrono::microseconds(ulSleepMicros));
+	}
+}
+
+//--------------------------------------------------------------
+uint64_t ofxOpenVRCamera::getMicrosToNextFrame() const {
+	uint64_t ulInterval = _ulFrameIntervalMicros;
+	if (ulInterval == 0 || _ulLastReceivedMicros == 0) return 0;
+	uint64_t ulNow = ofGetElapsedTimeMicros();
+	uint64_t ulNext = _ulLastReceivedMicros + ulInterval;
+	return (ulNext > ulNow) ? ulNext - ulNow : 0;
+}
+
+//--------------------------------------------------------------
+// Purpose: Receives a new frame into the write slot and publishes it, called by the worker thread or by acquireFrame()
+//--------------------------------------------------------------
+bool ofxOpenVRCamera::receiveFrame() {
+	if (getMicrosToNextFrame() > 0) return false;
+
+	// Header only: cheap check whether the frame has changed
+	vr::CameraVideoStreamFrameHeader_t frameHeader;
+	if (_pVR->GetVideoStreamFrameBuffer(_hCamera, _eFrameType, nullptr, 0, &frameHeader, sizeof(frameHeader)) != vr::VRTrackedCameraError_None) return false;
+	if (frameHeader.nFrameSequence == _nLastFrameSequence) return false;
+
+	// For shared textures only the header is published, the texture itself is got on the render thread
+	FrameSlot &slot = _slots[_iWriteSlot];
+	if (slot.pData) {
+		if (_pVR->GetVideoStreamFrameBuffer(_hCamera, _eFrameType, slot.pData, _nFrameBufferSize, &frameHeader, sizeof(frameHeader)) != vr::VRTrackedCameraError_None) return false;
+	}
+
+	if (_nLastFrameSequence != 0 && frameHeader.nFrameSequence > _nLastFrameSequence + 1) {
+		_nFramesMissed += frameHeader.nFrameSequence - _nLastFrameSequence - 1;
+	}
+	_nLastFrameSequence = frameHeader.nFrameSequence;
+	slot.header = frameHeader;
+	slot.ulReceivedMicros = ofGetElapsedTimeMicros();
+	_ulLastReceivedMicros = slot.ulReceivedMicros;
+	_nFramesReceived++;
+
+	int iPrevious = _iReadySlot.exchange(_iWriteSlot | kNewFrame);
+	if (iPrevious & kNewFrame) {
+		_nFramesDropped++;
+	}
+	_iWriteSlot = iPrevious & kSlotMask;
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRCamera::setupPixelBuffers() {
+	_mode = Mode::PixelBuffer;
+	_textureBounds = glm::vec4(0, 0, 1, 1);
+
+	// GL_TEXTURE_2D target, so shaders can sample it with normalized coordinates;
+	// streaming may start mid-session, so the app's ofGetUsingArbTex() is left as it is
+	_texture.allocate(_nFrameWidth, _nFrameHeight, GL_RGBA8, false);
+	ofxOpenVRGpuMemory::track(ofxOpenVRGpuMemory::Object::Texture, _texture.getTextureData().textureID, ofxOpenVRGpuCategory::Camera,
+		ofxOpenVRGpuMemory::getImageSize(_nFrameWidth, _nFrameHeight, GL_RGBA8), "camera texture");
+
+	// Persistent mapping is core only since GL 4.4. Without it the receiving thread can't write into
+	// buffers, so frames are kept in memory and the driver copies them in glTexSubImage2D.
+	_bPersistentMapping = ofGLCheckExtension("GL_ARB_buffer_storage");
+	for (auto &slot : _slots) {
+		if (_bPersistentMapping) {
+			GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glGenBuffers(1, &slot.unBuffer);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.unBuffer);
+			glBufferStorage(GL_PIXEL_UNPACK_BUFFER, _nFrameBufferSize, nullptr, flags);
+			slot.pData = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, _nFrameBufferSize, flags);
+			ofxOpenVRGpuMemory::track(ofxOpenVRGpuMemory::Object::Buffer, slot.unBuffer, ofxOpenVRGpuCategory::Camera, _nFrameBufferSize, "camera pixel buffer");
+		}
+		else {
+			slot.memory.resize(_nFrameBufferSize);
+			slot.pData = slot.memory.data();
+		}
+		if (slot.pData == nullptr) {
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			ofLogError("ofxOpenVR") << "Unable to create camera pixel buffers";
+			return false;
+		}
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	return true;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRCamera::releasePixelBuffers() {
+	for (auto &slot : _slots) {
+		if (slot.fence) {
+			glDeleteSync(slot.fence);
+			slot.fence = nullptr;
+		}
+		if (slot.unBuffer) {
+			if (slot.pData) {
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.unBuffer);
+				glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			}
+			ofxOpenVRGpuMemory::untrack(ofxOpenVRGpuMemory::Object::Buffer, slot.unBuffer);
+			glDeleteBuffers(1, &slot.unBuffer);
+		}
+		slot.unBuffer = 0;
+		slot.pData = nullptr;
+		slot.memory.clear();
+		slot.memory.shrink_to_fit();
+	}
+	_bUploadPending = false;
+	if (_mode == Mode::PixelBuffer) {
+		ofxOpenVRGpuMemory::untrack(ofxOpenVRGpuMemory::Object::Texture, _texture.getTextureData().textureID);
+		_texture.clear();
+	}
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRCamera::releaseSharedTexture() {
+	if (_unSharedTexture != 0) {
+		if (_hCamera != INVALID_TRACKED_CAMERA_HANDLE) {
+			_pVR->ReleaseVideoStreamTextureGL(_hCamera, _unSharedTexture);
+		}
+		_unSharedTexture = 0;
+	}
+	if (_mode == Mode::SharedTexture) {
+		// The texture belongs to the runtime, ofTexture must not delete it
+		_texture.getTextureData().textureID = 0;
+		_texture.clear();
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRCamera::update() {
+	if (!acquireFrame()) return false;
+	uploadFrame();
+	return true;
+}
+
+//--------------------------------------------------------------
+// Purpose: Takes the newest received frame without waiting, returns true if it is new
+//--------------------------------------------------------------
+bool ofxOpenVRCamera::acquireFrame() {
+	if (_mode == Mode::None) return false;
+	if (!isThreaded()) {
+		receiveFrame();
+	}
+	if (!(_iReadySlot.load() & kNewFrame)) return false;
+
+	// The slot given back becomes the next write slot, so its upload must be complete.
+	// The upload is at least a frame old and almost always is; if not, the new frame is taken next time.
+	FrameSlot &previous = _slots[_iReadSlot];
+	if (previous.fence) {
+		if (glClientWaitSync(previous.fence, 0, 0) == GL_TIMEOUT_EXPIRED) return false;
+		glDeleteSync(previous.fence);
+		previous.fence = nullptr;
+	}
+	_iReadSlot = _iReadySlot.exchange(_iReadSlot) & kSlotMask;
+	FrameSlot &slot = _slots[_iReadSlot];
+
+	if (_mode == Mode::SharedTexture) {
+		if (!acquireSharedTexture(slot.header)) return false;
+		_bHasFrame = true;
+	}
+	else {
+		_bUploadPending = true;
+	}
+	_frameHeader = slot.header;
+
+	_fLastAgeMs = (ofGetElapsedTimeMicros() - slot.ulReceivedMicros) / 1000.0f;
+	_fMaxAgeMs = std::max(_fMaxAgeMs, _fLastAgeMs);
+	_dAgeSumMs += _fLastAgeMs;
+	_nFramesDisplayed++;
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRCamera::acquireSharedTexture(vr::CameraVideoStreamFrameHeader_t &frameHeader) {
+	// Undistorted frames are a part of the MaximumUndistorted texture, as given by the bounds
+	vr::EVRTrackedCameraFrameType eTextureType = (_eFrameType == vr::VRTrackedCameraFrameType_Undistorted) ? vr::VRTrackedCameraFrameType_MaximumUndistorted : _eFrameType;
+	vr::glUInt_t unTexture = 0;
+	vr::EVRTrackedCameraError eError = _pVR->GetVideoStreamTextureGL(_hCamera, eTextureType, &unTexture, &frameHeader, sizeof(frameHeader));
+	if (eError == vr::VRTrackedCameraError_NoFrameAvailable) return false;
+	if (eError != vr::VRTrackedCameraError_None) {
+		// The runtime reports texture size, but can't share it: switch to the copying path for the rest of the session
+		ofLogNotice("ofxOpenVR") << "GetVideoStreamTextureGL() failed (" << _pVR->GetCameraErrorNameFromEnum(eError) << "), using pixel buffers";
+		bool bThreaded = isThreaded();
+		stopThread();
+		releaseSharedTexture();
+		if (!setupPixelBuffers()) {
+			stop();
+			return false;
+		}
+		resetSlots();
+		if (bThreaded) {
+			startThread();
+		}
+		return false;
+	}
+
+	if (_unSharedTexture != 0 && _unSharedTexture != unTexture) {
+		_pVR->ReleaseVideoStreamTextureGL(_hCamera, _unSharedTexture);
+	}
+	_unSharedTexture = unTexture;
+
+	// ofTexture releases its previous id in setUseExternalTextureID, the previous one belongs to the runtime too
+	_texture.getTextureData().textureID = 0;
+	_texture.setUseExternalTextureID(unTexture);
+	return true;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRCamera::uploadFrame() {
+	if (_mode != Mode::PixelBuffer || !_bUploadPending) return;
+	_bUploadPending = false;
+
+	// With a bound GL_PIXEL_UNPACK_BUFFER the data pointer is an offset in the buffer, the copy is done by the GPU
+	FrameSlot &slot = _slots[_iReadSlot];
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.unBuffer);
+	glBindTexture(GL_TEXTURE_2D, _texture.getTextureData().textureID);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, _nFrameWidth, _nFrameHeight, GL_RGBA, GL_UNSIGNED_BYTE, slot.unBuffer ? nullptr : slot.pData);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	if (slot.unBuffer) {
+		slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+	_bHasFrame = true;
+}
+
+//--------------------------------------------------------------
+ofxOpenVRCameraStats ofxOpenVRCamera::getStats() const {
+	ofxOpenVRCameraStats stats;
+	stats.framesReceived = _nFramesReceived;
+	stats.framesDropped = _nFramesDropped;
+	stats.framesMissed = _nFramesMissed;
+	stats.framesDisplayed = _nFramesDisplayed;
+	stats.lastAgeMs = _fLastAgeMs;
+	stats.avgAgeMs = _nFramesDisplayed ? float(_dAgeSumMs / _nFramesDisplayed) : 0.0f;
+	stats.maxAgeMs = _fMaxAgeMs;
+	return stats;
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "ofxOpenVRBackend.h"
+#include <atomic>
+#include <thread>
+
+/*
+	Tracked camera passthrough: streams frames of the HMD camera into a GL texture which eye passes sample directly.
+
+	Frames are received by a worker thread, which polls the runtime for a new nFrameSequence and fills a triple buffer:
+	the worker always has a slot to write, the render thread always takes the newest complete frame without waiting,
+	and frames not taken in time are dropped. Backends which must be called from the render thread
+	(fake, recording and replay, see ofxOpenVRBackend::IsCameraThreadSafe) receive frames in acquireFrame() instead.
+
+	Two paths, chosen in start():
+	- SharedTexture: the runtime's own texture from GetVideoStreamTextureGL is sampled, no copies at all.
+	  Only the part given by getTextureBounds() holds the frame.
+	- PixelBuffer: when the runtime can't share textures (fake and replay backends, older runtimes),
+	  GetVideoStreamFrameBuffer writes the frame straight into a persistently mapped pixel buffer object,
+	  which is uploaded into the texture by the GPU. Without GL_ARB_buffer_storage frames are written to memory
+	  and uploaded from it.
+
+	Streaming runs only between start() and stop(): ofxOpenVR starts it when the camera is shown and stops it when hidden,
+	so a hidden passthrough costs no USB bandwidth, no thread and no copies.
+
+	The frame holds both eyes one above the other: the first rows (v from 0 to 0.5 of the bounds) are the right eye,
+	the last ones are the left eye. The frame header keeps the HMD pose at the capture time,
+	ofxOpenVR uses it with getProjection() to reproject the frame to the current eye pose.
+
+	ofxOpenVR streams the HMD camera itself; to sample the frame in own passes:
+		const ofxOpenVRCamera &camera = openVR.getCamera();
+		if (camera.hasFrame()) {
+			shader.setUniformTexture("cam", camera.getTexture(), 0);
+			shader.setUniform4f("texBounds", camera.getTextureBounds());
+		}
+		ofxOpenVRCameraStats stats = camera.getStats();
+*/
+
+//--------------------------------------------------------------
+struct ofxOpenVRCameraStats {
+	uint64_t framesReceived = 0;	//frames got from the runtime
+	uint64_t framesDropped = 0;		//received, but replaced by a newer frame before the render thread took them
+	uint64_t framesMissed = 0;		//gaps in nFrameSequence: frames of the runtime which were never received
+	uint64_t framesDisplayed = 0;	//frames taken by the render thread
+	float lastAgeMs = 0;			//time from receiving a frame to taking it by the render thread
+	float avgAgeMs = 0;
+	float maxAgeMs = 0;
+};
+
+//--------------------------------------------------------------
+class ofxOpenVRCamera {
+public:
+	enum class Mode {
+		None,			//not streaming
+		SharedTexture,	//runtime's texture is sampled directly
+		PixelBuffer		//frames are uploaded from pixel buffers into own texture
+	};
+
+	ofxOpenVRCamera();
+	~ofxOpenVRCamera();
+
+	bool start(ofxOpenVRBackend *pVR, vr::TrackedDeviceIndex_t unDevice = vr::k_unTrackedDeviceIndex_Hmd);	//call with GL context
+	void stop();
+
+	bool acquireFrame();	//takes the newest received frame, returns true if it is new
+	void uploadFrame();		//queues upload of the taken frame into the texture, nothing to do for shared textures
+	bool update();			//both of the above
+
+	bool isStreaming() const { return _mode != Mode::None; }
+	bool isThreaded() const { return _thread.joinable(); }
+	Mode getMode() const { return _mode; }
+	bool hasFrame() const { return _bHasFrame; }
+
+	const ofTexture &getTexture() const { return _texture; }	//GL_TEXTURE_2D
+	const glm::vec4 &getTextureBounds() const { return _textureBounds; }	//uMin, vMin, uMax, vMax of the frame in the texture
+	uint32_t getFrameWidth() const { return _nFrameWidth; }		//whole frame with both eyes
+	uint32_t getFrameHeight() const { return _nFrameHeight; }
+	const vr::CameraVideoStreamFrameHeader_t &getFrameHeader() const { return _frameHeader; }	//of the taken frame
+
+	//Frame type, restarts streaming if it is running. Default is Undistorted.
+	//Distorted frames have no projection, so they are not reprojected.
+	void setFrameType(vr::EVRTrackedCameraFrameType eFrameType);
+	vr::EVRTrackedCameraFrameType getFrameType() const { return _eFrameType; }
+
+	//Frames per second to receive, 0 - every frame of the camera. Skipped frames cost neither copies nor uploads.
+	void setFrameRate(float fFps);
+	float getFrameRate() const;
+
+	//Camera space to normalized coordinates of each eye's half of the frame, from GetCameraProjection
+	bool hasProjection() const { return _bHasProjection; }
+	const glm::mat4 &getProjection() const { return _projection; }
+	//Pose of the (first) camera in head space, from Prop_CameraToHeadTransform_Matrix34
+	bool hasCameraToHead() const { return _bHasCameraToHead; }
+	const glm::mat4 &getCameraToHead() const { return _cameraToHead; }
+
+	ofxOpenVRCameraStats getStats() const;
+
+	//Take effect at the next start()
+	bool preferSharedTexture = true;	//false - always use pixel buffers
+	bool useThread = true;				//false - receive frames in acquireFrame() with any backend
+
+protected:
+	static const int kSlotCount = 3;
+	static const int kSlotMask = 3;
+	static const int kNewFrame = 4;				//flag in _iReadySlot: the slot holds a frame not taken yet
+	static const int kPollIntervalMicros = 1000;	//worker's sleep when there is no new frame
+	static const int kMaxSleepMicros = 20000;
+
+	struct FrameSlot {
+		GLuint unBuffer = 0;			//pixel buffer, 0 if the frame is kept in 'memory'
+		void *pData = nullptr;			//persistently mapped buffer or memory.data(), nullptr for shared textures
+		std::vector<uint8_t> memory;
+		GLsync fence = nullptr;			//signaled when the GPU finished reading the buffer
+		vr::CameraVideoStreamFrameHeader_t header;
+		uint64_t ulReceivedMicros = 0;
+	};
+
+	ofxOpenVRBackend *_pVR;
+	vr::TrackedDeviceIndex_t _unDevice;
+	vr::TrackedCameraHandle_t _hCamera;
+	Mode _mode;
+	vr::EVRTrackedCameraFrameType _eFrameType;
+	std::atomic<uint64_t> _ulFrameIntervalMicros;	//0 - every frame
+
+	uint32_t _nFrameWidth;
+	uint32_t _nFrameHeight;
+	uint32_t _nFrameBufferSize;
+	vr::CameraVideoStreamFrameHeader_t _frameHeader;
+	bool _bHasFrame;
+
+	ofTexture _texture;
+	glm::vec4 _textureBounds;
+	glm::mat4 _projection;
+	bool _bHasProjection;
+	glm::mat4 _cameraToHead;
+	bool _bHasCameraToHead;
+	vr::glUInt_t _unSharedTexture;	//texture got from the runtime, released when the next one arrives
+
+	//Triple buffer: _iWriteSlot belongs to the receiving thread, _iReadSlot to the render thread
+	std::array<FrameSlot, kSlotCount> _slots;
+	int _iWriteSlot;
+	int _iReadSlot;
+	std::atomic<int> _iReadySlot;
+	bool _bPersistentMapping;
+	bool _bUploadPending;
+
+	std::thread _thread;
+	std::atomic<bool> _bThreadRunning;
+
+	//Written by the receiving thread
+	uint32_t _nLastFrameSequence;
+	uint64_t _ulLastReceivedMicros;
+	std::atomic<uint64_t> _nFramesReceived;
+	std::atomic<uint64_t> _nFramesDropped;
+	std::atomic<uint64_t> _nFramesMissed;
+
+	//Written by the render thread
+	uint64_t _nFramesDisplayed;
+	double _dAgeSumMs;
+	float _fLastAgeMs;
+	float _fMaxAgeMs;
+
+	void startThread();
+	void stopThread();
+	void threadedFunction();
+	bool receiveFrame();
+	uint64_t getMicrosToNextFrame() const;
+
+	bool setupPixelBuffers();
+	void releasePixelBuffers();
+	bool acquireSharedTexture(vr::CameraVideoStreamFrameHeader_t &frameHeader);
+	void releaseSharedTexture();
+	void resetSlots();
+};
@@ -0,0 +1,39 @@
+#include "ofxOpenVRDevicePoses.h"
+
+//--------------------------------------------------------------
+int ofxOpenVRDevicePoses::find(vr::TrackedDeviceIndex_t unDevice) const {
+	for (int i = 0; i < count; i++) {
+		if (deviceIndex[i] == unDevice) return i;
+	}
+	return -1;
+}
+
+//--------------------------------------------------------------
+int ofxOpenVRDevicePoses::findByRole(vr::ETrackedControllerRole controllerRole) const {
+	for (int i = 0; i < count; i++) {
+		if (deviceClass[i] == vr::TrackedDeviceClass_Controller && role[i] == controllerRole) return i;
+	}
+	return -1;
+}
+
+//--------------------------------------------------------------
+int ofxOpenVRDevicePoses::countOf(vr::ETrackedDeviceClass cls) const {
+	int n = 0;
+	for (int i = 0; i < count; i++) {
+		if (deviceClass[i] == cls) n++;
+	}
+	return n;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRDevicePoses::add(vr::TrackedDeviceIndex_t unDevice, vr::ETrackedDeviceClass cls, vr::ETrackedControllerRole controllerRole, const vr::TrackedDevicePose_t &devicePose, const glm::mat4 &matPose) {
+	if (count >= kCapacity) return;
+	int i = count++;
+	deviceIndex[i] = unDevice;
+	deviceClass[i] = cls;
+	role[i] = controllerRole;
+	valid[i] = devicePose.bPoseIsValid;
+	pose[i] = matPose;
+	velocity[i] = glm::vec3(devicePose.vVelocity.v[0], devicePose.vVelocity.v[1], devicePose.vVelocity.v[2]);
+	angularVelocity[i] = glm::vec3(devicePose.vAngularVelocity.v[0], devicePose.vAngularVelocity.v[1], devicePose.vAngularVelocity.v[2]);
+}
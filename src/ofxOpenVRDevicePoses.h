@@ -0,0 +1,47 @@
+#pragma once
+
+#include "ofMain.h"
+#include <openvr.h>
+
+/*
+	Poses of all connected tracked devices (HMD, controllers, generic trackers, base stations),
+	stored as structure of arrays. Slots 0..count-1 are filled by ofxOpenVR::update() in the order of device indices,
+	so an app can walk all devices each frame without calls into the runtime and without copying matrices.
+
+	Usage:
+		const ofxOpenVRDevicePoses &poses = openVR.getDevicePoses();
+		for (int i = 0; i < poses.count; i++) {
+			if (poses.deviceClass[i] == vr::TrackedDeviceClass_GenericTracker && poses.valid[i]) {
+				ofPushMatrix();
+				ofMultMatrix(poses.pose[i]);
+				ofDrawBox(0.05);
+				ofPopMatrix();
+			}
+		}
+*/
+
+//--------------------------------------------------------------
+class ofxOpenVRDevicePoses {
+public:
+	static const int kCapacity = vr::k_unMaxTrackedDeviceCount;
+
+	int count = 0;	//number of filled slots
+	std::array<vr::TrackedDeviceIndex_t, kCapacity> deviceIndex;
+	std::array<vr::ETrackedDeviceClass, kCapacity> deviceClass;
+	std::array<vr::ETrackedControllerRole, kCapacity> role;
+	std::array<bool, kCapacity> valid;					//pose is valid in this frame
+	std::array<glm::mat4, kCapacity> pose;				//device to world (standing space), meters
+	std::array<glm::vec3, kCapacity> velocity;			//meters/second
+	std::array<glm::vec3, kCapacity> angularVelocity;	//radians/second
+
+	//Slot of the device, -1 if it is not connected
+	int find(vr::TrackedDeviceIndex_t unDevice) const;
+	//Slot of the first controller with the role, -1 if none
+	int findByRole(vr::ETrackedControllerRole controllerRole) const;
+	//Number of connected devices of the class
+	int countOf(vr::ETrackedDeviceClass cls) const;
+
+	void clear() { count = 0; }
+	//Appends a device, called by ofxOpenVR
+	void add(vr::TrackedDeviceIndex_t unDevice, vr::ETrackedDeviceClass cls, vr::ETrackedControllerRole controllerRole, const vr::TrackedDevicePose_t &devicePose, const glm::mat4 &matPose);
+};
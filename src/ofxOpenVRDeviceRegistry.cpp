@@ -0,0 +1,129 @@
+#include "ofxOpenVRDeviceRegistry.h"
+
+//--------------------------------------------------------------
+std::string ofxOpenVRDeviceRegistry::getDeviceString(ofxOpenVRBackend *pVR, vr::TrackedDeviceIndex_t unDevice, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError *peError) {
+	char buffer[256];
+	vr::ETrackedPropertyError error = vr::TrackedProp_Success;
+	uint32_t unLen = pVR->GetStringTrackedDeviceProperty(unDevice, prop, buffer, sizeof(buffer), &error);
+	if (error == vr::TrackedProp_BufferTooSmall) {
+		std::string result(unLen, '\0');
+		pVR->GetStringTrackedDeviceProperty(unDevice, prop, &result[0], unLen, &error);
+		result.resize(unLen - 1);
+		if (peError) *peError = error;
+		return (error == vr::TrackedProp_Success) ? result : "";
+	}
+	if (peError) *peError = error;
+	if (unLen == 0 || error != vr::TrackedProp_Success) return "";
+	return buffer;
+}
+
+//--------------------------------------------------------------
+ofxOpenVRDeviceRegistry::ofxOpenVRDeviceRegistry() {
+	_pVR = nullptr;
+	_nVersion = 0;
+	_activeDevices.reserve(vr::k_unMaxTrackedDeviceCount);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRDeviceRegistry::setup(ofxOpenVRBackend *pVR) {
+	_pVR = pVR;
+	refreshAll();
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRDeviceRegistry::clear() {
+	_pVR = nullptr;
+	_devices.fill(ofxOpenVRDeviceInfo());
+	_activeDevices.clear();
+	_nVersion++;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRDeviceRegistry::refreshAll() {
+	if (!_pVR) return;
+	for (vr::TrackedDeviceIndex_t i = 0; i < vr::k_unMaxTrackedDeviceCount; i++) {
+		query(i);
+	}
+	updateActiveDevices();
+	_nVersion++;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRDeviceRegistry::refresh(vr::TrackedDeviceIndex_t unDevice) {
+	if (!_pVR || unDevice >= vr::k_unMaxTrackedDeviceCount) return;
+	if (query(unDevice)) {
+		updateActiveDevices();
+		_nVersion++;
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRDeviceRegistry::processEvent(const vr::VREvent_t &event) {
+	uint64_t nVersion = _nVersion;
+	switch (event.eventType) {
+		case vr::VREvent_TrackedDeviceActivated:
+		case vr::VREvent_TrackedDeviceDeactivated:
+		case vr::VREvent_TrackedDeviceUpdated:
+			refresh(event.trackedDeviceIndex);
+			break;
+
+		case vr::VREvent_TrackedDeviceRoleChanged:
+			// The event is not always sent for the device whose role changed, so re-read roles of all connected devices
+			if (!_pVR) break;
+			for (vr::TrackedDeviceIndex_t i : _activeDevices) {
+				vr::ETrackedControllerRole role = _pVR->GetControllerRoleForTrackedDeviceIndex(i);
+				if (role != _devices[i].role) {
+					_devices[i].role = role;
+					_nVersion = nVersion + 1;
+				}
+			}
+			break;
+	}
+	return _nVersion != nVersion;
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRDeviceRegistry::query(vr::TrackedDeviceIndex_t unDevice) {
+	ofxOpenVRDeviceInfo info;
+	info.bConnected = _pVR->IsTrackedDeviceConnected(unDevice);
+	if (info.bConnected) {
+		info.deviceClass = _pVR->GetTrackedDeviceClass(unDevice);
+		info.role = _pVR->GetControllerRoleForTrackedDeviceIndex(unDevice);
+		info.serialNumber = getDeviceString(_pVR, unDevice, vr::Prop_SerialNumber_String);
+		info.renderModelName = getDeviceString(_pVR, unDevice, vr::Prop_RenderModelName_String);
+	}
+
+	ofxOpenVRDeviceInfo &current = _devices[unDevice];
+	bool bChanged = current.bConnected != info.bConnected || current.deviceClass != info.deviceClass || current.role != info.role
+		|| current.serialNumber != info.serialNumber || current.renderModelName != info.renderModelName;
+	if (bChanged) {
+		current = info;
+	}
+	return bChanged;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRDeviceRegistry::updateActiveDevices() {
+	_activeDevices.clear();
+	for (vr::TrackedDeviceIndex_t i = 0; i < vr::k_unMaxTrackedDeviceCount; i++) {
+		if (_devices[i].bConnected) {
+			_activeDevices.push_back(i);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+const ofxOpenVRDeviceInfo &ofxOpenVRDeviceRegistry::get(vr::TrackedDeviceIndex_t unDevice) const {
+	static const ofxOpenVRDeviceInfo invalid;
+	return (unDevice < vr::k_unMaxTrackedDeviceCount) ? _devices[unDevice] : invalid;
+}
+
+//--------------------------------------------------------------
+vr::TrackedDeviceIndex_t ofxOpenVRDeviceRegistry::getControllerIndex(vr::ETrackedControllerRole role) const {
+	for (vr::TrackedDeviceIndex_t i : _activeDevices) {
+		if (_devices[i].deviceClass == vr::TrackedDeviceClass_Controller && _devices[i].role == role) {
+			return i;
+		}
+	}
+	return vr::k_unTrackedDeviceIndexInvalid;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "ofxOpenVRBackend.h"
+
+/*
+	Cache of tracked devices' class, role, serial number, render model name and connection state.
+
+	Querying these from the runtime is an IPC round trip, so ofxOpenVR reads them once
+	and refreshes a device only on TrackedDeviceActivated/Deactivated/Updated and TrackedDeviceRoleChanged events.
+	getActiveDevices() is a compact list of connected indices, used for per-frame walks over poses.
+
+	Usage:
+		for (vr::TrackedDeviceIndex_t i : openVR.getDevices().getActiveDevices()) {
+			const ofxOpenVRDeviceInfo &info = openVR.getDevices().get(i);
+			cout << i << " " << info.serialNumber << endl;
+		}
+*/
+
+//--------------------------------------------------------------
+struct ofxOpenVRDeviceInfo {
+	bool bConnected = false;
+	vr::ETrackedDeviceClass deviceClass = vr::TrackedDeviceClass_Invalid;
+	vr::ETrackedControllerRole role = vr::TrackedControllerRole_Invalid;
+	std::string serialNumber;
+	std::string renderModelName;
+};
+
+//--------------------------------------------------------------
+class ofxOpenVRDeviceRegistry {
+public:
+	ofxOpenVRDeviceRegistry();
+
+	void setup(ofxOpenVRBackend *pVR);	//reads all devices
+	void clear();
+
+	void refreshAll();
+	void refresh(vr::TrackedDeviceIndex_t unDevice);
+	//Refreshes the cache if the event is about device (de)activation, update or role change.
+	//Returns true if the cache was changed
+	bool processEvent(const vr::VREvent_t &event);
+
+	const ofxOpenVRDeviceInfo &get(vr::TrackedDeviceIndex_t unDevice) const;
+	bool isConnected(vr::TrackedDeviceIndex_t unDevice) const { return get(unDevice).bConnected; }
+	vr::ETrackedDeviceClass getClass(vr::TrackedDeviceIndex_t unDevice) const { return get(unDevice).deviceClass; }
+	vr::ETrackedControllerRole getRole(vr::TrackedDeviceIndex_t unDevice) const { return get(unDevice).role; }
+
+	//Connected devices in the order of indices
+	const std::vector<vr::TrackedDeviceIndex_t> &getActiveDevices() const { return _activeDevices; }
+	//Connected controller with the role, k_unTrackedDeviceIndexInvalid if none
+	vr::TrackedDeviceIndex_t getControllerIndex(vr::ETrackedControllerRole role) const;
+
+	uint64_t getVersion() const { return _nVersion; }	//incremented on each change of the cache
+
+	//Reads a string property, short values don't need a temporary buffer on the heap
+	static std::string getDeviceString(ofxOpenVRBackend *pVR, vr::TrackedDeviceIndex_t unDevice, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError *peError = nullptr);
+
+protected:
+	ofxOpenVRBackend *_pVR;
+	std::array<ofxOpenVRDeviceInfo, vr::k_unMaxTrackedDeviceCount> _devices;
+	std::vector<vr::TrackedDeviceIndex_t> _activeDevices;
+	uint64_t _nVersion;
+
+	bool query(vr::TrackedDeviceIndex_t unDevice);	//returns true if the device's info was changed
+	void updateActiveDevices();
+};
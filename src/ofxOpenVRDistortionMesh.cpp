@@ -0,0 +1,417 @@
+#include "ofxOpenVRDistortionMesh.h"
+#include <thread>
+
+namespace {
+	const char kMagic[8] = { 'O', 'F', 'X', 'V', 'R', 'L', 'M', '\0' };
+	const uint32_t kFormatVersion = 2;
+
+	const int kLatticeSize = 512;	//finest vertex positions along a side of an eye's adaptive mesh
+	const int kBaseCellSize = 64;	//8x8 cells to start with
+	const int kMinCellSize = 2;		//smallest cell with its center and edge midpoints on the lattice
+	const int kMaxVerticesPerSplit = 13;	//center and midpoints, fan centers of 4 children and 4 neighbors
+
+	struct FileHeader {
+		char magic[8];
+		uint32_t unFormatVersion;
+		uint32_t unAdaptive;
+		uint32_t unGridSize;		//uniform mesh only
+		uint32_t unVertexBudget;	//adaptive mesh only
+		float fTolerance;			//adaptive mesh only
+		uint32_t unLeftIndexCount;
+		char runtimeVersion[64];
+		char serial[64];
+		uint32_t unVertexCount;
+		uint32_t unIndexCount;
+	};
+	static_assert(sizeof(FileHeader) == 168, "distortion mesh cache header layout changed, increase kFormatVersion");
+	static_assert(sizeof(ofxOpenVRLensVertex) == 32, "lens vertex layout changed, increase kFormatVersion");
+
+	struct Sample {
+		ofxOpenVRLensVertex vert;
+		bool bCorner = false;	//vertex of a cell, otherwise only tested against interpolation
+	};
+
+	struct Cell {
+		int x, y, size;		//in lattice units
+		float error;		//negative until it is evaluated
+	};
+
+	//--------------------------------------------------------------
+	uint32_t getKey(int x, int y) {
+		return (uint32_t(x) << 16) | uint32_t(y);
+	}
+
+	//--------------------------------------------------------------
+	// Purpose: Settings the mesh depends on, the others are zeroed so they don't invalidate the cache
+	//--------------------------------------------------------------
+	void setKey(FileHeader &header, const ofxOpenVRDistortionMeshSettings &settings) {
+		header.unAdaptive = settings.adaptive ? 1 : 0;
+		header.unGridSize = settings.adaptive ? 0 : uint32_t(settings.gridSize);
+		header.unVertexBudget = settings.adaptive ? uint32_t(settings.vertexBudget) : 0;
+		header.fTolerance = settings.adaptive ? settings.tolerance : 0;
+	}
+
+	//--------------------------------------------------------------
+	// Purpose: Calls fn(i) for i in [0, nCount), interleaved between nThreads threads including the calling one
+	//--------------------------------------------------------------
+	void parallelFor(int nCount, int nThreads, const std::function<void(int)> &fn) {
+		nThreads = std::max(1, std::min(nThreads, nCount));
+		auto run = [&fn, nCount, nThreads](int nFirst) {
+			for (int i = nFirst; i < nCount; i += nThreads) fn(i);
+		};
+		std::vector<std::thread> workers;
+		workers.reserve(nThreads - 1);
+		for (int i = 1; i < nThreads; i++) {
+			workers.emplace_back(run, i);
+		}
+		run(0);
+		for (std::thread &worker : workers) {
+			worker.join();
+		}
+	}
+
+	//--------------------------------------------------------------
+	void computeTexCoords(ofxOpenVRBackend *pVR, vr::Hmd_Eye eye, float u, float v, ofxOpenVRLensVertex &vert) {
+		vr::DistortionCoordinates_t dc0;
+		pVR->ComputeDistortion(eye, u, v, &dc0);
+
+		vert.texCoordRed = glm::vec2(dc0.rfRed[0], 1 - dc0.rfRed[1]);
+		vert.texCoordGreen = glm::vec2(dc0.rfGreen[0], 1 - dc0.rfGreen[1]);
+		vert.texCoordBlue = glm::vec2(dc0.rfBlue[0], 1 - dc0.rfBlue[1]);
+	}
+
+	//--------------------------------------------------------------
+	// Purpose: UVs are linear along a triangle's edge, so the midpoint of a and b gets their average;
+	// the largest difference from the actual UVs of any channel
+	//--------------------------------------------------------------
+	float getMidpointError(const ofxOpenVRLensVertex &a, const ofxOpenVRLensVertex &b, const ofxOpenVRLensVertex &actual) {
+		auto getError = [](const glm::vec2 &p, const glm::vec2 &q, const glm::vec2 &r) {
+			glm::vec2 d = (p + q) * 0.5f - r;
+			return std::max(std::abs(d.x), std::abs(d.y));
+		};
+		return std::max({ getError(a.texCoordRed, b.texCoordRed, actual.texCoordRed),
+			getError(a.texCoordGreen, b.texCoordGreen, actual.texCoordGreen),
+			getError(a.texCoordBlue, b.texCoordBlue, actual.texCoordBlue) });
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRDistortionMesh::build(ofxOpenVRBackend *pVR, const std::string &sHmdSerial, const std::string &sRuntimeVersion, const ofxOpenVRDistortionMeshSettings &settings) {
+	clear();
+	if (!pVR) return false;
+
+	ofxOpenVRDistortionMeshSettings mesh = settings;
+	mesh.gridSize = std::min(std::max(settings.gridSize, 2), int(kMaxGridSize));
+	mesh.vertexBudget = std::min(std::max(settings.vertexBudget, int(kMinVertexBudget)), int(kMaxVertexBudget));
+	mesh.tolerance = std::max(settings.tolerance, 0.0f);
+
+	bool bCache = !settings.cacheDirectory.empty() && !sHmdSerial.empty()
+		&& sHmdSerial.size() < sizeof(FileHeader::serial) && sRuntimeVersion.size() < sizeof(FileHeader::runtimeVersion);
+	std::string sDirectory = bCache ? ofToDataPath(settings.cacheDirectory, true) : "";
+	std::string sPath = bCache ? getPath(sDirectory, sHmdSerial) : "";
+
+	if (bCache && load(sPath, sHmdSerial, sRuntimeVersion, mesh)) {
+		_bFromCache = true;
+		return true;
+	}
+
+	int nThreads = (settings.threads > 0) ? settings.threads : int(std::thread::hardware_concurrency());
+	nThreads = std::max(nThreads, 1);
+	uint64_t ulStart = ofGetElapsedTimeMicros();
+	if (mesh.adaptive) {
+		_vertices.reserve(size_t(mesh.vertexBudget) * 2);
+		_indices.reserve(size_t(mesh.vertexBudget) * 2 * 6);
+		computeAdaptive(pVR, vr::Eye_Left, mesh.tolerance, mesh.vertexBudget, nThreads);
+		_unLeftIndexCount = uint32_t(_indices.size());
+		computeAdaptive(pVR, vr::Eye_Right, mesh.tolerance, mesh.vertexBudget, nThreads);
+	}
+	else {
+		computeUniform(pVR, mesh.gridSize, nThreads);
+	}
+	ofLogNotice("ofxOpenVR") << "Distortion mesh of " << _vertices.size() << " vertices and " << _indices.size() / 3 << " triangles computed in "
+		<< ofToString((ofGetElapsedTimeMicros() - ulStart) / 1000.0f, 1) << " ms";
+
+	if (bCache) {
+		ofDirectory::createDirectory(sDirectory, false, true);
+		save(sPath, sHmdSerial, sRuntimeVersion, mesh);
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRDistortionMesh::clear() {
+	_vertices.clear();
+	_indices.clear();
+	_unLeftIndexCount = 0;
+	_bFromCache = false;
+}
+
+//--------------------------------------------------------------
+// Purpose: Rows of both eyes are interleaved between threads,
+// each vertex is written to its own slot so threads share nothing
+//--------------------------------------------------------------
+void ofxOpenVRDistortionMesh::computeUniform(ofxOpenVRBackend *pVR, int nGridSize, int nThreads) {
+	int nRows = nGridSize * 2;
+	_vertices.resize(size_t(nRows) * nGridSize);
+
+	float w = (float)(1.0 / float(nGridSize - 1));
+	float h = (float)(1.0 / float(nGridSize - 1));
+
+	parallelFor(nRows, nThreads, [this, pVR, nGridSize, w, h](int row) {
+		// left eye's rows go first
+		vr::Hmd_Eye eye = (row < nGridSize) ? vr::Eye_Left : vr::Eye_Right;
+		float Xoffset = (eye == vr::Eye_Left) ? -1 : 0;
+		int y = row % nGridSize;
+		for (int x = 0; x < nGridSize; x++)
+		{
+			float u = x*w, v = 1 - y*h;
+			ofxOpenVRLensVertex &vert = _vertices[size_t(row) * nGridSize + x];
+			vert.position = glm::vec2(Xoffset + u, -1 + 2 * y*h);
+			computeTexCoords(pVR, eye, u, v, vert);
+		}
+	});
+
+	_indices.reserve(size_t(nGridSize - 1) * (nGridSize - 1) * 6 * 2);
+	for (int eye = 0; eye < 2; eye++)
+	{
+		GLushort offset = GLushort(eye * nGridSize * nGridSize);
+		for (int y = 0; y < nGridSize - 1; y++)
+		{
+			for (int x = 0; x < nGridSize - 1; x++)
+			{
+				GLushort a = GLushort(nGridSize*y + x + offset);
+				GLushort b = GLushort(nGridSize*y + x + 1 + offset);
+				GLushort c = GLushort((y + 1)*nGridSize + x + 1 + offset);
+				GLushort d = GLushort((y + 1)*nGridSize + x + offset);
+				_indices.insert(_indices.end(), { a, b, c, a, c, d });
+			}
+		}
+		if (eye == 0) _unLeftIndexCount = uint32_t(_indices.size());
+	}
+}
+
+//--------------------------------------------------------------
+// Purpose: Splits cells of a quadtree, worst first, while their error is above
+// the tolerance and the vertex budget allows. Each round evaluates the new cells,
+// their samples are computed in parallel.
+//--------------------------------------------------------------
+void ofxOpenVRDistortionMesh::computeAdaptive(ofxOpenVRBackend *pVR, vr::Hmd_Eye eye, float fTolerance, int nVertexBudget, int nThreads) {
+	std::unordered_map<uint32_t, Sample> samples;
+	std::vector<uint32_t> pending;
+	int nCorners = 0;
+
+	auto request = [&samples, &pending](int x, int y) {
+		if (samples.emplace(getKey(x, y), Sample()).second) pending.push_back(getKey(x, y));
+	};
+	auto computePending = [&samples, &pending, pVR, eye, nThreads]() {
+		// only values are written, the map isn't changed while threads look up samples
+		parallelFor(int(pending.size()), nThreads, [&samples, &pending, pVR, eye](int i) {
+			uint32_t key = pending[i];
+			float u = float(key >> 16) / kLatticeSize;
+			float v = 1 - float(key & 0xFFFF) / kLatticeSize;
+			computeTexCoords(pVR, eye, u, v, samples.find(key)->second.vert);
+		});
+		pending.clear();
+	};
+	auto get = [&samples](int x, int y) -> Sample & {
+		return samples.find(getKey(x, y))->second;
+	};
+	auto addCorner = [&get, &nCorners](int x, int y) {
+		Sample &sample = get(x, y);
+		if (!sample.bCorner) nCorners++;
+		sample.bCorner = true;
+	};
+	auto isCorner = [&samples](int x, int y) {
+		auto it = samples.find(getKey(x, y));
+		return it != samples.end() && it->second.bCorner;
+	};
+	// A smaller neighbor's vertex on an edge makes the cell a fan around its center
+	auto needsFan = [&isCorner](const Cell &cell) {
+		int h = cell.size / 2;
+		return cell.size >= kMinCellSize && (isCorner(cell.x + h, cell.y) || isCorner(cell.x + cell.size, cell.y + h)
+			|| isCorner(cell.x + h, cell.y + cell.size) || isCorner(cell.x, cell.y + h));
+	};
+	// Triangles a,b,c and a,c,d of the cell interpolate its center from a and c
+	auto getCellError = [&get](const Cell &cell) {
+		int x0 = cell.x, y0 = cell.y, x1 = cell.x + cell.size, y1 = cell.y + cell.size, h = cell.size / 2;
+		const ofxOpenVRLensVertex &a = get(x0, y0).vert, &b = get(x1, y0).vert, &c = get(x1, y1).vert, &d = get(x0, y1).vert;
+		return std::max({ getMidpointError(a, c, get(x0 + h, y0 + h).vert),
+			getMidpointError(a, b, get(x0 + h, y0).vert), getMidpointError(b, c, get(x1, y0 + h).vert),
+			getMidpointError(c, d, get(x0 + h, y1).vert), getMidpointError(d, a, get(x0, y0 + h).vert) });
+	};
+
+	std::vector<Cell> leaves;
+	for (int y = 0; y <= kLatticeSize; y += kBaseCellSize) {
+		for (int x = 0; x <= kLatticeSize; x += kBaseCellSize) {
+			request(x, y);
+			if (x < kLatticeSize && y < kLatticeSize) leaves.push_back({ x, y, kBaseCellSize, -1 });
+		}
+	}
+	computePending();
+	for (int y = 0; y <= kLatticeSize; y += kBaseCellSize) {
+		for (int x = 0; x <= kLatticeSize; x += kBaseCellSize) {
+			addCorner(x, y);
+		}
+	}
+
+	std::vector<int> candidates;
+	for (;;) {
+		for (const Cell &cell : leaves) {
+			if (cell.error >= 0 || cell.size < kMinCellSize) continue;
+			int h = cell.size / 2;
+			request(cell.x + h, cell.y + h);
+			request(cell.x + h, cell.y);
+			request(cell.x + cell.size, cell.y + h);
+			request(cell.x + h, cell.y + cell.size);
+			request(cell.x, cell.y + h);
+		}
+		computePending();
+
+		candidates.clear();
+		for (int i = 0; i < int(leaves.size()); i++) {
+			Cell &cell = leaves[i];
+			if (cell.error < 0) cell.error = (cell.size < kMinCellSize) ? 0 : getCellError(cell);
+			if (cell.error > fTolerance) candidates.push_back(i);
+		}
+		std::sort(candidates.begin(), candidates.end(), [&leaves](int a, int b) { return leaves[a].error > leaves[b].error; });
+
+		// Splits add at most kMaxVerticesPerSplit vertices, the exact count is taken again next round
+		int nVertices = nCorners + int(std::count_if(leaves.begin(), leaves.end(), needsFan));
+		int nSplits = 0;
+		for (int i : candidates) {
+			if (nVertices + kMaxVerticesPerSplit > nVertexBudget) break;
+			Cell parent = leaves[i];
+			int h = parent.size / 2;
+			addCorner(parent.x + h, parent.y + h);
+			addCorner(parent.x + h, parent.y);
+			addCorner(parent.x + parent.size, parent.y + h);
+			addCorner(parent.x + h, parent.y + parent.size);
+			addCorner(parent.x, parent.y + h);
+			leaves[i] = { parent.x, parent.y, h, -1 };
+			leaves.push_back({ parent.x + h, parent.y, h, -1 });
+			leaves.push_back({ parent.x + h, parent.y + h, h, -1 });
+			leaves.push_back({ parent.x, parent.y + h, h, -1 });
+			nVertices += kMaxVerticesPerSplit;
+			nSplits++;
+		}
+		if (nSplits == 0) break;
+	}
+
+	// Vertices are appended to the other eye's ones
+	std::unordered_map<uint32_t, GLushort> vertexIndices;
+	float fXoffset = (eye == vr::Eye_Left) ? -1 : 0;
+	auto getVertex = [&](int x, int y) {
+		auto inserted = vertexIndices.emplace(getKey(x, y), GLushort(_vertices.size()));
+		if (inserted.second) {
+			ofxOpenVRLensVertex vert = get(x, y).vert;
+			vert.position = glm::vec2(fXoffset + float(x) / kLatticeSize, -1 + 2 * float(y) / kLatticeSize);
+			_vertices.push_back(vert);
+		}
+		return inserted.first->second;
+	};
+	// Vertices of the edge from (x0, y0) to (x1, y1) in order, without the last one
+	std::vector<GLushort> boundary;
+	std::function<void(int, int, int, int)> addEdge = [&](int x0, int y0, int x1, int y1) {
+		int mx = (x0 + x1) / 2, my = (y0 + y1) / 2;
+		if (std::abs(x1 - x0) + std::abs(y1 - y0) >= kMinCellSize && isCorner(mx, my)) {
+			addEdge(x0, y0, mx, my);
+			addEdge(mx, my, x1, y1);
+		}
+		else {
+			boundary.push_back(getVertex(x0, y0));
+		}
+	};
+
+	for (const Cell &cell : leaves) {
+		int x0 = cell.x, y0 = cell.y, x1 = cell.x + cell.size, y1 = cell.y + cell.size;
+		boundary.clear();
+		addEdge(x0, y0, x1, y0);
+		addEdge(x1, y0, x1, y1);
+		addEdge(x1, y1, x0, y1);
+		addEdge(x0, y1, x0, y0);
+		if (boundary.size() == 4) {
+			_indices.insert(_indices.end(), { boundary[0], boundary[1], boundary[2], boundary[0], boundary[2], boundary[3] });
+		}
+		else {
+			GLushort center = getVertex(x0 + cell.size / 2, y0 + cell.size / 2);
+			for (size_t i = 0; i < boundary.size(); i++) {
+				_indices.insert(_indices.end(), { center, boundary[i], boundary[(i + 1) % boundary.size()] });
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRDistortionMesh::load(const std::string &sPath, const std::string &sHmdSerial, const std::string &sRuntimeVersion, const ofxOpenVRDistortionMeshSettings &settings) {
+	std::ifstream file(sPath, std::ios::binary);
+	if (!file) return false;
+
+	FileHeader header;
+	if (!file.read((char *)&header, sizeof(header))) return false;
+	header.runtimeVersion[sizeof(header.runtimeVersion) - 1] = '\0';
+	header.serial[sizeof(header.serial) - 1] = '\0';
+	FileHeader key;
+	setKey(key, settings);
+	if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.unFormatVersion != kFormatVersion
+		|| header.unAdaptive != key.unAdaptive || header.unGridSize != key.unGridSize
+		|| header.unVertexBudget != key.unVertexBudget || header.fTolerance != key.fTolerance
+		|| sRuntimeVersion != header.runtimeVersion || sHmdSerial != header.serial
+		|| header.unVertexCount > 0x10000 || header.unIndexCount % 3 != 0
+		|| header.unLeftIndexCount > header.unIndexCount || header.unLeftIndexCount % 3 != 0) {
+		return false;
+	}
+
+	_vertices.resize(header.unVertexCount);
+	_indices.resize(header.unIndexCount);
+	_unLeftIndexCount = header.unLeftIndexCount;
+	file.read((char *)_vertices.data(), std::streamsize(_vertices.size() * sizeof(ofxOpenVRLensVertex)));
+	file.read((char *)_indices.data(), std::streamsize(_indices.size() * sizeof(GLushort)));
+	bool bValid = bool(file) && std::all_of(_indices.begin(), _indices.end(), [this](GLushort i) { return i < _vertices.size(); });
+	if (!bValid) {
+		ofLogWarning("ofxOpenVR") << "Ignoring broken distortion mesh cache " << sPath;
+		clear();
+	}
+	return bValid;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRDistortionMesh::save(const std::string &sPath, const std::string &sHmdSerial, const std::string &sRuntimeVersion, const ofxOpenVRDistortionMeshSettings &settings) const {
+	FileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.unFormatVersion = kFormatVersion;
+	setKey(header, settings);
+	header.unLeftIndexCount = _unLeftIndexCount;
+	strncpy(header.runtimeVersion, sRuntimeVersion.c_str(), sizeof(header.runtimeVersion) - 1);
+	strncpy(header.serial, sHmdSerial.c_str(), sizeof(header.serial) - 1);
+	header.unVertexCount = uint32_t(_vertices.size());
+	header.unIndexCount = uint32_t(_indices.size());
+
+	std::string sTempPath = sPath + ".tmp";
+	{
+		std::ofstream file(sTempPath, std::ios::binary | std::ios::trunc);
+		file.write((const char *)&header, sizeof(header));
+		file.write((const char *)_vertices.data(), std::streamsize(_vertices.size() * sizeof(ofxOpenVRLensVertex)));
+		file.write((const char *)_indices.data(), std::streamsize(_indices.size() * sizeof(GLushort)));
+		if (!file) {
+			ofLogError("ofxOpenVR") << "Unable to write distortion mesh cache " << sTempPath;
+			file.close();
+			std::remove(sTempPath.c_str());
+			return;
+		}
+	}
+	std::remove(sPath.c_str());	//rename() doesn't replace files on Windows
+	if (std::rename(sTempPath.c_str(), sPath.c_str()) != 0) {
+		ofLogError("ofxOpenVR") << "Unable to write distortion mesh cache " << sPath;
+		std::remove(sTempPath.c_str());
+	}
+}
+
+//--------------------------------------------------------------
+std::string ofxOpenVRDistortionMesh::getPath(const std::string &sDirectory, const std::string &sHmdSerial) {
+	std::string sFileName = sHmdSerial;
+	for (char &c : sFileName) {
+		if (!isalnum((unsigned char)c) && c != '_' && c != '-' && c != '.') c = '_';
+	}
+	return sDirectory + "/" + sFileName + ".vrlens";
+}
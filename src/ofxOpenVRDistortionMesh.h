@@ -0,0 +1,76 @@
+#pragma once
+
+#include "ofxOpenVRBackend.h"
+
+/*
+	Lens distortion mesh of both eyes, used by ofxOpenVR::renderDistortion().
+
+	Every vertex asks the runtime where the red, green and blue channels are sampled from.
+	The adaptive mesh starts from 8x8 cells per eye and splits a cell in four while the UVs
+	interpolated over its triangles miss ComputeDistortion() at its center or edge midpoints by more
+	than the tolerance. Worst cells are split first until the vertex budget is reached, so vertices
+	go to the edges of the lens where it distorts most. A cell next to smaller ones is drawn as a fan
+	around its center through their vertices, so there are no T-junctions and no seams.
+	The uniform mesh is a grid of gridSize x gridSize vertices per eye.
+
+	Sampling is expensive, so the mesh is saved to disk, keyed by the HMD's serial number,
+	the runtime version and the settings, and warm starts only read the file.
+	Cold starts spread the samples across worker threads.
+
+	Vertices of the left eye go first, then the right eye's; indices are 16-bit, in the same order.
+
+	ofxOpenVR builds it in setup(), the grid and the cache are set with:
+		ofxOpenVRDistortionMeshSettings settings;
+		settings.tolerance = 0.00025f;
+		settings.vertexBudget = 4096;
+		settings.cacheDirectory = "lens";	//"" disables the cache
+		openVR.setDistortionMesh(settings);
+*/
+
+//--------------------------------------------------------------
+struct ofxOpenVRDistortionMeshSettings {
+	bool adaptive = true;		//refine where the lens distorts most, otherwise a uniform grid
+	float tolerance = 0.0005f;	//adaptive: largest UV error, 0.0005 is a texel of a 2000 pixels wide eye target
+	int vertexBudget = 1849;	//adaptive: vertices per eye at most, 81..32768 (as many as the 43x43 grid by default)
+	int gridSize = 43;		//uniform: vertices along each side of an eye's grid, 2..181 (16-bit indices of both eyes)
+	int threads = 0;		//threads computing the mesh on cold starts, 0 - one per core
+	std::string cacheDirectory = "ofxOpenVR/distortion";	//relative to the data folder, "" disables the cache
+};
+
+//--------------------------------------------------------------
+struct ofxOpenVRLensVertex {
+	glm::vec2 position;
+	glm::vec2 texCoordRed;
+	glm::vec2 texCoordGreen;
+	glm::vec2 texCoordBlue;
+};
+
+//--------------------------------------------------------------
+class ofxOpenVRDistortionMesh {
+public:
+	static const int kMaxGridSize = 181;
+	static const int kMinVertexBudget = 81;		//the initial 8x8 cells
+	static const int kMaxVertexBudget = 32768;
+
+	//Loads the mesh from the cache or computes it (and writes the cache)
+	bool build(ofxOpenVRBackend *pVR, const std::string &sHmdSerial, const std::string &sRuntimeVersion, const ofxOpenVRDistortionMeshSettings &settings);
+	void clear();
+
+	const std::vector<ofxOpenVRLensVertex> &getVertices() const { return _vertices; }
+	const std::vector<GLushort> &getIndices() const { return _indices; }
+	uint32_t getFirstIndex(vr::Hmd_Eye eye) const { return (eye == vr::Eye_Left) ? 0 : _unLeftIndexCount; }
+	uint32_t getIndexCount(vr::Hmd_Eye eye) const { return (eye == vr::Eye_Left) ? _unLeftIndexCount : uint32_t(_indices.size()) - _unLeftIndexCount; }
+	bool isFromCache() const { return _bFromCache; }
+
+protected:
+	std::vector<ofxOpenVRLensVertex> _vertices;
+	std::vector<GLushort> _indices;
+	uint32_t _unLeftIndexCount = 0;
+	bool _bFromCache = false;
+
+	void computeUniform(ofxOpenVRBackend *pVR, int nGridSize, int nThreads);
+	void computeAdaptive(ofxOpenVRBackend *pVR, vr::Hmd_Eye eye, float fTolerance, int nVertexBudget, int nThreads);
+	bool load(const std::string &sPath, const std::string &sHmdSerial, const std::string &sRuntimeVersion, const ofxOpenVRDistortionMeshSettings &settings);
+	void save(const std::string &sPath, const std::string &sHmdSerial, const std::string &sRuntimeVersion, const ofxOpenVRDistortionMeshSettings &settings) const;
+	static std::string getPath(const std::string &sDirectory, const std::string &sHmdSerial);
+};
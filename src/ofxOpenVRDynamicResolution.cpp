@@ -0,0 +1,47 @@
+#include "ofxOpenVRDynamicResolution.h"
+
+//--------------------------------------------------------------
+ofxOpenVRDynamicResolution::ofxOpenVRDynamicResolution() {
+	_fScale = 1.0f;
+	_fSmoothedMs = 0;
+	_bHasSample = false;
+	_iFramesSinceChange = 0;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRDynamicResolution::setup(const ofxOpenVRDynamicResolutionSettings &settings) {
+	_settings = settings;
+	_settings.minScale = max(_settings.minScale, 0.1f);
+	_settings.maxScale = max(_settings.maxScale, _settings.minScale);
+	_settings.scaleStep = max(_settings.scaleStep, 0.01f);
+
+	_fScale = _settings.enabled ? ofClamp(_fScale, _settings.minScale, _settings.maxScale) : 1.0f;
+	_bHasSample = false;
+	_iFramesSinceChange = 0;
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRDynamicResolution::update(float gpuMs) {
+	if (!_settings.enabled) return false;
+
+	// Exponential smoothing removes single-frame spikes
+	_fSmoothedMs = _bHasSample ? ofLerp(_fSmoothedMs, gpuMs, 0.2f) : gpuMs;
+	_bHasSample = true;
+
+	_iFramesSinceChange++;
+	if (_iFramesSinceChange < _settings.settleFrames) return false;
+
+	float scale = _fScale;
+	if (_fSmoothedMs > _settings.targetFrameTimeMs) {
+		scale = max(_fScale - _settings.scaleStep, _settings.minScale);
+	}
+	else if (_fSmoothedMs < _settings.targetFrameTimeMs * (1 - _settings.hysteresis)) {
+		scale = min(_fScale + _settings.scaleStep, _settings.maxScale);
+	}
+
+	if (scale == _fScale) return false;
+
+	_fScale = scale;
+	_iFramesSinceChange = 0;
+	return true;
+}
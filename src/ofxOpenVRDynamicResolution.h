@@ -0,0 +1,53 @@
+#pragma once
+
+#include "ofMain.h"
+
+/*
+	Dynamic resolution controller for eye render targets.
+
+	Eye FBOs are allocated at (recommended size * maxScale), and each frame only the
+	(recommended size * scale) part is rendered and submitted (see VRTextureBounds_t).
+	The scale is changed by steps, depending on GPU time of renderStereoTargets():
+	it goes down when GPU time exceeds the budget and goes up when GPU time is below
+	(1 - hysteresis) * budget, so heavy scenes drop resolution instead of dropping frames into reprojection.
+
+	Usage:
+		ofxOpenVRDynamicResolutionSettings settings;
+		settings.enabled = true;
+		settings.targetFrameTimeMs = 11.1f;	//90 Hz
+		settings.maxScale = 1.2f;
+		openVR.setDynamicResolution(settings);
+*/
+
+//--------------------------------------------------------------
+struct ofxOpenVRDynamicResolutionSettings {
+	bool enabled = false;
+	float targetFrameTimeMs = 11.1f;	//GPU budget for rendering both eyes
+	float minScale = 0.6f;				//relative to recommended render target size
+	float maxScale = 1.0f;				//values > 1 enlarge eye FBOs
+	float scaleStep = 0.05f;
+	float hysteresis = 0.15f;			//fraction of the budget between scaling down and scaling up
+	int settleFrames = 8;				//frames to wait after a change, GPU timings arrive with a delay
+};
+
+//--------------------------------------------------------------
+class ofxOpenVRDynamicResolution {
+public:
+	ofxOpenVRDynamicResolution();
+
+	void setup(const ofxOpenVRDynamicResolutionSettings &settings);
+	const ofxOpenVRDynamicResolutionSettings &getSettings() { return _settings; }
+
+	//Call once per frame with the latest GPU time, returns true if the scale was changed
+	bool update(float gpuMs);
+
+	float getScale() { return _fScale; }
+	float getSmoothedGpuMs() { return _fSmoothedMs; }
+
+protected:
+	ofxOpenVRDynamicResolutionSettings _settings;
+	float _fScale;
+	float _fSmoothedMs;
+	bool _bHasSample;
+	int _iFramesSinceChange;
+};
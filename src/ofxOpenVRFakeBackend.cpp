@@ -0,0 +1,581 @@
+#include "ofxOpenVRFakeBackend.h"
+
+namespace {
+	const vr::TextureID_t kFakeTextureId = 1;
+	const float kFakeIpd = 0.064f;
+	const char *kFakeCameraError = "VRTrackedCameraError_None";
+
+	//--------------------------------------------------------------
+	void setIdentity(vr::HmdMatrix34_t &m) {
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 4; j++) {
+				m.m[i][j] = (i == j) ? 1.0f : 0.0f;
+			}
+		}
+	}
+
+	//--------------------------------------------------------------
+	//Rotation around Y axis and translation
+	void setYawTranslation(vr::HmdMatrix34_t &m, float yaw, glm::vec3 pos) {
+		setIdentity(m);
+		float c = cos(yaw);
+		float s = sin(yaw);
+		m.m[0][0] = c;	m.m[0][2] = s;
+		m.m[2][0] = -s;	m.m[2][2] = c;
+		m.m[0][3] = pos.x;
+		m.m[1][3] = pos.y;
+		m.m[2][3] = pos.z;
+	}
+}
+
+//--------------------------------------------------------------
+ofxOpenVRFakeBackend::ofxOpenVRFakeBackend(const ofxOpenVRFakeBackendSettings &settings) {
+	_settings = settings;
+	_settings.refreshRate = std::max(_settings.refreshRate, 1.0f);
+	_settings.cameraRate = std::max(_settings.cameraRate, 1.0f);
+	_settings.controllerCount = ofClamp(_settings.controllerCount, 0, 16);
+	_settings.trackerCount = ofClamp(_settings.trackerCount, 0, 16);
+
+	_bInit = false;
+	_bMirrorWindowVisible = false;
+	_bCameraStreaming = false;
+	_nFrame = 0;
+	_nSubmitCount = 0;
+	_nStartTimeMicros = 0;
+
+	//Device layout
+	for (vr::TrackedDeviceIndex_t i = 0; i < vr::k_unMaxTrackedDeviceCount; i++) {
+		_deviceClass[i] = vr::TrackedDeviceClass_Invalid;
+	}
+	_unDeviceCount = 0;
+	_deviceClass[_unDeviceCount++] = vr::TrackedDeviceClass_HMD;
+	for (int i = 0; i < _settings.controllerCount; i++) {
+		_deviceClass[_unDeviceCount++] = vr::TrackedDeviceClass_Controller;
+	}
+	for (int i = 0; i < _settings.trackerCount; i++) {
+		_deviceClass[_unDeviceCount++] = vr::TrackedDeviceClass_GenericTracker;
+	}
+	for (int i = 0; i < 2; i++) {
+		_deviceClass[_unDeviceCount++] = vr::TrackedDeviceClass_TrackingReference;
+	}
+	memset(_poses, 0, sizeof(_poses));
+	memset(_ulButtonPressed, 0, sizeof(_ulButtonPressed));
+
+	createGeometry();
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRFakeBackend::createGeometry() {
+	//Hidden area: a triangle in each corner of the eye, in UV coordinates
+	const float c = 0.22f;
+	const float corners[4][2] = { { 0, 0 },{ 1, 0 },{ 1, 1 },{ 0, 1 } };
+	for (int nEye = 0; nEye < 2; nEye++) {
+		_hiddenAreaVertices[nEye].clear();
+		for (int i = 0; i < 4; i++) {
+			float x = corners[i][0];
+			float y = corners[i][1];
+			float dx = (x == 0) ? c : -c;
+			float dy = (y == 0) ? c : -c;
+			_hiddenAreaVertices[nEye].push_back({ { x, y } });
+			_hiddenAreaVertices[nEye].push_back({ { x + dx, y } });
+			_hiddenAreaVertices[nEye].push_back({ { x, y + dy } });
+		}
+	}
+
+	//Render model: box 6x4x14 cm, each face has own vertices for flat normals
+	const float size[3] = { 0.03f, 0.02f, 0.07f };
+	_modelVertices.clear();
+	_modelIndices.clear();
+	for (int axis = 0; axis < 3; axis++) {
+		for (int sign = -1; sign <= 1; sign += 2) {
+			int u = (axis + 1) % 3;
+			int v = (axis + 2) % 3;
+			uint16_t base = _modelVertices.size();
+			for (int k = 0; k < 4; k++) {
+				float su = (k == 1 || k == 2) ? 1.0f : -1.0f;
+				float sv = (k >= 2) ? 1.0f : -1.0f;
+				vr::RenderModel_Vertex_t vert;
+				memset(&vert, 0, sizeof(vert));
+				vert.vPosition.v[axis] = sign * size[axis];
+				vert.vPosition.v[u] = su * size[u];
+				vert.vPosition.v[v] = sv * size[v];
+				vert.vNormal.v[axis] = float(sign);
+				vert.rfTextureCoord[0] = su * 0.5f + 0.5f;
+				vert.rfTextureCoord[1] = sv * 0.5f + 0.5f;
+				_modelVertices.push_back(vert);
+			}
+			//Keep counter-clockwise winding looking from outside
+			if (sign > 0) {
+				_modelIndices.insert(_modelIndices.end(), { base, uint16_t(base + 1), uint16_t(base + 2), base, uint16_t(base + 2), uint16_t(base + 3) });
+			}
+			else {
+				_modelIndices.insert(_modelIndices.end(), { base, uint16_t(base + 2), uint16_t(base + 1), base, uint16_t(base + 3), uint16_t(base + 2) });
+			}
+		}
+	}
+
+	//2x2 RGBA texture
+	_modelTexture = {
+		200, 200, 200, 255,		80, 80, 80, 255,
+		80, 80, 80, 255,		200, 200, 200, 255
+	};
+
+	//Camera frame: RGBA gradient with a grid
+	_cameraFrame.resize(_settings.cameraWidth * _settings.cameraHeight * 4);
+	for (uint32_t y = 0; y < _settings.cameraHeight; y++) {
+		for (uint32_t x = 0; x < _settings.cameraWidth; x++) {
+			uint8_t *p = &_cameraFrame[(y * _settings.cameraWidth + x) * 4];
+			bool grid = (x % 32 == 0) || (y % 32 == 0);
+			p[0] = grid ? 255 : uint8_t(x * 255 / std::max(_settings.cameraWidth, 1u));
+			p[1] = grid ? 255 : uint8_t(y * 255 / std::max(_settings.cameraHeight, 1u));
+			p[2] = grid ? 255 : 96;
+			p[3] = 255;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRFakeBackend::setPoseFunction(std::function<void(vr::TrackedDeviceIndex_t unDevice, double dTime, vr::TrackedDevicePose_t &pose)> function) {
+	_poseFunction = function;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRFakeBackend::addEvent(uint64_t nFrame, const vr::VREvent_t &event) {
+	ScriptedEvent e;
+	e.nFrame = nFrame;
+	e.event = event;
+	auto it = std::upper_bound(_events.begin(), _events.end(), e, [](const ScriptedEvent &a, const ScriptedEvent &b) {
+		return a.nFrame < b.nFrame;
+	});
+	_events.insert(it, e);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRFakeBackend::addButtonEvent(uint64_t nFrame, vr::TrackedDeviceIndex_t unDevice, vr::EVREventType eType, vr::EVRButtonId eButton) {
+	vr::VREvent_t event;
+	memset(&event, 0, sizeof(event));
+	event.eventType = eType;
+	event.trackedDeviceIndex = unDevice;
+	event.data.controller.button = eButton;
+	addEvent(nFrame, event);
+}
+
+//--------------------------------------------------------------
+double ofxOpenVRFakeBackend::getTime() const {
+	return double(_nFrame) / _settings.refreshRate;
+}
+
+//--------------------------------------------------------------
+vr::EVRInitError ofxOpenVRFakeBackend::Init() {
+	_bInit = true;
+	_nFrame = 0;
+	_nSubmitCount = 0;
+	_nStartTimeMicros = ofGetElapsedTimeMicros();
+	return vr::VRInitError_None;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRFakeBackend::Shutdown() {
+	_bInit = false;
+	_bCameraStreaming = false;
+}
+
+//--------------------------------------------------------------
+const char *ofxOpenVRFakeBackend::GetInitErrorDescription(vr::EVRInitError eError) {
+	return (eError == vr::VRInitError_None) ? "No Error (fake runtime)" : "Fake runtime error";
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRFakeBackend::GetRecommendedRenderTargetSize(uint32_t *pnWidth, uint32_t *pnHeight) {
+	*pnWidth = _settings.renderWidth;
+	*pnHeight = _settings.renderHeight;
+}
+
+//--------------------------------------------------------------
+// Purpose: Same layout as IVRSystem::GetProjectionMatrix builds from the raw tangents
+//--------------------------------------------------------------
+vr::HmdMatrix44_t ofxOpenVRFakeBackend::GetProjectionMatrix(vr::EVREye eEye, float fNearZ, float fFarZ) {
+	float left = -1.2f, right = 1.2f, top = -1.25f, bottom = 1.25f;
+
+	float idx = 1.0f / (right - left);
+	float idy = 1.0f / (bottom - top);
+	float idz = 1.0f / (fFarZ - fNearZ);
+	float sx = right + left;
+	float sy = bottom + top;
+
+	vr::HmdMatrix44_t m;
+	memset(&m, 0, sizeof(m));
+	m.m[0][0] = 2 * idx;	m.m[0][2] = sx * idx;
+	m.m[1][1] = 2 * idy;	m.m[1][2] = sy * idy;
+	m.m[2][2] = -fFarZ * idz;	m.m[2][3] = -fFarZ * fNearZ * idz;
+	m.m[3][2] = -1.0f;
+	return m;
+}
+
+//--------------------------------------------------------------
+vr::HmdMatrix34_t ofxOpenVRFakeBackend::GetEyeToHeadTransform(vr::EVREye eEye) {
+	vr::HmdMatrix34_t m;
+	setIdentity(m);
+	m.m[0][3] = (eEye == vr::Eye_Left) ? -kFakeIpd / 2 : kFakeIpd / 2;
+	return m;
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRFakeBackend::ComputeDistortion(vr::EVREye eEye, float fU, float fV, vr::DistortionCoordinates_t *pDistortionCoordinates) {
+	pDistortionCoordinates->rfRed[0] = pDistortionCoordinates->rfGreen[0] = pDistortionCoordinates->rfBlue[0] = fU;
+	pDistortionCoordinates->rfRed[1] = pDistortionCoordinates->rfGreen[1] = pDistortionCoordinates->rfBlue[1] = fV;
+	return true;
+}
+
+//--------------------------------------------------------------
+vr::HiddenAreaMesh_t ofxOpenVRFakeBackend::GetHiddenAreaMesh(vr::EVREye eEye, vr::EHiddenAreaMeshType type) {
+	vr::HiddenAreaMesh_t mesh;
+	mesh.pVertexData = nullptr;
+	mesh.unTriangleCount = 0;
+	if (type == vr::k_eHiddenAreaMesh_Standard) {
+		auto &vertices = _hiddenAreaVertices[(eEye == vr::Eye_Left) ? 0 : 1];
+		mesh.pVertexData = vertices.data();
+		mesh.unTriangleCount = vertices.size() / 3;
+	}
+	return mesh;
+}
+
+//--------------------------------------------------------------
+vr::ETrackedDeviceClass ofxOpenVRFakeBackend::GetTrackedDeviceClass(vr::TrackedDeviceIndex_t unDeviceIndex) {
+	if (unDeviceIndex >= vr::k_unMaxTrackedDeviceCount) return vr::TrackedDeviceClass_Invalid;
+	return _deviceClass[unDeviceIndex];
+}
+
+//--------------------------------------------------------------
+vr::ETrackedControllerRole ofxOpenVRFakeBackend::GetControllerRoleForTrackedDeviceIndex(vr::TrackedDeviceIndex_t unDeviceIndex) {
+	if (GetTrackedDeviceClass(unDeviceIndex) != vr::TrackedDeviceClass_Controller) return vr::TrackedControllerRole_Invalid;
+	if (unDeviceIndex == 1) return vr::TrackedControllerRole_LeftHand;
+	if (unDeviceIndex == 2) return vr::TrackedControllerRole_RightHand;
+	return vr::TrackedControllerRole_Invalid;
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRFakeBackend::IsTrackedDeviceConnected(vr::TrackedDeviceIndex_t unDeviceIndex) {
+	return _bInit && GetTrackedDeviceClass(unDeviceIndex) != vr::TrackedDeviceClass_Invalid;
+}
+
+//--------------------------------------------------------------
+uint32_t ofxOpenVRFakeBackend::GetStringTrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, char *pchValue, uint32_t unBufferSize, vr::ETrackedPropertyError *pError) {
+	vr::ETrackedDeviceClass deviceClass = GetTrackedDeviceClass(unDeviceIndex);
+	if (deviceClass == vr::TrackedDeviceClass_Invalid) {
+		if (pError) *pError = vr::TrackedProp_InvalidDevice;
+		return 0;
+	}
+
+	char value[64];
+	switch (prop) {
+	case vr::Prop_TrackingSystemName_String:
+		snprintf(value, sizeof(value), "fake");
+		break;
+	case vr::Prop_ModelNumber_String:
+		snprintf(value, sizeof(value), "Fake %s", (deviceClass == vr::TrackedDeviceClass_HMD) ? "HMD" : (deviceClass == vr::TrackedDeviceClass_Controller) ? "Controller" : (deviceClass == vr::TrackedDeviceClass_GenericTracker) ? "Tracker" : "Base Station");
+		break;
+	case vr::Prop_SerialNumber_String:
+		snprintf(value, sizeof(value), "FAKE-%02u", unDeviceIndex);
+		break;
+	case vr::Prop_RenderModelName_String:
+		snprintf(value, sizeof(value), "fake_box_%u", unDeviceIndex);
+		break;
+	default:
+		if (pError) *pError = vr::TrackedProp_UnknownProperty;
+		return 0;
+	}
+
+	uint32_t unRequiredBufferLen = strlen(value) + 1;
+	if (unBufferSize < unRequiredBufferLen) {
+		if (pError) *pError = vr::TrackedProp_BufferTooSmall;
+		return unRequiredBufferLen;
+	}
+	memcpy(pchValue, value, unRequiredBufferLen);
+	if (pError) *pError = vr::TrackedProp_Success;
+	return unRequiredBufferLen;
+}
+
+//--------------------------------------------------------------
+// Purpose: The camera sits at the left eye, matching GetCameraProjection()
+//--------------------------------------------------------------
+vr::HmdMatrix34_t ofxOpenVRFakeBackend::GetMatrix34TrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError *pError) {
+	vr::HmdMatrix34_t m;
+	setIdentity(m);
+	if (GetTrackedDeviceClass(unDeviceIndex) == vr::TrackedDeviceClass_Invalid) {
+		if (pError) *pError = vr::TrackedProp_InvalidDevice;
+		return m;
+	}
+	if (prop != vr::Prop_CameraToHeadTransform_Matrix34 || unDeviceIndex != vr::k_unTrackedDeviceIndex_Hmd || !_settings.hasCamera) {
+		if (pError) *pError = vr::TrackedProp_UnknownProperty;
+		return m;
+	}
+	if (pError) *pError = vr::TrackedProp_Success;
+	return GetEyeToHeadTransform(vr::Eye_Left);
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRFakeBackend::GetControllerState(vr::TrackedDeviceIndex_t unControllerDeviceIndex, vr::VRControllerState_t *pControllerState, uint32_t unControllerStateSize) {
+	if (!IsTrackedDeviceConnected(unControllerDeviceIndex) || unControllerStateSize < sizeof(vr::VRControllerState_t)) return false;
+
+	memset(pControllerState, 0, sizeof(vr::VRControllerState_t));
+	pControllerState->unPacketNum = uint32_t(_nFrame);
+	pControllerState->ulButtonPressed = _ulButtonPressed[unControllerDeviceIndex];
+	pControllerState->ulButtonTouched = _ulButtonPressed[unControllerDeviceIndex];
+
+	//Touchpad slowly circles, trigger follows the pressed state
+	double t = getTime();
+	pControllerState->rAxis[0].x = 0.5f * cos(t);
+	pControllerState->rAxis[0].y = 0.5f * sin(t);
+	pControllerState->rAxis[1].x = (_ulButtonPressed[unControllerDeviceIndex] & vr::ButtonMaskFromId(vr::k_EButton_SteamVR_Trigger)) ? 1.0f : 0.0f;
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRFakeBackend::PollNextEvent(vr::VREvent_t *pEvent, uint32_t uncbVREvent) {
+	if (_events.empty() || _events.front().nFrame > _nFrame) return false;
+
+	*pEvent = _events.front().event;
+	pEvent->eventAgeSeconds = float(_nFrame - _events.front().nFrame) / _settings.refreshRate;
+	_events.pop_front();
+
+	//Keep controller state consistent with delivered button events
+	if (pEvent->trackedDeviceIndex < vr::k_unMaxTrackedDeviceCount) {
+		uint64_t &ulPressed = _ulButtonPressed[pEvent->trackedDeviceIndex];
+		if (pEvent->eventType == vr::VREvent_ButtonPress) {
+			ulPressed |= vr::ButtonMaskFromId(vr::EVRButtonId(pEvent->data.controller.button));
+		}
+		if (pEvent->eventType == vr::VREvent_ButtonUnpress) {
+			ulPressed &= ~vr::ButtonMaskFromId(vr::EVRButtonId(pEvent->data.controller.button));
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRFakeBackend::HasCompositor() {
+	return _bInit;
+}
+
+//--------------------------------------------------------------
+// Purpose: Default synthetic motion: HMD looks around, controllers sway in front of it
+//--------------------------------------------------------------
+void ofxOpenVRFakeBackend::computePose(vr::TrackedDeviceIndex_t unDevice, double dTime, vr::TrackedDevicePose_t &pose) {
+	float t = float(dTime);
+	switch (_deviceClass[unDevice]) {
+	case vr::TrackedDeviceClass_HMD:
+		setYawTranslation(pose.mDeviceToAbsoluteTracking, 0.3f * sin(t * 0.5f), glm::vec3(0.05f * sin(t), 1.6f, 0));
+		break;
+	case vr::TrackedDeviceClass_Controller: {
+		float side = (unDevice % 2) ? -1.0f : 1.0f;
+		setYawTranslation(pose.mDeviceToAbsoluteTracking, 0.2f * sin(t + side), glm::vec3(side * 0.25f + 0.05f * sin(t * 2), 1.1f + 0.05f * cos(t * 2), -0.35f - 0.1f * ((unDevice - 1) / 2)));
+		break;
+	}
+	case vr::TrackedDeviceClass_GenericTracker:
+		setYawTranslation(pose.mDeviceToAbsoluteTracking, t, glm::vec3(0.5f * cos(t * 0.25f + unDevice), 0.9f, 0.5f * sin(t * 0.25f + unDevice)));
+		break;
+	default:
+		//Base stations are static in the room corners
+		setYawTranslation(pose.mDeviceToAbsoluteTracking, (unDevice % 2) ? 2.356f : -0.785f, glm::vec3((unDevice % 2) ? 2.0f : -2.0f, 2.2f, (unDevice % 2) ? 2.0f : -2.0f));
+		break;
+	}
+}
+
+//--------------------------------------------------------------
+vr::EVRCompositorError ofxOpenVRFakeBackend::WaitGetPoses(vr::TrackedDevicePose_t *pRenderPoseArray, uint32_t unRenderPoseArrayCount, vr::TrackedDevicePose_t *pGamePoseArray, uint32_t unGamePoseArrayCount) {
+	_nFrame++;
+
+	//Sleep till the simulated vsync
+	if (_settings.throttle) {
+		uint64_t nVsyncMicros = _nStartTimeMicros + uint64_t(_nFrame * 1000000.0 / _settings.refreshRate);
+		uint64_t nNowMicros = ofGetElapsedTimeMicros();
+		if (nVsyncMicros > nNowMicros) {
+			std::this_thread::sleep_for(std::chrono::microseconds(nVsyncMicros - nNowMicros));
+		}
+	}
+
+	double t = getTime();
+	double dt = 1.0 / _settings.refreshRate;
+	for (vr::TrackedDeviceIndex_t i = 0; i < _unDeviceCount; i++) {
+		vr::TrackedDevicePose_t &pose = _poses[i];
+		vr::HmdMatrix34_t prev = pose.mDeviceToAbsoluteTracking;
+
+		pose.bDeviceIsConnected = true;
+		pose.bPoseIsValid = true;
+		pose.eTrackingResult = vr::TrackingResult_Running_OK;
+		if (_poseFunction) {
+			_poseFunction(i, t, pose);
+		}
+		else {
+			computePose(i, t, pose);
+		}
+
+		//Linear velocity from the previous frame, angular velocity is not simulated
+		for (int k = 0; k < 3; k++) {
+			pose.vVelocity.v[k] = (_nFrame > 1) ? float((pose.mDeviceToAbsoluteTracking.m[k][3] - prev.m[k][3]) / dt) : 0.0f;
+			pose.vAngularVelocity.v[k] = 0;
+		}
+	}
+
+	if (pRenderPoseArray) {
+		memcpy(pRenderPoseArray, _poses, std::min(unRenderPoseArrayCount, vr::k_unMaxTrackedDeviceCount) * sizeof(vr::TrackedDevicePose_t));
+	}
+	if (pGamePoseArray) {
+		memcpy(pGamePoseArray, _poses, std::min(unGamePoseArrayCount, vr::k_unMaxTrackedDeviceCount) * sizeof(vr::TrackedDevicePose_t));
+	}
+	return vr::VRCompositorError_None;
+}
+
+//--------------------------------------------------------------
+vr::EVRCompositorError ofxOpenVRFakeBackend::Submit(vr::EVREye eEye, const vr::Texture_t *pTexture, const vr::VRTextureBounds_t *pBounds, vr::EVRSubmitFlags nSubmitFlags) {
+	_nSubmitCount++;
+	return vr::VRCompositorError_None;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRFakeBackend::FadeGrid(float fSeconds, bool bFadeIn) {
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRFakeBackend::ShowMirrorWindow() {
+	_bMirrorWindowVisible = true;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRFakeBackend::HideMirrorWindow() {
+	_bMirrorWindowVisible = false;
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRFakeBackend::IsMirrorWindowVisible() {
+	return _bMirrorWindowVisible;
+}
+
+//--------------------------------------------------------------
+vr::EVRRenderModelError ofxOpenVRFakeBackend::LoadRenderModel_Async(const char *pchRenderModelName, vr::RenderModel_t **ppRenderModel) {
+	vr::RenderModel_t *pModel = new vr::RenderModel_t;
+	pModel->rVertexData = _modelVertices.data();
+	pModel->unVertexCount = _modelVertices.size();
+	pModel->rIndexData = _modelIndices.data();
+	pModel->unTriangleCount = _modelIndices.size() / 3;
+	pModel->diffuseTextureId = kFakeTextureId;
+	*ppRenderModel = pModel;
+	return vr::VRRenderModelError_None;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRFakeBackend::FreeRenderModel(vr::RenderModel_t *pRenderModel) {
+	delete pRenderModel;
+}
+
+//--------------------------------------------------------------
+vr::EVRRenderModelError ofxOpenVRFakeBackend::LoadTexture_Async(vr::TextureID_t textureId, vr::RenderModel_TextureMap_t **ppTexture) {
+	vr::RenderModel_TextureMap_t *pTexture = new vr::RenderModel_TextureMap_t;
+	pTexture->unWidth = 2;
+	pTexture->unHeight = 2;
+	pTexture->rubTextureMapData = _modelTexture.data();
+	*ppTexture = pTexture;
+	return vr::VRRenderModelError_None;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRFakeBackend::FreeTexture(vr::RenderModel_TextureMap_t *pTexture) {
+	delete pTexture;
+}
+
+//--------------------------------------------------------------
+const char *ofxOpenVRFakeBackend::GetRenderModelErrorNameFromEnum(vr::EVRRenderModelError error) {
+	return (error == vr::VRRenderModelError_None) ? "VRRenderModelError_None" : "VRRenderModelError_Unknown";
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRFakeBackend::HasTrackedCamera() {
+	return _bInit;
+}
+
+//--------------------------------------------------------------
+// Purpose: Camera frames follow the simulated time, which is advanced by WaitGetPoses on the render thread
+//--------------------------------------------------------------
+bool ofxOpenVRFakeBackend::IsCameraThreadSafe() {
+	return false;
+}
+
+//--------------------------------------------------------------
+const char *ofxOpenVRFakeBackend::GetCameraErrorNameFromEnum(vr::EVRTrackedCameraError eCameraError) {
+	return (eCameraError == vr::VRTrackedCameraError_None) ? kFakeCameraError : "VRTrackedCameraError_Unknown";
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRFakeBackend::HasCamera(vr::TrackedDeviceIndex_t nDeviceIndex, bool *pHasCamera) {
+	*pHasCamera = _settings.hasCamera && nDeviceIndex == vr::k_unTrackedDeviceIndex_Hmd;
+	return vr::VRTrackedCameraError_None;
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRFakeBackend::GetCameraFrameSize(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, uint32_t *pnWidth, uint32_t *pnHeight, uint32_t *pnFrameBufferSize) {
+	if (!_settings.hasCamera) return vr::VRTrackedCameraError_NoFrameAvailable;
+	*pnWidth = _settings.cameraWidth;
+	*pnHeight = _settings.cameraHeight;
+	*pnFrameBufferSize = _cameraFrame.size();
+	return vr::VRTrackedCameraError_None;
+}
+
+//--------------------------------------------------------------
+// Purpose: The test pattern is seen as by the left eye
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRFakeBackend::GetCameraProjection(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, float flZNear, float flZFar, vr::HmdMatrix44_t *pProjection) {
+	if (!_settings.hasCamera) return vr::VRTrackedCameraError_NoFrameAvailable;
+	*pProjection = GetProjectionMatrix(vr::Eye_Left, flZNear, flZFar);
+	return vr::VRTrackedCameraError_None;
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRFakeBackend::AcquireVideoStreamingService(vr::TrackedDeviceIndex_t nDeviceIndex, vr::TrackedCameraHandle_t *pHandle) {
+	if (!_settings.hasCamera) return vr::VRTrackedCameraError_NoFrameAvailable;
+	_bCameraStreaming = true;
+	*pHandle = 1;
+	return vr::VRTrackedCameraError_None;
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRFakeBackend::ReleaseVideoStreamingService(vr::TrackedCameraHandle_t hTrackedCamera) {
+	_bCameraStreaming = false;
+	return vr::VRTrackedCameraError_None;
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRFakeBackend::GetVideoStreamFrameBuffer(vr::TrackedCameraHandle_t hTrackedCamera, vr::EVRTrackedCameraFrameType eFrameType, void *pFrameBuffer, uint32_t nFrameBufferSize, vr::CameraVideoStreamFrameHeader_t *pFrameHeader, uint32_t nFrameHeaderSize) {
+	if (!_bCameraStreaming) return vr::VRTrackedCameraError_NoFrameAvailable;
+
+	if (pFrameHeader && nFrameHeaderSize >= sizeof(vr::CameraVideoStreamFrameHeader_t)) {
+		pFrameHeader->eFrameType = eFrameType;
+		pFrameHeader->nWidth = _settings.cameraWidth;
+		pFrameHeader->nHeight = _settings.cameraHeight;
+		pFrameHeader->nBytesPerPixel = 4;
+		pFrameHeader->nFrameSequence = uint32_t(getTime() * _settings.cameraRate);
+		pFrameHeader->standingTrackedDevicePose = _poses[vr::k_unTrackedDeviceIndex_Hmd];
+	}
+	//Header-only request is used to check the sequence number
+	if (pFrameBuffer) {
+		if (nFrameBufferSize < _cameraFrame.size()) return vr::VRTrackedCameraError_NoFrameAvailable;
+		memcpy(pFrameBuffer, _cameraFrame.data(), _cameraFrame.size());
+	}
+	return vr::VRTrackedCameraError_None;
+}
+
+//--------------------------------------------------------------
+// Purpose: Frames are generated on CPU, so there is no shared texture: users fall back to GetVideoStreamFrameBuffer
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRFakeBackend::GetVideoStreamTextureSize(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, vr::VRTextureBounds_t *pTextureBounds, uint32_t *pnWidth, uint32_t *pnHeight) {
+	return vr::VRTrackedCameraError_NotSupportedForThisDevice;
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRFakeBackend::GetVideoStreamTextureGL(vr::TrackedCameraHandle_t hTrackedCamera, vr::EVRTrackedCameraFrameType eFrameType, vr::glUInt_t *pglTextureId, vr::CameraVideoStreamFrameHeader_t *pFrameHeader, uint32_t nFrameHeaderSize) {
+	return vr::VRTrackedCameraError_NotSupportedForThisDevice;
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRFakeBackend::ReleaseVideoStreamTextureGL(vr::TrackedCameraHandle_t hTrackedCamera, vr::glUInt_t glTextureId) {
+	return vr::VRTrackedCameraError_NotSupportedForThisDevice;
+}
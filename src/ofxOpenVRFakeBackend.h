@@ -0,0 +1,133 @@
+#pragma once
+
+#include "ofxOpenVRBackend.h"
+
+/*
+	In-process fake OpenVR runtime: no SteamVR and no headset needed.
+	It is used for headless benchmarking and for developing without hardware.
+
+	- HMD has index 0, then controllers (1 - left hand, 2 - right hand), then trackers, then 2 base stations
+	- time is simulated: frame N has time N / refreshRate, so poses and events are deterministic
+	- WaitGetPoses sleeps till the next simulated vsync only if 'throttle' is enabled
+	- controllers and HMD move slowly by default; use setPoseFunction to supply own poses
+	- events can be scripted with addEvent / addButtonEvent and are delivered at the given frame
+	- render models are a textured box, distortion is identity, camera returns a test pattern
+
+	Usage:
+		ofxOpenVRFakeBackendSettings settings;
+		settings.throttle = false;
+		auto fake = std::make_shared<ofxOpenVRFakeBackend>(settings);
+		fake->addButtonEvent(90, 1, vr::VREvent_ButtonPress, vr::k_EButton_SteamVR_Trigger);
+		openVR.setup(std::bind(&ofApp::render, this, std::placeholders::_1), fake);
+*/
+
+//--------------------------------------------------------------
+struct ofxOpenVRFakeBackendSettings {
+	float refreshRate = 90;		//simulated display frequency, Hz
+	bool throttle = true;		//sleep in WaitGetPoses till the next vsync, false - run as fast as possible
+	int controllerCount = 2;	//0..16, first two get left and right hand roles
+	int trackerCount = 0;		//0..16
+	uint32_t renderWidth = 1512;	//recommended render target size per eye
+	uint32_t renderHeight = 1680;
+	bool hasCamera = true;
+	uint32_t cameraWidth = 612;		//camera frame size, the whole side-by-side frame
+	uint32_t cameraHeight = 460;
+	float cameraRate = 30;			//camera frames per second
+};
+
+//--------------------------------------------------------------
+class ofxOpenVRFakeBackend : public ofxOpenVRBackend {
+public:
+	ofxOpenVRFakeBackend(const ofxOpenVRFakeBackendSettings &settings = ofxOpenVRFakeBackendSettings());
+
+	const ofxOpenVRFakeBackendSettings &getSettings() const { return _settings; }
+
+	//Scripting
+	//Called for each connected device in WaitGetPoses, should fill 'pose' for given simulated time in seconds
+	void setPoseFunction(std::function<void(vr::TrackedDeviceIndex_t unDevice, double dTime, vr::TrackedDevicePose_t &pose)> function);
+	void addEvent(uint64_t nFrame, const vr::VREvent_t &event);
+	void addButtonEvent(uint64_t nFrame, vr::TrackedDeviceIndex_t unDevice, vr::EVREventType eType, vr::EVRButtonId eButton);
+
+	//Statistics
+	uint64_t getFrameNumber() const { return _nFrame; }
+	double getTime() const;
+	uint64_t getSubmitCount() const { return _nSubmitCount; }
+
+	vr::EVRInitError Init() override;
+	void Shutdown() override;
+	const char *GetInitErrorDescription(vr::EVRInitError eError) override;
+
+	void GetRecommendedRenderTargetSize(uint32_t *pnWidth, uint32_t *pnHeight) override;
+	vr::HmdMatrix44_t GetProjectionMatrix(vr::EVREye eEye, float fNearZ, float fFarZ) override;
+	vr::HmdMatrix34_t GetEyeToHeadTransform(vr::EVREye eEye) override;
+	bool ComputeDistortion(vr::EVREye eEye, float fU, float fV, vr::DistortionCoordinates_t *pDistortionCoordinates) override;
+	vr::HiddenAreaMesh_t GetHiddenAreaMesh(vr::EVREye eEye, vr::EHiddenAreaMeshType type = vr::k_eHiddenAreaMesh_Standard) override;
+
+	vr::ETrackedDeviceClass GetTrackedDeviceClass(vr::TrackedDeviceIndex_t unDeviceIndex) override;
+	vr::ETrackedControllerRole GetControllerRoleForTrackedDeviceIndex(vr::TrackedDeviceIndex_t unDeviceIndex) override;
+	bool IsTrackedDeviceConnected(vr::TrackedDeviceIndex_t unDeviceIndex) override;
+	uint32_t GetStringTrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, char *pchValue, uint32_t unBufferSize, vr::ETrackedPropertyError *pError = 0L) override;
+	vr::HmdMatrix34_t GetMatrix34TrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError *pError = 0L) override;
+	bool GetControllerState(vr::TrackedDeviceIndex_t unControllerDeviceIndex, vr::VRControllerState_t *pControllerState, uint32_t unControllerStateSize) override;
+	bool PollNextEvent(vr::VREvent_t *pEvent, uint32_t uncbVREvent) override;
+
+	bool HasCompositor() override;
+	vr::EVRCompositorError WaitGetPoses(vr::TrackedDevicePose_t *pRenderPoseArray, uint32_t unRenderPoseArrayCount, vr::TrackedDevicePose_t *pGamePoseArray, uint32_t unGamePoseArrayCount) override;
+	vr::EVRCompositorError Submit(vr::EVREye eEye, const vr::Texture_t *pTexture, const vr::VRTextureBounds_t *pBounds = 0, vr::EVRSubmitFlags nSubmitFlags = vr::Submit_Default) override;
+	void FadeGrid(float fSeconds, bool bFadeIn) override;
+	void ShowMirrorWindow() override;
+	void HideMirrorWindow() override;
+	bool IsMirrorWindowVisible() override;
+
+	vr::EVRRenderModelError LoadRenderModel_Async(const char *pchRenderModelName, vr::RenderModel_t **ppRenderModel) override;
+	void FreeRenderModel(vr::RenderModel_t *pRenderModel) override;
+	vr::EVRRenderModelError LoadTexture_Async(vr::TextureID_t textureId, vr::RenderModel_TextureMap_t **ppTexture) override;
+	void FreeTexture(vr::RenderModel_TextureMap_t *pTexture) override;
+	const char *GetRenderModelErrorNameFromEnum(vr::EVRRenderModelError error) override;
+
+	bool HasTrackedCamera() override;
+	bool IsCameraThreadSafe() override;
+	const char *GetCameraErrorNameFromEnum(vr::EVRTrackedCameraError eCameraError) override;
+	vr::EVRTrackedCameraError HasCamera(vr::TrackedDeviceIndex_t nDeviceIndex, bool *pHasCamera) override;
+	vr::EVRTrackedCameraError GetCameraFrameSize(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, uint32_t *pnWidth, uint32_t *pnHeight, uint32_t *pnFrameBufferSize) override;
+	vr::EVRTrackedCameraError GetCameraProjection(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, float flZNear, float flZFar, vr::HmdMatrix44_t *pProjection) override;
+	vr::EVRTrackedCameraError AcquireVideoStreamingService(vr::TrackedDeviceIndex_t nDeviceIndex, vr::TrackedCameraHandle_t *pHandle) override;
+	vr::EVRTrackedCameraError ReleaseVideoStreamingService(vr::TrackedCameraHandle_t hTrackedCamera) override;
+	vr::EVRTrackedCameraError GetVideoStreamFrameBuffer(vr::TrackedCameraHandle_t hTrackedCamera, vr::EVRTrackedCameraFrameType eFrameType, void *pFrameBuffer, uint32_t nFrameBufferSize, vr::CameraVideoStreamFrameHeader_t *pFrameHeader, uint32_t nFrameHeaderSize) override;
+	vr::EVRTrackedCameraError GetVideoStreamTextureSize(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, vr::VRTextureBounds_t *pTextureBounds, uint32_t *pnWidth, uint32_t *pnHeight) override;
+	vr::EVRTrackedCameraError GetVideoStreamTextureGL(vr::TrackedCameraHandle_t hTrackedCamera, vr::EVRTrackedCameraFrameType eFrameType, vr::glUInt_t *pglTextureId, vr::CameraVideoStreamFrameHeader_t *pFrameHeader, uint32_t nFrameHeaderSize) override;
+	vr::EVRTrackedCameraError ReleaseVideoStreamTextureGL(vr::TrackedCameraHandle_t hTrackedCamera, vr::glUInt_t glTextureId) override;
+
+protected:
+	ofxOpenVRFakeBackendSettings _settings;
+	bool _bInit;
+	bool _bMirrorWindowVisible;
+
+	uint64_t _nFrame;
+	uint64_t _nSubmitCount;
+	uint64_t _nStartTimeMicros;		//real time of frame 0, used for throttling
+
+	vr::TrackedDeviceIndex_t _unDeviceCount;
+	vr::ETrackedDeviceClass _deviceClass[vr::k_unMaxTrackedDeviceCount];
+	vr::TrackedDevicePose_t _poses[vr::k_unMaxTrackedDeviceCount];
+	std::function<void(vr::TrackedDeviceIndex_t, double, vr::TrackedDevicePose_t &)> _poseFunction;
+	void computePose(vr::TrackedDeviceIndex_t unDevice, double dTime, vr::TrackedDevicePose_t &pose);
+
+	struct ScriptedEvent {
+		uint64_t nFrame;
+		vr::VREvent_t event;
+	};
+	std::deque<ScriptedEvent> _events;		//sorted by frame
+	uint64_t _ulButtonPressed[vr::k_unMaxTrackedDeviceCount];
+
+	//Geometry
+	std::vector<vr::HmdVector2_t> _hiddenAreaVertices[2];
+	std::vector<vr::RenderModel_Vertex_t> _modelVertices;
+	std::vector<uint16_t> _modelIndices;
+	std::vector<uint8_t> _modelTexture;
+	void createGeometry();
+
+	//Camera
+	std::vector<uint8_t> _cameraFrame;
+	bool _bCameraStreaming;
+};
@@ -0,0 +1,189 @@
+#include "ofxOpenVRGpuMemory.h"
+#include <mutex>
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+namespace {
+	const char *kCategoryNames[ofxOpenVRGpuMemoryStats::kCategoryCount] = {
+		"eye buffers",
+		"camera",
+		"render models",
+		"lens",
+		"shaders",
+		"other"
+	};
+
+	struct Record {
+		ofxOpenVRGpuMemory::Object type;
+		GLuint id;
+		ofxOpenVRGpuCategory category;
+		size_t bytes;
+		const char *pchLabel;
+	};
+
+	// Objects are created and freed on the render thread, the lock only guards readers on other threads
+	struct Registry {
+		std::mutex mutex;
+		std::unordered_map<uint64_t, Record> records;
+	};
+
+	//--------------------------------------------------------------
+	Registry &getRegistry() {
+		static Registry registry;
+		return registry;
+	}
+
+	//--------------------------------------------------------------
+	uint64_t getKey(ofxOpenVRGpuMemory::Object type, GLuint id) {
+		return (uint64_t(type) << 32) | id;
+	}
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRGpuMemory::track(Object type, GLuint id, ofxOpenVRGpuCategory category, size_t bytes, const char *pchLabel) {
+	if (id == 0) return;
+	Registry &registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	Record &record = registry.records[getKey(type, id)];
+	record.type = type;
+	record.id = id;
+	record.category = category;
+	record.bytes = bytes;
+	record.pchLabel = pchLabel;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRGpuMemory::untrack(Object type, GLuint id) {
+	if (id == 0) return;
+	Registry &registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	registry.records.erase(getKey(type, id));
+}
+
+//--------------------------------------------------------------
+// Purpose: Color textures, a depth-stencil renderbuffer and, with MSAA,
+// multisampled color buffers besides the resolved textures
+//--------------------------------------------------------------
+void ofxOpenVRGpuMemory::trackFbo(const ofFbo &fbo, const ofFbo::Settings &settings, ofxOpenVRGpuCategory category, const char *pchLabel) {
+	uint32_t unWidth = uint32_t(std::max(settings.width, 0));
+	uint32_t unHeight = uint32_t(std::max(settings.height, 0));
+	size_t samples = size_t(std::max(settings.numSamples, 1));
+	size_t colorBytes = getImageSize(unWidth, unHeight, settings.internalformat) * std::max(settings.numColorbuffers, 1);
+	size_t bytes = colorBytes * ((samples > 1) ? samples + 1 : 1);
+	if (settings.useDepth || settings.useStencil) {
+		bytes += getImageSize(unWidth, unHeight, settings.depthStencilInternalFormat) * samples;
+	}
+	track(Object::Framebuffer, fbo.getId(), category, bytes, pchLabel);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRGpuMemory::untrackFbo(const ofFbo &fbo) {
+	untrack(Object::Framebuffer, fbo.getId());
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRGpuMemory::trackShader(const ofShader &shader, const char *pchLabel) {
+	GLint nBinaryLength = 0;
+	if (shader.getProgram()) {
+		glGetProgramiv(shader.getProgram(), GL_PROGRAM_BINARY_LENGTH, &nBinaryLength);
+	}
+	track(Object::Program, shader.getProgram(), ofxOpenVRGpuCategory::Shaders, size_t(std::max(nBinaryLength, 0)), pchLabel);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRGpuMemory::untrackShader(const ofShader &shader) {
+	untrack(Object::Program, shader.getProgram());
+}
+
+//--------------------------------------------------------------
+size_t ofxOpenVRGpuMemory::getImageSize(uint32_t unWidth, uint32_t unHeight, GLenum internalFormat, int nLevels) {
+	size_t size = 0;
+	for (int i = 0; nLevels <= 0 || i < nLevels; i++) {
+		switch (internalFormat) {
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+			size += size_t(std::max(1u, (unWidth + 3) / 4)) * std::max(1u, (unHeight + 3) / 4) * 8;
+			break;
+		case GL_R8:
+			size += size_t(unWidth) * unHeight;
+			break;
+		case GL_RG8:
+			size += size_t(unWidth) * unHeight * 2;
+			break;
+		case GL_RGBA16F:
+			size += size_t(unWidth) * unHeight * 8;
+			break;
+		case GL_RGBA32F:
+			size += size_t(unWidth) * unHeight * 16;
+			break;
+		default:	//RGB(A)8 (RGB is padded by drivers), DEPTH24_STENCIL8, DEPTH_COMPONENT24/32
+			size += size_t(unWidth) * unHeight * 4;
+			break;
+		}
+		if (unWidth <= 1 && unHeight <= 1) break;
+		unWidth = std::max(1u, unWidth / 2);
+		unHeight = std::max(1u, unHeight / 2);
+	}
+	return size;
+}
+
+//--------------------------------------------------------------
+ofxOpenVRGpuMemoryStats ofxOpenVRGpuMemory::getStats() {
+	ofxOpenVRGpuMemoryStats stats;
+	Registry &registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	for (const auto &it : registry.records) {
+		const Record &record = it.second;
+		stats.bytes[int(record.category)] += record.bytes;
+		stats.objects[int(record.category)]++;
+		stats.totalBytes += record.bytes;
+		stats.totalObjects++;
+	}
+	return stats;
+}
+
+//--------------------------------------------------------------
+std::string ofxOpenVRGpuMemory::getSummary() {
+	ofxOpenVRGpuMemoryStats stats = getStats();
+	const float kMB = 1.0f / (1024 * 1024);
+	std::ostringstream out;
+	out << "GPU Memory: " << ofToString(stats.totalBytes * kMB, 1) << " MB in " << stats.totalObjects << " objects" << endl;
+	for (int i = 0; i < ofxOpenVRGpuMemoryStats::kCategoryCount; i++) {
+		if (stats.objects[i] == 0) continue;
+		out << "  " << kCategoryNames[i] << ": " << ofToString(stats.bytes[i] * kMB, 1) << " MB (" << stats.objects[i] << ")" << endl;
+	}
+	return out.str();
+}
+
+//--------------------------------------------------------------
+int ofxOpenVRGpuMemory::reportLeaks() {
+	Registry &registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	for (const auto &it : registry.records) {
+		const Record &record = it.second;
+		ofLogWarning("ofxOpenVR") << "GL " << getObjectName(record.type) << " " << record.id << " (" << record.pchLabel << ", "
+			<< kCategoryNames[int(record.category)] << ", " << record.bytes << " bytes) was not freed";
+	}
+	return int(registry.records.size());
+}
+
+//--------------------------------------------------------------
+const char *ofxOpenVRGpuMemory::getCategoryName(ofxOpenVRGpuCategory category) {
+	int i = int(category);
+	return (i >= 0 && i < ofxOpenVRGpuMemoryStats::kCategoryCount) ? kCategoryNames[i] : "unknown";
+}
+
+//--------------------------------------------------------------
+const char *ofxOpenVRGpuMemory::getObjectName(Object type) {
+	switch (type) {
+	case Object::Buffer: return "buffer";
+	case Object::Texture: return "texture";
+	case Object::Renderbuffer: return "renderbuffer";
+	case Object::Framebuffer: return "framebuffer";
+	case Object::VertexArray: return "vertex array";
+	case Object::Program: return "program";
+	case Object::Query: return "query";
+	}
+	return "object";
+}
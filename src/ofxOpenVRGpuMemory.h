@@ -0,0 +1,75 @@
+#pragma once
+
+#include "ofMain.h"
+
+/*
+	Accounting of GPU memory held by the addon.
+
+	Every GL object the addon creates is tracked with its category and estimated size:
+	eye render targets, camera texture and pixel buffers, render model geometry, textures and matrices,
+	lens and hidden area meshes, linked shader programs and query objects.
+	Sizes are computed from dimensions and formats (drivers may pad or compress them),
+	shader programs are counted by the size of their binaries.
+	ofxOpenVR::exit() reports the objects still tracked after everything was freed as leaks.
+
+	Usage:
+		ofxOpenVRGpuMemoryStats stats = openVR.getGpuMemoryStats();
+		cout << stats.totalBytes / (1024 * 1024) << " MB, render models: "
+			<< stats.bytes[int(ofxOpenVRGpuCategory::RenderModels)] << " bytes" << endl;
+*/
+
+//--------------------------------------------------------------
+enum class ofxOpenVRGpuCategory
+{
+	EyeBuffers = 0,		//eye and double-wide stereo render targets
+	Camera = 1,			//camera texture and pixel buffers
+	RenderModels = 2,	//shared geometry, textures and device matrices of render models
+	Lens = 3,			//distortion and hidden area meshes
+	Shaders = 4,		//linked programs
+	Other = 5,			//queries and helper vertex arrays
+	Count = 6
+};
+
+//--------------------------------------------------------------
+struct ofxOpenVRGpuMemoryStats {
+	static const int kCategoryCount = int(ofxOpenVRGpuCategory::Count);
+	std::array<size_t, kCategoryCount> bytes = {};
+	std::array<int, kCategoryCount> objects = {};
+	size_t totalBytes = 0;
+	int totalObjects = 0;
+};
+
+//--------------------------------------------------------------
+class ofxOpenVRGpuMemory {
+public:
+	enum class Object {
+		Buffer,
+		Texture,
+		Renderbuffer,
+		Framebuffer,
+		VertexArray,
+		Program,
+		Query
+	};
+
+	//Adds the object or updates its size, bytes may be 0 for objects without storage
+	static void track(Object type, GLuint id, ofxOpenVRGpuCategory category, size_t bytes, const char *pchLabel);
+	static void untrack(Object type, GLuint id);
+
+	//Framebuffer with its attachments, tracked under the framebuffer's id; untrack before clear()
+	static void trackFbo(const ofFbo &fbo, const ofFbo::Settings &settings, ofxOpenVRGpuCategory category, const char *pchLabel);
+	static void untrackFbo(const ofFbo &fbo);
+	//Linked program, by the size of its binary; untrack before unload()
+	static void trackShader(const ofShader &shader, const char *pchLabel);
+	static void untrackShader(const ofShader &shader);
+
+	//Estimated size of an image, levels: 1 or 0 for a full mip chain
+	static size_t getImageSize(uint32_t unWidth, uint32_t unHeight, GLenum internalFormat, int nLevels = 1);
+
+	static ofxOpenVRGpuMemoryStats getStats();
+	static std::string getSummary();	//total and per category, in MB
+	static int reportLeaks();			//logs objects still tracked, returns their count
+
+	static const char *getCategoryName(ofxOpenVRGpuCategory category);
+	static const char *getObjectName(Object type);
+};
@@ -0,0 +1,114 @@
+#include "ofxOpenVRGpuTimer.h"
+#include "ofxOpenVRGpuMemory.h"
+
+//--------------------------------------------------------------
+ofxOpenVRGpuTimer::ofxOpenVRGpuTimer() {
+	memset(_queries, 0, sizeof(_queries));
+	memset(_tags, 0, sizeof(_tags));
+	memset(_bPending, 0, sizeof(_bPending));
+	_iCurrent = 0;
+	_bActive = false;
+	_bHasResult = false;
+	_fLastMs = 0;
+	_iReadyFirst = 0;
+	_iReadyCount = 0;
+}
+
+//--------------------------------------------------------------
+ofxOpenVRGpuTimer::~ofxOpenVRGpuTimer() {
+	exit();
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRGpuTimer::setup() {
+	if (_queries[0][0]) return;
+
+	glGenQueries(kQueryCount * 2, &_queries[0][0]);
+	for (int i = 0; i < kQueryCount; i++) {
+		ofxOpenVRGpuMemory::track(ofxOpenVRGpuMemory::Object::Query, _queries[i][0], ofxOpenVRGpuCategory::Other, 0, "gpu timer");
+		ofxOpenVRGpuMemory::track(ofxOpenVRGpuMemory::Object::Query, _queries[i][1], ofxOpenVRGpuCategory::Other, 0, "gpu timer");
+	}
+	memset(_bPending, 0, sizeof(_bPending));
+	_iCurrent = 0;
+	_bActive = false;
+	_bHasResult = false;
+	_iReadyFirst = 0;
+	_iReadyCount = 0;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRGpuTimer::exit() {
+	if (!_queries[0][0]) return;
+
+	for (int i = 0; i < kQueryCount; i++) {
+		ofxOpenVRGpuMemory::untrack(ofxOpenVRGpuMemory::Object::Query, _queries[i][0]);
+		ofxOpenVRGpuMemory::untrack(ofxOpenVRGpuMemory::Object::Query, _queries[i][1]);
+	}
+	glDeleteQueries(kQueryCount * 2, &_queries[0][0]);
+	memset(_queries, 0, sizeof(_queries));
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRGpuTimer::begin(uint64_t tag) {
+	if (!_queries[0][0]) return;
+
+	collectResults();
+
+	// If the GPU is more than kQueryCount frames behind, skip this measurement instead of waiting
+	_bActive = !_bPending[_iCurrent];
+	if (_bActive) {
+		glQueryCounter(_queries[_iCurrent][0], GL_TIMESTAMP);
+		_tags[_iCurrent] = tag;
+	}
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRGpuTimer::end() {
+	if (!_bActive) return;
+
+	glQueryCounter(_queries[_iCurrent][1], GL_TIMESTAMP);
+	_bPending[_iCurrent] = true;
+	_iCurrent = (_iCurrent + 1) % kQueryCount;
+	_bActive = false;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRGpuTimer::collectResults() {
+	// Slots are read in the order they were issued, the oldest one is the current slot
+	for (int i = 0; i < kQueryCount; i++) {
+		int slot = (_iCurrent + i) % kQueryCount;
+		if (!_bPending[slot]) continue;
+
+		GLint available = 0;
+		glGetQueryObjectiv(_queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) break;
+
+		GLuint64 t0 = 0, t1 = 0;
+		glGetQueryObjectui64v(_queries[slot][0], GL_QUERY_RESULT, &t0);
+		glGetQueryObjectui64v(_queries[slot][1], GL_QUERY_RESULT, &t1);
+		_fLastMs = (t1 - t0) / 1000000.0f;
+		_bHasResult = true;
+		_bPending[slot] = false;
+
+		// Keep the result for getNextResult(), the oldest unread one is dropped if nobody reads them
+		if (_iReadyCount == kQueryCount) {
+			_iReadyFirst = (_iReadyFirst + 1) % kQueryCount;
+			_iReadyCount--;
+		}
+		int ready = (_iReadyFirst + _iReadyCount) % kQueryCount;
+		_fReadyMs[ready] = _fLastMs;
+		_readyTags[ready] = _tags[slot];
+		_iReadyCount++;
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRGpuTimer::getNextResult(float &ms, uint64_t &tag) {
+	if (_iReadyCount == 0) return false;
+
+	ms = _fReadyMs[_iReadyFirst];
+	tag = _readyTags[_iReadyFirst];
+	_iReadyFirst = (_iReadyFirst + 1) % kQueryCount;
+	_iReadyCount--;
+	return true;
+}
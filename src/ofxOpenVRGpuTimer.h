@@ -0,0 +1,58 @@
+#pragma once
+
+#include "ofMain.h"
+
+/*
+	GPU timer based on GL_TIMESTAMP queries.
+
+	Queries are kept in a small ring and their results are read a few frames later,
+	so the timer never waits for the GPU. Timers may be nested.
+
+	Usage:
+		timer.setup();
+		...
+		timer.begin();
+		//GL commands
+		timer.end();
+		if (timer.hasResult()) cout << timer.getLastMs() << endl;
+
+	Each measurement can be tagged (for example, by frame number), 
+	use getNextResult() to get all results with their tags in the order they were measured.
+*/
+
+class ofxOpenVRGpuTimer {
+public:
+	ofxOpenVRGpuTimer();
+	~ofxOpenVRGpuTimer();
+
+	void setup();
+	void exit();
+
+	void begin(uint64_t tag = 0);
+	void end();
+
+	bool hasResult() { return _bHasResult; }
+	float getLastMs() { return _fLastMs; }		//latest available result, usually 2-3 frames old
+
+	bool getNextResult(float &ms, uint64_t &tag);	//results not read yet, oldest first
+
+protected:
+	static const int kQueryCount = 4;			//frames in flight
+
+	GLuint _queries[kQueryCount][2];			//begin and end timestamps
+	uint64_t _tags[kQueryCount];
+	bool _bPending[kQueryCount];
+	int _iCurrent;
+	bool _bActive;
+
+	bool _bHasResult;
+	float _fLastMs;
+
+	//Results which are collected, but not read by getNextResult()
+	float _fReadyMs[kQueryCount];
+	uint64_t _readyTags[kQueryCount];
+	int _iReadyFirst;
+	int _iReadyCount;
+
+	void collectResults();
+};
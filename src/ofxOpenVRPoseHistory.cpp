@@ -0,0 +1,110 @@
+#include "ofxOpenVRPoseHistory.h"
+
+//--------------------------------------------------------------
+glm::mat4 ofxOpenVRPoseSample::getMatrix() const {
+	glm::mat4 matrix = glm::mat4_cast(orientation);
+	matrix[3] = glm::vec4(position.x, position.y, position.z, 1.0f);
+	return matrix;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRPoseHistory::clear() {
+	for (auto &device : _devices) {
+		device.head = 0;
+		device.count = 0;
+	}
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRPoseHistory::add(vr::TrackedDeviceIndex_t unDevice, double dTime, const vr::TrackedDevicePose_t &devicePose, const glm::mat4 &matPose) {
+	if (unDevice >= vr::k_unMaxTrackedDeviceCount) return;
+	DeviceHistory &device = _devices[unDevice];
+
+	// Time must grow, otherwise the history is restarted
+	if (device.count > 0 && dTime <= device.at(device.count - 1).time) {
+		device.count = 0;
+	}
+
+	ofxOpenVRPoseSample &sample = device.samples[device.head];
+	sample.time = dTime;
+	sample.position = glm::vec3(matPose[3]);
+	sample.orientation = glm::normalize(glm::quat_cast(glm::mat3(matPose)));
+	sample.velocity = glm::vec3(devicePose.vVelocity.v[0], devicePose.vVelocity.v[1], devicePose.vVelocity.v[2]);
+	sample.angularVelocity = glm::vec3(devicePose.vAngularVelocity.v[0], devicePose.vAngularVelocity.v[1], devicePose.vAngularVelocity.v[2]);
+
+	device.head = (device.head + 1) % kHistorySize;
+	device.count = std::min(device.count + 1, kHistorySize);
+}
+
+//--------------------------------------------------------------
+int ofxOpenVRPoseHistory::getSampleCount(vr::TrackedDeviceIndex_t unDevice) const {
+	if (unDevice >= vr::k_unMaxTrackedDeviceCount) return 0;
+	return _devices[unDevice].count;
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRPoseHistory::getLatest(vr::TrackedDeviceIndex_t unDevice, ofxOpenVRPoseSample &sample) const {
+	if (getSampleCount(unDevice) == 0) return false;
+	const DeviceHistory &device = _devices[unDevice];
+	sample = device.at(device.count - 1);
+	return true;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRPoseHistory::interpolate(const ofxOpenVRPoseSample &a, const ofxOpenVRPoseSample &b, double dTime, ofxOpenVRPoseSample &sample) {
+	float t = float((dTime - a.time) / (b.time - a.time));
+	sample.time = dTime;
+	sample.position = glm::mix(a.position, b.position, t);
+	sample.orientation = glm::slerp(a.orientation, b.orientation, t);
+	sample.velocity = glm::mix(a.velocity, b.velocity, t);
+	sample.angularVelocity = glm::mix(a.angularVelocity, b.angularVelocity, t);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRPoseHistory::extrapolate(const ofxOpenVRPoseSample &a, double dTime, ofxOpenVRPoseSample &sample) {
+	float dt = float(dTime - a.time);
+	sample = a;
+	sample.time = dTime;
+	sample.position = a.position + a.velocity * dt;
+
+	// Rotation by angular velocity, applied in tracking space
+	float fSpeed = glm::length(a.angularVelocity);
+	if (fSpeed > 1e-6f) {
+		sample.orientation = glm::normalize(glm::angleAxis(fSpeed * dt, a.angularVelocity / fSpeed) * a.orientation);
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRPoseHistory::getSample(vr::TrackedDeviceIndex_t unDevice, double dTime, ofxOpenVRPoseSample &sample) const {
+	if (getSampleCount(unDevice) == 0) return false;
+	const DeviceHistory &device = _devices[unDevice];
+	const ofxOpenVRPoseSample &oldest = device.at(0);
+	const ofxOpenVRPoseSample &newest = device.at(device.count - 1);
+
+	if (dTime >= newest.time) {
+		extrapolate(newest, std::min(dTime, newest.time + maxExtrapolation), sample);
+		return true;
+	}
+	if (dTime <= oldest.time) {
+		sample = oldest;
+		return true;
+	}
+
+	// Estimate from the average interval, then step to the pair around dTime.
+	// Frame intervals vary a little, so a few steps are enough; the count is bounded by the history size anyway.
+	double dInterval = (newest.time - oldest.time) / (device.count - 1);
+	int i = ofClamp(int((dTime - oldest.time) / dInterval), 0, device.count - 2);
+	while (i > 0 && device.at(i).time > dTime) i--;
+	while (i < device.count - 2 && device.at(i + 1).time <= dTime) i++;
+
+	interpolate(device.at(i), device.at(i + 1), dTime, sample);
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRPoseHistory::getPose(vr::TrackedDeviceIndex_t unDevice, double dTime, glm::mat4 &pose) const {
+	ofxOpenVRPoseSample sample;
+	if (!getSample(unDevice, dTime, sample)) return false;
+	pose = sample.getMatrix();
+	return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "ofMain.h"
+#include <openvr.h>
+
+/*
+	Timestamped history of device poses, with velocities reported by the runtime.
+	ofxOpenVR::update() adds valid poses of all connected devices each frame, timestamped with ofGetElapsedTimeMicros().
+
+	Queries return a pose at any time: inside the history it is interpolated between the two nearest samples
+	(lerp of position, slerp of orientation), after the last sample it is extrapolated with the last velocities,
+	before the first sample the first one is returned. Queries don't allocate and take constant time:
+	samples are nearly uniform in time, so the sample index is estimated from the average frame interval
+	and corrected by a few steps.
+
+	Usage (drawing and physics running at own rate):
+		glm::mat4 pose;
+		if (openVR.getPoseHistory().getPose(deviceIndex, ofGetElapsedTimeMicros() / 1000000.0, pose)) {
+			...
+		}
+*/
+
+//--------------------------------------------------------------
+struct ofxOpenVRPoseSample {
+	double time = 0;				//seconds
+	glm::vec3 position;
+	glm::quat orientation;
+	glm::vec3 velocity;				//meters/second
+	glm::vec3 angularVelocity;		//radians/second, in tracking space
+
+	glm::mat4 getMatrix() const;
+};
+
+//--------------------------------------------------------------
+class ofxOpenVRPoseHistory {
+public:
+	static const int kHistorySize = 64;		//samples per device, ~0.7 seconds at 90 Hz
+	float maxExtrapolation = 0.1f;			//seconds, later queries return the pose at this time
+
+	void clear();
+	void add(vr::TrackedDeviceIndex_t unDevice, double dTime, const vr::TrackedDevicePose_t &devicePose, const glm::mat4 &matPose);
+
+	int getSampleCount(vr::TrackedDeviceIndex_t unDevice) const;
+	bool getLatest(vr::TrackedDeviceIndex_t unDevice, ofxOpenVRPoseSample &sample) const;
+
+	//Pose at the time in seconds, false if there are no samples for the device
+	bool getSample(vr::TrackedDeviceIndex_t unDevice, double dTime, ofxOpenVRPoseSample &sample) const;
+	bool getPose(vr::TrackedDeviceIndex_t unDevice, double dTime, glm::mat4 &pose) const;
+
+protected:
+	struct DeviceHistory {
+		std::array<ofxOpenVRPoseSample, kHistorySize> samples;
+		int head = 0;	//index of the next sample to write
+		int count = 0;
+		const ofxOpenVRPoseSample &at(int i) const { return samples[(head - count + i + kHistorySize) % kHistorySize]; }	//0 - oldest
+	};
+	std::array<DeviceHistory, vr::k_unMaxTrackedDeviceCount> _devices;
+
+	static void interpolate(const ofxOpenVRPoseSample &a, const ofxOpenVRPoseSample &b, double dTime, ofxOpenVRPoseSample &sample);
+	static void extrapolate(const ofxOpenVRPoseSample &a, double dTime, ofxOpenVRPoseSample &sample);
+};
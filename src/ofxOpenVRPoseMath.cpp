@@ -0,0 +1,154 @@
+#include "ofxOpenVRPoseMath.h"
+
+#if !defined(OFXOPENVR_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define OFXOPENVR_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace ofxOpenVRPoseMath {
+
+	//--------------------------------------------------------------
+	bool isSimdEnabled() {
+#ifdef OFXOPENVR_SSE
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	//--------------------------------------------------------------
+	glm::mat4 toMatrix(const vr::HmdMatrix34_t &matPose) {
+		return glm::mat4(
+			matPose.m[0][0], matPose.m[1][0], matPose.m[2][0], 0.0f,
+			matPose.m[0][1], matPose.m[1][1], matPose.m[2][1], 0.0f,
+			matPose.m[0][2], matPose.m[1][2], matPose.m[2][2], 0.0f,
+			matPose.m[0][3], matPose.m[1][3], matPose.m[2][3], 1.0f
+		);
+	}
+
+	//--------------------------------------------------------------
+	glm::mat4 toMatrix(const vr::HmdMatrix44_t &mat) {
+		return glm::mat4(
+			mat.m[0][0], mat.m[1][0], mat.m[2][0], mat.m[3][0],
+			mat.m[0][1], mat.m[1][1], mat.m[2][1], mat.m[3][1],
+			mat.m[0][2], mat.m[1][2], mat.m[2][2], mat.m[3][2],
+			mat.m[0][3], mat.m[1][3], mat.m[2][3], mat.m[3][3]
+		);
+	}
+
+	//--------------------------------------------------------------
+	// Purpose: HmdMatrix34_t is row-major 3x4, glm::mat4 is column-major 4x4:
+	// with SSE the three rows and (0,0,0,1) are transposed into four columns
+	//--------------------------------------------------------------
+	uint64_t convertPoses(const vr::TrackedDevicePose_t *poses, uint32_t count, glm::mat4 *matrices) {
+		uint64_t ulConverted = 0;
+#ifdef OFXOPENVR_SSE
+		const __m128 lastRow = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+#endif
+		for (uint32_t i = 0; i < count; i++) {
+			if (!poses[i].bPoseIsValid) continue;
+			if (i < 64) ulConverted |= uint64_t(1) << i;
+#ifdef OFXOPENVR_SSE
+			const float *m = &poses[i].mDeviceToAbsoluteTracking.m[0][0];
+			__m128 c0 = _mm_loadu_ps(m);
+			__m128 c1 = _mm_loadu_ps(m + 4);
+			__m128 c2 = _mm_loadu_ps(m + 8);
+			__m128 c3 = lastRow;
+			_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+			float *out = glm::value_ptr(matrices[i]);
+			_mm_storeu_ps(out, c0);
+			_mm_storeu_ps(out + 4, c1);
+			_mm_storeu_ps(out + 8, c2);
+			_mm_storeu_ps(out + 12, c3);
+#else
+			matrices[i] = toMatrix(poses[i].mDeviceToAbsoluteTracking);
+#endif
+		}
+		return ulConverted;
+	}
+
+	//--------------------------------------------------------------
+	glm::mat4 invertRigid(const glm::mat4 &matrix) {
+		glm::mat4 inverse;
+		invertRigid(&matrix, 1, &inverse);
+		return inverse;
+	}
+
+	//--------------------------------------------------------------
+	// Purpose: For M = [R t], M^-1 = [R^T  -R^T t]
+	//--------------------------------------------------------------
+	void invertRigid(const glm::mat4 *matrices, uint32_t count, glm::mat4 *inverses) {
+		for (uint32_t i = 0; i < count; i++) {
+#ifdef OFXOPENVR_SSE
+			const float *m = glm::value_ptr(matrices[i]);
+			__m128 c0 = _mm_loadu_ps(m);
+			__m128 c1 = _mm_loadu_ps(m + 4);
+			__m128 c2 = _mm_loadu_ps(m + 8);
+			__m128 t = _mm_loadu_ps(m + 12);
+			__m128 w = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(c0, c1, c2, w);	//c0..c2 - columns of R^T with w = 0
+
+			__m128 c3 = _mm_mul_ps(c0, _mm_shuffle_ps(t, t, _MM_SHUFFLE(0, 0, 0, 0)));
+			c3 = _mm_add_ps(c3, _mm_mul_ps(c1, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1))));
+			c3 = _mm_add_ps(c3, _mm_mul_ps(c2, _mm_shuffle_ps(t, t, _MM_SHUFFLE(2, 2, 2, 2))));
+			c3 = _mm_sub_ps(_mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f), c3);
+
+			float *out = glm::value_ptr(inverses[i]);
+			_mm_storeu_ps(out, c0);
+			_mm_storeu_ps(out + 4, c1);
+			_mm_storeu_ps(out + 8, c2);
+			_mm_storeu_ps(out + 12, c3);
+#else
+			glm::mat3 rotation = glm::transpose(glm::mat3(matrices[i]));
+			glm::vec3 translation = -(rotation * glm::vec3(matrices[i][3]));
+			glm::mat4 &inverse = inverses[i];
+			inverse = glm::mat4(rotation);
+			inverse[3] = glm::vec4(translation.x, translation.y, translation.z, 1.0f);
+#endif
+		}
+	}
+
+	//--------------------------------------------------------------
+	glm::vec3 getAxis(const glm::mat4 &matrix, int axis) {
+		return glm::normalize(glm::vec3(matrix[axis]));
+	}
+
+	//--------------------------------------------------------------
+	// Purpose: With SSE, lengths of the three axes are computed at once on transposed columns
+	//--------------------------------------------------------------
+	void extractCentersAndAxes(const glm::mat4 *matrices, uint32_t count, glm::vec3 *centers, glm::vec3 *axes) {
+		for (uint32_t i = 0; i < count; i++) {
+			if (centers) {
+				centers[i] = glm::vec3(matrices[i][3]);
+			}
+			if (!axes) continue;
+#ifdef OFXOPENVR_SSE
+			const float *m = glm::value_ptr(matrices[i]);
+			__m128 x = _mm_loadu_ps(m);
+			__m128 y = _mm_loadu_ps(m + 4);
+			__m128 z = _mm_loadu_ps(m + 8);
+			__m128 w = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(x, y, z, w);	//lane k of x, y, z - components of axis k
+
+			__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+			__m128 scale = _mm_div_ps(_mm_set1_ps(1.0f), length);
+			x = _mm_mul_ps(x, scale);
+			y = _mm_mul_ps(y, scale);
+			z = _mm_mul_ps(z, scale);
+			_MM_TRANSPOSE4_PS(x, y, z, w);	//back to axes
+
+			float v[4];
+			_mm_storeu_ps(v, x);
+			axes[i * 3] = glm::vec3(v[0], v[1], v[2]);
+			_mm_storeu_ps(v, y);
+			axes[i * 3 + 1] = glm::vec3(v[0], v[1], v[2]);
+			_mm_storeu_ps(v, z);
+			axes[i * 3 + 2] = glm::vec3(v[0], v[1], v[2]);
+#else
+			for (int k = 0; k < 3; k++) {
+				axes[i * 3 + k] = getAxis(matrices[i], k);
+			}
+#endif
+		}
+	}
+}
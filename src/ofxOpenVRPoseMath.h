@@ -0,0 +1,37 @@
+#pragma once
+
+#include "ofMain.h"
+#include <openvr.h>
+
+/*
+	Batched pose math for all tracked devices at once.
+	Uses SSE when the compiler targets it (always on x64), otherwise a scalar version with the same results.
+	Define OFXOPENVR_NO_SIMD to force the scalar version.
+
+	- convertPoses: valid HmdMatrix34_t poses to glm::mat4 in one pass, as ofxOpenVR::convertSteamVRMatrixToMatrix4()
+	- invertRigid: inverse of rotation + translation matrices: transposed rotation and rotated negated translation,
+	  instead of general glm::inverse
+	- extractCentersAndAxes: positions and normalized OX, OY, OZ axes, as ofxOpenVR::get_center() and get_axe()
+
+	Usage:
+		const ofxOpenVRDevicePoses &poses = openVR.getDevicePoses();
+		glm::vec3 centers[ofxOpenVRDevicePoses::kCapacity];
+		glm::vec3 axes[ofxOpenVRDevicePoses::kCapacity * 3];
+		ofxOpenVRPoseMath::extractCentersAndAxes(poses.pose.data(), poses.count, centers, axes);
+*/
+
+namespace ofxOpenVRPoseMath {
+	bool isSimdEnabled();
+
+	//Converts poses with bPoseIsValid, other matrices in 'matrices' are kept. Returns bit i set for each converted pose i < 64
+	uint64_t convertPoses(const vr::TrackedDevicePose_t *poses, uint32_t count, glm::mat4 *matrices);
+	glm::mat4 toMatrix(const vr::HmdMatrix34_t &matPose);
+	glm::mat4 toMatrix(const vr::HmdMatrix44_t &mat);
+
+	void invertRigid(const glm::mat4 *matrices, uint32_t count, glm::mat4 *inverses);	//in-place is allowed
+	glm::mat4 invertRigid(const glm::mat4 &matrix);
+
+	//centers: count values, axes: 3 * count values (OX, OY, OZ of each pose), any of them may be nullptr
+	void extractCentersAndAxes(const glm::mat4 *matrices, uint32_t count, glm::vec3 *centers, glm::vec3 *axes);
+	glm::vec3 getAxis(const glm::mat4 &matrix, int axis);	//axis 0,1,2 - OX,OY,OZ, normalized
+}
@@ -0,0 +1,101 @@
+#include "ofxOpenVRPreview.h"
+#include "ofxOpenVRGpuMemory.h"
+
+//--------------------------------------------------------------
+void ofxOpenVRPreview::setSettings(const ofxOpenVRPreviewSettings &settings) {
+	_settings = settings;
+	_settings.scale = ofClamp(settings.scale, 0.05f, 1.0f);
+	_settings.interval = std::max(settings.interval, 1);
+	_bCopyValid = false;
+
+	// The copy is only needed while it saves work
+	if (_settings.scale >= 1.0f && _settings.interval == 1) {
+		clear();
+	}
+}
+
+//--------------------------------------------------------------
+// Purpose: Fit shrinks the destination to the image's aspect ratio, Crop shrinks the source to the window's.
+// Blits are in GL window coordinates, so dst is flipped vertically; the image keeps its orientation.
+//--------------------------------------------------------------
+void ofxOpenVRPreview::draw(GLuint glSrcFramebuffer, const ofRectangle &src, const ofRectangle &dst) {
+	if (src.width < 1 || src.height < 1 || dst.width < 1 || dst.height < 1) return;
+
+	float srcX = src.x, srcY = src.y, srcW = src.width, srcH = src.height;
+	float dstX = dst.x, dstY = dst.y, dstW = dst.width, dstH = dst.height;
+	if (_settings.mode == ofxOpenVRPreviewMode::Fit) {
+		float scl = std::min(dstW / srcW, dstH / srcH);
+		dstX += (dstW - srcW * scl) / 2;
+		dstY += (dstH - srcH * scl) / 2;
+		dstW = srcW * scl;
+		dstH = srcH * scl;
+	}
+	else if (_settings.mode == ofxOpenVRPreviewMode::Crop) {
+		float scl = std::max(dstW / srcW, dstH / srcH);
+		srcX += (srcW - dstW / scl) / 2;
+		srcY += (srcH - dstH / scl) / 2;
+		srcW = dstW / scl;
+		srcH = dstH / scl;
+	}
+
+	std::array<int, 4> srcRect = { int(srcX), int(srcY), int(srcX + srcW), int(srcY + srcH) };
+	int dstX0 = int(dstX);
+	int dstY0 = int(ofGetHeight() - (dstY + dstH));
+	int dstX1 = int(dstX + dstW);
+	int dstY1 = int(ofGetHeight() - dstY);
+
+	GLint glDrawFramebuffer = 0, glReadFramebuffer = 0;
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &glDrawFramebuffer);
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &glReadFramebuffer);
+
+	if (_settings.scale >= 1.0f && _settings.interval == 1) {
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, glSrcFramebuffer);
+		glBlitFramebuffer(srcRect[0], srcRect[1], srcRect[2], srcRect[3], dstX0, dstY0, dstX1, dstY1, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+	}
+	else {
+		int nWidth = std::max(int(std::ceil((dstX1 - dstX0) * _settings.scale)), 1);
+		int nHeight = std::max(int(std::ceil((dstY1 - dstY0) * _settings.scale)), 1);
+		if (!_fbo.isAllocated() || nWidth != _nFboWidth || nHeight != _nFboHeight) {
+			ofFbo::Settings settings;
+			settings.width = nWidth;
+			settings.height = nHeight;
+			settings.internalformat = GL_RGBA;
+			settings.textureTarget = GL_TEXTURE_2D;
+			ofxOpenVRGpuMemory::untrackFbo(_fbo);
+			_fbo.allocate(settings);
+			ofxOpenVRGpuMemory::trackFbo(_fbo, settings, ofxOpenVRGpuCategory::EyeBuffers, "preview");
+			_nFboWidth = nWidth;
+			_nFboHeight = nHeight;
+			_bCopyValid = false;
+		}
+
+		// Refreshed every interval-th frame, or at once when the source moved (mode or dynamic resolution changed)
+		uint64_t ulFrame = ofGetFrameNum();
+		if (!_bCopyValid || srcRect != _lastSrc || ulFrame < _ulCopyFrame || ulFrame - _ulCopyFrame >= uint64_t(_settings.interval)) {
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, glSrcFramebuffer);
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _fbo.getId());
+			glBlitFramebuffer(srcRect[0], srcRect[1], srcRect[2], srcRect[3], 0, 0, nWidth, nHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+			_lastSrc = srcRect;
+			_ulCopyFrame = ulFrame;
+			_bCopyValid = true;
+		}
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, _fbo.getId());
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, glDrawFramebuffer);
+		glBlitFramebuffer(0, 0, nWidth, nHeight, dstX0, dstY0, dstX1, dstY1, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+	}
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, glReadFramebuffer);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, glDrawFramebuffer);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRPreview::clear() {
+	if (_nFboWidth > 0) {
+		ofxOpenVRGpuMemory::untrackFbo(_fbo);
+		_fbo.clear();
+	}
+	_nFboWidth = 0;
+	_nFboHeight = 0;
+	_bCopyValid = false;
+}
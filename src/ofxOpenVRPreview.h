@@ -0,0 +1,62 @@
+#pragma once
+
+#include "ofMain.h"
+#include <openvr.h>
+
+/*
+	Desktop preview of an eye image, used by ofxOpenVR::drawPreview().
+
+	The image render() has already submitted to the HMD is copied to the window with glBlitFramebuffer,
+	so the scene is not rendered a third time and no geometry or shader is involved.
+	Fit shows the whole image with borders, Crop fills the window and cuts off the sides, Stretch fills it as is.
+
+	With scale < 1 or interval > 1 the image is first copied into a small buffer of the preview's size times scale,
+	which is refreshed every interval-th frame and blitted to the window in between.
+
+	Usage:
+		ofxOpenVRPreviewSettings settings;
+		settings.mode = ofxOpenVRPreviewMode::Crop;
+		settings.scale = 0.5f;		//half resolution
+		settings.interval = 3;		//refreshed at a third of the frame rate
+		openVR.setPreview(settings);
+		...
+		//in ofApp::draw(), after openVR.render()
+		openVR.drawPreview();
+*/
+
+//--------------------------------------------------------------
+enum class ofxOpenVRPreviewMode
+{
+	Fit = 0,		//whole image, borders keep the window's background
+	Crop = 1,		//fills the window, the image is cut to its aspect ratio
+	Stretch = 2		//fills the window, ignoring aspect ratio
+};
+
+//--------------------------------------------------------------
+struct ofxOpenVRPreviewSettings {
+	vr::Hmd_Eye eye = vr::Eye_Left;
+	ofxOpenVRPreviewMode mode = ofxOpenVRPreviewMode::Fit;
+	float scale = 1.0f;		//resolution of the kept copy relative to the preview, 0.05..1
+	int interval = 1;		//the copy is refreshed every interval-th frame, 1 - copies the eye image each frame
+};
+
+//--------------------------------------------------------------
+class ofxOpenVRPreview {
+public:
+	void setSettings(const ofxOpenVRPreviewSettings &settings);
+	const ofxOpenVRPreviewSettings &getSettings() const { return _settings; }
+
+	//Blits src (pixels of the read framebuffer, origin at the bottom left) into dst (window coordinates, origin at the top left)
+	//of the bound draw framebuffer
+	void draw(GLuint glSrcFramebuffer, const ofRectangle &src, const ofRectangle &dst);
+	void clear();
+
+protected:
+	ofxOpenVRPreviewSettings _settings;
+	ofFbo _fbo;				//kept copy for scale < 1 or interval > 1
+	int _nFboWidth = 0;
+	int _nFboHeight = 0;
+	std::array<int, 4> _lastSrc = {};	//source rectangle of the kept copy
+	uint64_t _ulCopyFrame = 0;
+	bool _bCopyValid = false;
+};
@@ -0,0 +1,252 @@
+#include "ofxOpenVRProfiler.h"
+
+//--------------------------------------------------------------
+static const char *kStageNames[ofxOpenVRProfiler::kStageCount] = {
+	"update",
+	"waitGetPoses",
+	"events",
+	"cameraCopy",
+	"cameraUpload",
+	"render",
+	"renderLeft",
+	"renderRight",
+	"renderStereo",
+	"submit",
+	"devicePoses",
+	"controllers",
+	"renderModels"
+};
+
+//--------------------------------------------------------------
+ofxOpenVRProfiler::ofxOpenVRProfiler() {
+	_bEnabled = false;
+	_bGLInit = false;
+	_scratch.reserve(kHistorySize);
+	clear();
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRProfiler::setup() {
+	for (auto &timer : _gpuTimers) {
+		timer.setup();
+	}
+	_bGLInit = true;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRProfiler::exit() {
+	for (auto &timer : _gpuTimers) {
+		timer.exit();
+	}
+	_bGLInit = false;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRProfiler::setEnabled(bool bEnabled) {
+	_bEnabled = bEnabled;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRProfiler::clear() {
+	for (auto &record : _history) {
+		record.frame = 0;
+	}
+	_nFrame = 0;
+	_iCurrent = 0;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRProfiler::beginFrame() {
+	if (!_bEnabled) return;
+
+	_nFrame++;
+	_iCurrent = (_iCurrent + 1) % kHistorySize;
+
+	FrameRecord &record = _history[_iCurrent];
+	record.frame = _nFrame;
+	for (int i = 0; i < kStageCount; i++) {
+		record.cpuMs[i] = -1;
+		record.gpuMs[i] = -1;
+	}
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRProfiler::begin(ofxOpenVRStage stage) {
+	if (!_bEnabled || _nFrame == 0) return;
+
+	int i = int(stage);
+	if (_bGLInit) {
+		collectGpuResults(i);
+		_gpuTimers[i].begin(_nFrame);
+	}
+	_stageStart[i] = std::chrono::steady_clock::now();
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRProfiler::end(ofxOpenVRStage stage) {
+	if (!_bEnabled || _nFrame == 0) return;
+
+	int i = int(stage);
+	float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - _stageStart[i]).count();
+	if (_bGLInit) {
+		_gpuTimers[i].end();
+	}
+
+	// A stage may run several times per frame, its times are summed
+	FrameRecord &record = _history[_iCurrent];
+	record.cpuMs[i] = (record.cpuMs[i] < 0) ? ms : record.cpuMs[i] + ms;
+}
+
+//--------------------------------------------------------------
+ofxOpenVRProfiler::FrameRecord *ofxOpenVRProfiler::findRecord(uint64_t frame) {
+	if (frame == 0 || frame > _nFrame || _nFrame - frame >= kHistorySize) return nullptr;
+
+	int index = (_iCurrent - int(_nFrame - frame) + kHistorySize) % kHistorySize;
+	FrameRecord &record = _history[index];
+	return (record.frame == frame) ? &record : nullptr;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRProfiler::collectGpuResults(int stage) {
+	float ms;
+	uint64_t frame;
+	while (_gpuTimers[stage].getNextResult(ms, frame)) {
+		FrameRecord *record = findRecord(frame);
+		if (record) {
+			record->gpuMs[stage] = (record->gpuMs[stage] < 0) ? ms : record->gpuMs[stage] + ms;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+ofxOpenVRStageStats ofxOpenVRProfiler::computeStats(int stage, bool gpu) {
+	_scratch.clear();
+	for (const auto &record : _history) {
+		if (record.frame == 0) continue;
+		float ms = gpu ? record.gpuMs[stage] : record.cpuMs[stage];
+		if (ms >= 0) _scratch.push_back(ms);
+	}
+
+	ofxOpenVRStageStats stats;
+	stats.samples = _scratch.size();
+	if (_scratch.empty()) return stats;
+
+	stats.min = _scratch[0];
+	stats.max = _scratch[0];
+	double sum = 0;
+	for (float ms : _scratch) {
+		stats.min = min(stats.min, ms);
+		stats.max = max(stats.max, ms);
+		sum += ms;
+	}
+	stats.avg = sum / _scratch.size();
+
+	size_t k = (size_t)(0.99 * (_scratch.size() - 1));
+	std::nth_element(_scratch.begin(), _scratch.begin() + k, _scratch.end());
+	stats.p99 = _scratch[k];
+	return stats;
+}
+
+//--------------------------------------------------------------
+ofxOpenVRStageStats ofxOpenVRProfiler::getCpuStats(ofxOpenVRStage stage) {
+	return computeStats(int(stage), false);
+}
+
+//--------------------------------------------------------------
+ofxOpenVRStageStats ofxOpenVRProfiler::getGpuStats(ofxOpenVRStage stage) {
+	if (_bGLInit) collectGpuResults(int(stage));
+	return computeStats(int(stage), true);
+}
+
+//--------------------------------------------------------------
+const char *ofxOpenVRProfiler::getStageName(ofxOpenVRStage stage) {
+	int i = int(stage);
+	return (i >= 0 && i < kStageCount) ? kStageNames[i] : "unknown";
+}
+
+//--------------------------------------------------------------
+std::string ofxOpenVRProfiler::toCsv() {
+	std::ostringstream out;
+	out << "frame";
+	for (int i = 0; i < kStageCount; i++) {
+		out << "," << kStageNames[i] << "_cpu_ms," << kStageNames[i] << "_gpu_ms";
+	}
+	out << "\n";
+
+	// Oldest frame first
+	for (int n = 1; n <= kHistorySize; n++) {
+		const FrameRecord &record = _history[(_iCurrent + n) % kHistorySize];
+		if (record.frame == 0) continue;
+		out << record.frame;
+		for (int i = 0; i < kStageCount; i++) {
+			out << "," << record.cpuMs[i] << "," << record.gpuMs[i];
+		}
+		out << "\n";
+	}
+	return out.str();
+}
+
+//--------------------------------------------------------------
+std::string ofxOpenVRProfiler::toJson() {
+	std::ostringstream out;
+	out << "{\n\t\"stats\": {\n";
+	for (int i = 0; i < kStageCount; i++) {
+		ofxOpenVRStageStats cpu = getCpuStats(ofxOpenVRStage(i));
+		ofxOpenVRStageStats gpu = getGpuStats(ofxOpenVRStage(i));
+		out << "\t\t\"" << kStageNames[i] << "\": {"
+			<< " \"cpu\": { \"samples\": " << cpu.samples << ", \"min\": " << cpu.min << ", \"avg\": " << cpu.avg << ", \"p99\": " << cpu.p99 << ", \"max\": " << cpu.max << " },"
+			<< " \"gpu\": { \"samples\": " << gpu.samples << ", \"min\": " << gpu.min << ", \"avg\": " << gpu.avg << ", \"p99\": " << gpu.p99 << ", \"max\": " << gpu.max << " } }"
+			<< ((i + 1 < kStageCount) ? ",\n" : "\n");
+	}
+	out << "\t},\n\t\"frames\": [\n";
+
+	bool first = true;
+	for (int n = 1; n <= kHistorySize; n++) {
+		const FrameRecord &record = _history[(_iCurrent + n) % kHistorySize];
+		if (record.frame == 0) continue;
+		out << (first ? "" : ",\n") << "\t\t{ \"frame\": " << record.frame;
+		for (int i = 0; i < kStageCount; i++) {
+			out << ", \"" << kStageNames[i] << "\": [" << record.cpuMs[i] << ", " << record.gpuMs[i] << "]";
+		}
+		out << " }";
+		first = false;
+	}
+	out << "\n\t]\n}\n";
+	return out.str();
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRProfiler::saveCsv(const std::string &fileName) {
+	std::ofstream file(ofToDataPath(fileName));
+	if (!file) {
+		ofLogError("ofxOpenVRProfiler") << "Unable to write " << fileName;
+		return false;
+	}
+	file << toCsv();
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRProfiler::saveJson(const std::string &fileName) {
+	std::ofstream file(ofToDataPath(fileName));
+	if (!file) {
+		ofLogError("ofxOpenVRProfiler") << "Unable to write " << fileName;
+		return false;
+	}
+	file << toJson();
+	return true;
+}
+
+//--------------------------------------------------------------
+std::string ofxOpenVRProfiler::getSummary() {
+	std::ostringstream out;
+	out << "Stage          cpu avg/p99    gpu avg/p99 (ms)" << endl;
+	for (int i = 0; i < kStageCount; i++) {
+		ofxOpenVRStageStats cpu = getCpuStats(ofxOpenVRStage(i));
+		if (cpu.samples == 0) continue;
+		ofxOpenVRStageStats gpu = getGpuStats(ofxOpenVRStage(i));
+		out << std::left << std::setw(15) << kStageNames[i] << std::fixed << std::setprecision(2)
+			<< cpu.avg << "/" << cpu.p99 << "    " << gpu.avg << "/" << gpu.p99 << endl;
+	}
+	return out.str();
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxOpenVRGpuTimer.h"
+
+/*
+	Per-stage frame profiler of ofxOpenVR.
+
+	Each stage of update() and render() is measured with CPU timestamps and GPU timestamp queries.
+	Results are stored in a fixed-size ring buffer of the last kHistorySize frames, 
+	so it can be kept enabled in production installs. GPU times arrive 2-3 frames later
+	and are written to the frame in which the stage was executed.
+
+	Usage:
+		openVR.setProfilingEnabled(true);
+		...
+		ofxOpenVRStageStats s = openVR.getProfiler().getCpuStats(ofxOpenVRStage::Render);
+		cout << s.avg << " " << s.p99 << endl;
+		openVR.getProfiler().saveCsv("profile.csv");
+*/
+
+//--------------------------------------------------------------
+enum class ofxOpenVRStage
+{
+	Update = 0,			//whole update()
+	WaitGetPoses = 1,	//waiting for poses from compositor
+	Events = 2,			//polling and processing of VR events
+	CameraCopy = 3,		//taking the newest received camera frame
+	CameraUpload = 4,	//queueing upload of the camera frame into the camera texture
+	Render = 5,			//whole render()
+	RenderLeft = 6,		//rendering left eye
+	RenderRight = 7,	//rendering right eye
+	RenderStereo = 8,	//rendering both eyes in single-pass stereo mode
+	Submit = 9,			//submitting eye textures to compositor
+	DevicePoses = 10,	//whole updateDevicesMatrixPose(), including WaitGetPoses
+	Controllers = 11,	//drawControllers()
+	RenderModels = 12,	//polling render model loads and uploading them within the budget
+	Count = 13
+};
+
+//--------------------------------------------------------------
+struct ofxOpenVRStageStats {
+	int samples = 0;	//number of frames where the stage was measured
+	float min = 0;		//milliseconds
+	float avg = 0;
+	float p99 = 0;
+	float max = 0;
+};
+
+//--------------------------------------------------------------
+class ofxOpenVRProfiler {
+public:
+	static const int kStageCount = int(ofxOpenVRStage::Count);
+	static const int kHistorySize = 512;	//frames
+
+	ofxOpenVRProfiler();
+
+	void setup();	//call with GL context
+	void exit();
+
+	void setEnabled(bool bEnabled);
+	bool isEnabled() { return _bEnabled; }
+	void clear();
+
+	void beginFrame();	//starts a new history record, called at the beginning of update()
+	void begin(ofxOpenVRStage stage);
+	void end(ofxOpenVRStage stage);
+
+	ofxOpenVRStageStats getCpuStats(ofxOpenVRStage stage);
+	ofxOpenVRStageStats getGpuStats(ofxOpenVRStage stage);
+	static const char *getStageName(ofxOpenVRStage stage);
+
+	//Dump of the history, one row per frame, -1 means the stage was not executed in the frame
+	std::string toCsv();
+	std::string toJson();	//stats for each stage and the history
+	bool saveCsv(const std::string &fileName);
+	bool saveJson(const std::string &fileName);
+
+	std::string getSummary();	//text for drawDebugInfo()
+
+protected:
+	struct FrameRecord {
+		uint64_t frame;
+		float cpuMs[kStageCount];
+		float gpuMs[kStageCount];
+	};
+
+	bool _bEnabled;
+	bool _bGLInit;
+	uint64_t _nFrame;			//number of the current frame, 0 - no frames yet
+
+	std::array<FrameRecord, kHistorySize> _history;
+	int _iCurrent;				//index of the current frame in _history
+
+	std::array<std::chrono::steady_clock::time_point, kStageCount> _stageStart;
+	std::array<ofxOpenVRGpuTimer, kStageCount> _gpuTimers;
+
+	std::vector<float> _scratch;	//preallocated buffer for computing stats
+
+	FrameRecord *findRecord(uint64_t frame);
+	void collectGpuResults(int stage);
+	ofxOpenVRStageStats computeStats(int stage, bool gpu);
+};
@@ -0,0 +1,376 @@
+#include "ofxOpenVRRecorder.h"
+
+using namespace ofxOpenVRSessionFile;
+
+namespace {
+	const uint64_t kFlushIntervalFrames = 90;	//a crash loses at most ~1 second of recording
+
+	//--------------------------------------------------------------
+	void readString(ofxOpenVRBackend *pVR, vr::TrackedDeviceIndex_t unDevice, vr::ETrackedDeviceProperty prop, char *pchValue, uint32_t unBufferSize) {
+		vr::ETrackedPropertyError eError = vr::TrackedProp_Success;
+		uint32_t unLen = pVR->GetStringTrackedDeviceProperty(unDevice, prop, pchValue, unBufferSize, &eError);
+		if (eError != vr::TrackedProp_Success || unLen == 0) pchValue[0] = 0;
+		pchValue[unBufferSize - 1] = 0;
+	}
+}
+
+//--------------------------------------------------------------
+ofxOpenVRRecordingBackend::ofxOpenVRRecordingBackend(std::shared_ptr<ofxOpenVRBackend> backend, const std::string &fileName) {
+	_backend = backend;
+	_fileName = fileName;
+	_nBytesWritten = 0;
+	_nFrame = 0;
+	_nStartTimeMicros = 0;
+	_nLastCameraSequence = 0;
+}
+
+//--------------------------------------------------------------
+ofxOpenVRRecordingBackend::~ofxOpenVRRecordingBackend() {
+	close();
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRecordingBackend::close() {
+	if (_file.is_open()) {
+		_file.close();
+		ofLogNotice("ofxOpenVR") << "Recorded " << _nFrame << " frames, " << _nBytesWritten << " bytes to " << _fileName;
+	}
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRecordingBackend::writeChunk(uint32_t type, const void *pData, uint32_t size) {
+	if (!_file.is_open()) return;
+
+	static const char padding[8] = { 0 };
+	Chunk chunk;
+	chunk.type = type;
+	chunk.size = alignedSize(size);
+	_file.write((const char *)&chunk, sizeof(chunk));
+	_file.write((const char *)pData, size);
+	_file.write(padding, chunk.size - size);
+	_nBytesWritten += sizeof(chunk) + chunk.size;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRecordingBackend::writeDevices() {
+	for (vr::TrackedDeviceIndex_t i = 0; i < vr::k_unMaxTrackedDeviceCount; i++) {
+		DeviceRecord device;
+		memset(&device, 0, sizeof(device));
+		device.index = i;
+		device.bConnected = _backend->IsTrackedDeviceConnected(i);
+		if (device.bConnected) {
+			device.deviceClass = _backend->GetTrackedDeviceClass(i);
+			device.role = _backend->GetControllerRoleForTrackedDeviceIndex(i);
+			readString(_backend.get(), i, vr::Prop_SerialNumber_String, device.serialNumber, sizeof(device.serialNumber));
+			readString(_backend.get(), i, vr::Prop_RenderModelName_String, device.renderModelName, sizeof(device.renderModelName));
+			readString(_backend.get(), i, vr::Prop_TrackingSystemName_String, device.trackingSystemName, sizeof(device.trackingSystemName));
+			readString(_backend.get(), i, vr::Prop_ModelNumber_String, device.modelNumber, sizeof(device.modelNumber));
+		}
+		if (memcmp(&device, &_lastDevices[i], sizeof(device)) != 0) {
+			_lastDevices[i] = device;
+			writeChunk(Chunk_Device, &device, sizeof(device));
+		}
+	}
+}
+
+//--------------------------------------------------------------
+vr::EVRInitError ofxOpenVRRecordingBackend::Init() {
+	vr::EVRInitError eError = _backend->Init();
+	if (eError != vr::VRInitError_None) return eError;
+
+	_nFrame = 0;
+	_nBytesWritten = 0;
+	_nStartTimeMicros = ofGetElapsedTimeMicros();
+	_nLastCameraSequence = 0;
+	memset(_lastPoses, 0, sizeof(_lastPoses));
+	memset(_lastPacketNum, 0, sizeof(_lastPacketNum));
+	memset(_bLastStateValid, 0, sizeof(_bLastStateValid));
+	memset(_lastDevices, 0, sizeof(_lastDevices));
+
+	_file.open(ofToDataPath(_fileName, true), std::ios::binary | std::ios::trunc);
+	if (!_file.is_open()) {
+		ofLogError("ofxOpenVR") << "Can't create session file " << _fileName << ", recording is disabled";
+		return eError;
+	}
+
+	Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.version = kVersion;
+	header.headerSize = sizeof(Header);
+	_backend->GetRecommendedRenderTargetSize(&header.renderWidth, &header.renderHeight);
+	header.poseSize = sizeof(vr::TrackedDevicePose_t);
+	header.controllerStateSize = sizeof(vr::VRControllerState_t);
+	header.eventSize = sizeof(vr::VREvent_t);
+	header.cameraHeaderSize = sizeof(vr::CameraVideoStreamFrameHeader_t);
+	_file.write((const char *)&header, sizeof(header));
+	_nBytesWritten += sizeof(header);
+
+	writeDevices();
+	ofLogNotice("ofxOpenVR") << "Recording session to " << _fileName;
+	return eError;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRecordingBackend::Shutdown() {
+	close();
+	_backend->Shutdown();
+}
+
+//--------------------------------------------------------------
+const char *ofxOpenVRRecordingBackend::GetInitErrorDescription(vr::EVRInitError eError) {
+	return _backend->GetInitErrorDescription(eError);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRecordingBackend::GetRecommendedRenderTargetSize(uint32_t *pnWidth, uint32_t *pnHeight) {
+	_backend->GetRecommendedRenderTargetSize(pnWidth, pnHeight);
+}
+
+//--------------------------------------------------------------
+vr::HmdMatrix44_t ofxOpenVRRecordingBackend::GetProjectionMatrix(vr::EVREye eEye, float fNearZ, float fFarZ) {
+	return _backend->GetProjectionMatrix(eEye, fNearZ, fFarZ);
+}
+
+//--------------------------------------------------------------
+vr::HmdMatrix34_t ofxOpenVRRecordingBackend::GetEyeToHeadTransform(vr::EVREye eEye) {
+	return _backend->GetEyeToHeadTransform(eEye);
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRRecordingBackend::ComputeDistortion(vr::EVREye eEye, float fU, float fV, vr::DistortionCoordinates_t *pDistortionCoordinates) {
+	return _backend->ComputeDistortion(eEye, fU, fV, pDistortionCoordinates);
+}
+
+//--------------------------------------------------------------
+vr::HiddenAreaMesh_t ofxOpenVRRecordingBackend::GetHiddenAreaMesh(vr::EVREye eEye, vr::EHiddenAreaMeshType type) {
+	return _backend->GetHiddenAreaMesh(eEye, type);
+}
+
+//--------------------------------------------------------------
+vr::ETrackedDeviceClass ofxOpenVRRecordingBackend::GetTrackedDeviceClass(vr::TrackedDeviceIndex_t unDeviceIndex) {
+	return _backend->GetTrackedDeviceClass(unDeviceIndex);
+}
+
+//--------------------------------------------------------------
+vr::ETrackedControllerRole ofxOpenVRRecordingBackend::GetControllerRoleForTrackedDeviceIndex(vr::TrackedDeviceIndex_t unDeviceIndex) {
+	return _backend->GetControllerRoleForTrackedDeviceIndex(unDeviceIndex);
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRRecordingBackend::IsTrackedDeviceConnected(vr::TrackedDeviceIndex_t unDeviceIndex) {
+	return _backend->IsTrackedDeviceConnected(unDeviceIndex);
+}
+
+//--------------------------------------------------------------
+uint32_t ofxOpenVRRecordingBackend::GetStringTrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, char *pchValue, uint32_t unBufferSize, vr::ETrackedPropertyError *pError) {
+	return _backend->GetStringTrackedDeviceProperty(unDeviceIndex, prop, pchValue, unBufferSize, pError);
+}
+
+//--------------------------------------------------------------
+vr::HmdMatrix34_t ofxOpenVRRecordingBackend::GetMatrix34TrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError *pError) {
+	return _backend->GetMatrix34TrackedDeviceProperty(unDeviceIndex, prop, pError);
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRRecordingBackend::GetControllerState(vr::TrackedDeviceIndex_t unControllerDeviceIndex, vr::VRControllerState_t *pControllerState, uint32_t unControllerStateSize) {
+	bool bResult = _backend->GetControllerState(unControllerDeviceIndex, pControllerState, unControllerStateSize);
+	if (bResult && unControllerDeviceIndex < vr::k_unMaxTrackedDeviceCount && unControllerStateSize >= sizeof(vr::VRControllerState_t)) {
+		// Only new packets are written
+		if (!_bLastStateValid[unControllerDeviceIndex] || _lastPacketNum[unControllerDeviceIndex] != pControllerState->unPacketNum) {
+			_bLastStateValid[unControllerDeviceIndex] = true;
+			_lastPacketNum[unControllerDeviceIndex] = pControllerState->unPacketNum;
+
+			ControllerStateRecord record;
+			memset(&record, 0, sizeof(record));
+			record.index = unControllerDeviceIndex;
+			record.state = *pControllerState;
+			writeChunk(Chunk_ControllerState, &record, sizeof(record));
+		}
+	}
+	return bResult;
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRRecordingBackend::PollNextEvent(vr::VREvent_t *pEvent, uint32_t uncbVREvent) {
+	bool bResult = _backend->PollNextEvent(pEvent, uncbVREvent);
+	if (bResult) {
+		// Device changes go before the event, so replay's device info is up to date when the event is processed
+		switch (pEvent->eventType) {
+		case vr::VREvent_TrackedDeviceActivated:
+		case vr::VREvent_TrackedDeviceDeactivated:
+		case vr::VREvent_TrackedDeviceUpdated:
+		case vr::VREvent_TrackedDeviceRoleChanged:
+			writeDevices();
+			break;
+		default:
+			break;
+		}
+		writeChunk(Chunk_Event, pEvent, std::min<uint32_t>(uncbVREvent, sizeof(vr::VREvent_t)));
+	}
+	return bResult;
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRRecordingBackend::HasCompositor() {
+	return _backend->HasCompositor();
+}
+
+//--------------------------------------------------------------
+vr::EVRCompositorError ofxOpenVRRecordingBackend::WaitGetPoses(vr::TrackedDevicePose_t *pRenderPoseArray, uint32_t unRenderPoseArrayCount, vr::TrackedDevicePose_t *pGamePoseArray, uint32_t unGamePoseArrayCount) {
+	vr::EVRCompositorError eError = _backend->WaitGetPoses(pRenderPoseArray, unRenderPoseArrayCount, pGamePoseArray, unGamePoseArrayCount);
+	_nFrame++;
+	if (!_file.is_open() || !pRenderPoseArray) return eError;
+
+	// Frame record followed by the poses which changed
+	FrameRecord frame;
+	frame.nFrame = _nFrame;
+	frame.dTime = (ofGetElapsedTimeMicros() - _nStartTimeMicros) / 1000000.0;
+	frame.ulChangedMask = 0;
+
+	uint32_t unSize = sizeof(FrameRecord);
+	uint32_t unCount = std::min(unRenderPoseArrayCount, vr::k_unMaxTrackedDeviceCount);
+	for (uint32_t i = 0; i < unCount; i++) {
+		if (memcmp(&pRenderPoseArray[i], &_lastPoses[i], sizeof(vr::TrackedDevicePose_t)) != 0) {
+			_lastPoses[i] = pRenderPoseArray[i];
+			frame.ulChangedMask |= uint64_t(1) << i;
+			memcpy(_frameBuffer + unSize, &pRenderPoseArray[i], sizeof(vr::TrackedDevicePose_t));
+			unSize += sizeof(vr::TrackedDevicePose_t);
+		}
+	}
+	memcpy(_frameBuffer, &frame, sizeof(frame));
+	writeChunk(Chunk_Frame, _frameBuffer, unSize);
+
+	if (_nFrame % kFlushIntervalFrames == 0) {
+		_file.flush();
+	}
+	return eError;
+}
+
+//--------------------------------------------------------------
+vr::EVRCompositorError ofxOpenVRRecordingBackend::Submit(vr::EVREye eEye, const vr::Texture_t *pTexture, const vr::VRTextureBounds_t *pBounds, vr::EVRSubmitFlags nSubmitFlags) {
+	return _backend->Submit(eEye, pTexture, pBounds, nSubmitFlags);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRecordingBackend::FadeGrid(float fSeconds, bool bFadeIn) {
+	_backend->FadeGrid(fSeconds, bFadeIn);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRecordingBackend::ShowMirrorWindow() {
+	_backend->ShowMirrorWindow();
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRecordingBackend::HideMirrorWindow() {
+	_backend->HideMirrorWindow();
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRRecordingBackend::IsMirrorWindowVisible() {
+	return _backend->IsMirrorWindowVisible();
+}
+
+//--------------------------------------------------------------
+vr::EVRRenderModelError ofxOpenVRRecordingBackend::LoadRenderModel_Async(const char *pchRenderModelName, vr::RenderModel_t **ppRenderModel) {
+	return _backend->LoadRenderModel_Async(pchRenderModelName, ppRenderModel);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRecordingBackend::FreeRenderModel(vr::RenderModel_t *pRenderModel) {
+	_backend->FreeRenderModel(pRenderModel);
+}
+
+//--------------------------------------------------------------
+vr::EVRRenderModelError ofxOpenVRRecordingBackend::LoadTexture_Async(vr::TextureID_t textureId, vr::RenderModel_TextureMap_t **ppTexture) {
+	return _backend->LoadTexture_Async(textureId, ppTexture);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRecordingBackend::FreeTexture(vr::RenderModel_TextureMap_t *pTexture) {
+	_backend->FreeTexture(pTexture);
+}
+
+//--------------------------------------------------------------
+const char *ofxOpenVRRecordingBackend::GetRenderModelErrorNameFromEnum(vr::EVRRenderModelError error) {
+	return _backend->GetRenderModelErrorNameFromEnum(error);
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRRecordingBackend::HasTrackedCamera() {
+	return _backend->HasTrackedCamera();
+}
+
+//--------------------------------------------------------------
+// Purpose: Camera chunks must be written between chunks of the frame they belong to, so frames are polled on the render thread
+//--------------------------------------------------------------
+bool ofxOpenVRRecordingBackend::IsCameraThreadSafe() {
+	return false;
+}
+
+//--------------------------------------------------------------
+const char *ofxOpenVRRecordingBackend::GetCameraErrorNameFromEnum(vr::EVRTrackedCameraError eCameraError) {
+	return _backend->GetCameraErrorNameFromEnum(eCameraError);
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRRecordingBackend::HasCamera(vr::TrackedDeviceIndex_t nDeviceIndex, bool *pHasCamera) {
+	return _backend->HasCamera(nDeviceIndex, pHasCamera);
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRRecordingBackend::GetCameraFrameSize(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, uint32_t *pnWidth, uint32_t *pnHeight, uint32_t *pnFrameBufferSize) {
+	return _backend->GetCameraFrameSize(nDeviceIndex, eFrameType, pnWidth, pnHeight, pnFrameBufferSize);
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRRecordingBackend::GetCameraProjection(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, float flZNear, float flZFar, vr::HmdMatrix44_t *pProjection) {
+	return _backend->GetCameraProjection(nDeviceIndex, eFrameType, flZNear, flZFar, pProjection);
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRRecordingBackend::AcquireVideoStreamingService(vr::TrackedDeviceIndex_t nDeviceIndex, vr::TrackedCameraHandle_t *pHandle) {
+	return _backend->AcquireVideoStreamingService(nDeviceIndex, pHandle);
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRRecordingBackend::ReleaseVideoStreamingService(vr::TrackedCameraHandle_t hTrackedCamera) {
+	return _backend->ReleaseVideoStreamingService(hTrackedCamera);
+}
+
+//--------------------------------------------------------------
+// Purpose: Only headers are recorded, replay shows a test pattern instead of the images
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRRecordingBackend::GetVideoStreamFrameBuffer(vr::TrackedCameraHandle_t hTrackedCamera, vr::EVRTrackedCameraFrameType eFrameType, void *pFrameBuffer, uint32_t nFrameBufferSize, vr::CameraVideoStreamFrameHeader_t *pFrameHeader, uint32_t nFrameHeaderSize) {
+	vr::EVRTrackedCameraError eError = _backend->GetVideoStreamFrameBuffer(hTrackedCamera, eFrameType, pFrameBuffer, nFrameBufferSize, pFrameHeader, nFrameHeaderSize);
+	if (eError == vr::VRTrackedCameraError_None && pFrameHeader && nFrameHeaderSize >= sizeof(vr::CameraVideoStreamFrameHeader_t)) {
+		if (pFrameHeader->nFrameSequence != _nLastCameraSequence) {
+			_nLastCameraSequence = pFrameHeader->nFrameSequence;
+			writeChunk(Chunk_CameraFrame, pFrameHeader, sizeof(vr::CameraVideoStreamFrameHeader_t));
+		}
+	}
+	return eError;
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRRecordingBackend::GetVideoStreamTextureSize(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, vr::VRTextureBounds_t *pTextureBounds, uint32_t *pnWidth, uint32_t *pnHeight) {
+	return _backend->GetVideoStreamTextureSize(nDeviceIndex, eFrameType, pTextureBounds, pnWidth, pnHeight);
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRRecordingBackend::GetVideoStreamTextureGL(vr::TrackedCameraHandle_t hTrackedCamera, vr::EVRTrackedCameraFrameType eFrameType, vr::glUInt_t *pglTextureId, vr::CameraVideoStreamFrameHeader_t *pFrameHeader, uint32_t nFrameHeaderSize) {
+	vr::EVRTrackedCameraError eError = _backend->GetVideoStreamTextureGL(hTrackedCamera, eFrameType, pglTextureId, pFrameHeader, nFrameHeaderSize);
+	if (eError == vr::VRTrackedCameraError_None && pFrameHeader && nFrameHeaderSize >= sizeof(vr::CameraVideoStreamFrameHeader_t)) {
+		if (pFrameHeader->nFrameSequence != _nLastCameraSequence) {
+			_nLastCameraSequence = pFrameHeader->nFrameSequence;
+			writeChunk(Chunk_CameraFrame, pFrameHeader, sizeof(vr::CameraVideoStreamFrameHeader_t));
+		}
+	}
+	return eError;
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRRecordingBackend::ReleaseVideoStreamTextureGL(vr::TrackedCameraHandle_t hTrackedCamera, vr::glUInt_t glTextureId) {
+	return _backend->ReleaseVideoStreamTextureGL(hTrackedCamera, glTextureId);
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "ofxOpenVRBackend.h"
+
+/*
+	Session recorder: a backend which forwards all calls to another backend (normally SteamVR)
+	and writes what the runtime returned to a binary file. The file is replayed by ofxOpenVRReplayBackend
+	(see ofxOpenVRReplayBackend.h), which feeds the same data through ofxOpenVR::update() without runtime.
+
+	Recorded per frame: poses from WaitGetPoses, controller states, polled events and camera frame headers.
+	Device class, role and names are recorded at start and on device activation/role change events.
+
+	Usage:
+		auto recorder = std::make_shared<ofxOpenVRRecordingBackend>(std::make_shared<ofxOpenVRSteamVRBackend>(), "show.ovrsession");
+		openVR.setup(std::bind(&ofApp::render, this, std::placeholders::_1), recorder);
+		...
+		openVR.exit();	//closes the file
+
+	File format (all values little-endian, every record is 8-byte aligned, so the file may be mapped to memory and read in place):
+		ofxOpenVRSessionFile::Header
+		ofxOpenVRSessionFile::Chunk + payload, repeated till the end of file. Chunk::size is the payload size.
+	The file is append-only; a recording cut by a crash is valid up to the last complete chunk.
+	Poses are delta-encoded: a Frame chunk holds only poses which differ from the previous frame,
+	controller states are written only when their packet number changes.
+*/
+
+namespace ofxOpenVRSessionFile {
+	const char kMagic[8] = { 'O', 'F', 'X', 'O', 'V', 'R', 'S', 0 };
+	const uint32_t kVersion = 1;
+
+	enum ChunkType : uint32_t {
+		Chunk_Device = 1,			//DeviceRecord
+		Chunk_Frame = 2,			//FrameRecord, then TrackedDevicePose_t for each bit set in ulChangedMask
+		Chunk_ControllerState = 3,	//ControllerStateRecord
+		Chunk_Event = 4,			//vr::VREvent_t
+		Chunk_CameraFrame = 5		//vr::CameraVideoStreamFrameHeader_t
+	};
+
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t headerSize;		//sizeof(Header)
+		uint32_t renderWidth;		//GetRecommendedRenderTargetSize
+		uint32_t renderHeight;
+		uint32_t poseSize;			//sizeof(vr::TrackedDevicePose_t) etc. of the recording SDK,
+		uint32_t controllerStateSize;	//replay checks them to reject files of an incompatible openvr.h
+		uint32_t eventSize;
+		uint32_t cameraHeaderSize;
+	};
+
+	struct Chunk {
+		uint32_t type;
+		uint32_t size;
+	};
+
+	struct DeviceRecord {
+		uint32_t index;
+		uint32_t bConnected;
+		int32_t deviceClass;
+		int32_t role;
+		char serialNumber[64];
+		char renderModelName[128];
+		char trackingSystemName[32];
+		char modelNumber[64];
+	};
+
+	struct FrameRecord {
+		uint64_t nFrame;
+		double dTime;				//seconds since Init()
+		uint64_t ulChangedMask;		//bit i - pose of device i follows
+	};
+
+	struct ControllerStateRecord {
+		uint32_t index;
+		uint32_t reserved;
+		vr::VRControllerState_t state;
+	};
+
+	inline uint32_t alignedSize(uint32_t size) { return (size + 7) & ~7u; }
+}
+
+//--------------------------------------------------------------
+class ofxOpenVRRecordingBackend : public ofxOpenVRBackend {
+public:
+	//fileName is relative to bin/data, the file is created in Init()
+	ofxOpenVRRecordingBackend(std::shared_ptr<ofxOpenVRBackend> backend, const std::string &fileName);
+	~ofxOpenVRRecordingBackend();
+
+	void close();	//stops recording, called by Shutdown()
+	bool isRecording() const { return _file.is_open(); }
+	uint64_t getFrameCount() const { return _nFrame; }
+	uint64_t getBytesWritten() const { return _nBytesWritten; }
+
+	vr::EVRInitError Init() override;
+	void Shutdown() override;
+	const char *GetInitErrorDescription(vr::EVRInitError eError) override;
+
+	void GetRecommendedRenderTargetSize(uint32_t *pnWidth, uint32_t *pnHeight) override;
+	vr::HmdMatrix44_t GetProjectionMatrix(vr::EVREye eEye, float fNearZ, float fFarZ) override;
+	vr::HmdMatrix34_t GetEyeToHeadTransform(vr::EVREye eEye) override;
+	bool ComputeDistortion(vr::EVREye eEye, float fU, float fV, vr::DistortionCoordinates_t *pDistortionCoordinates) override;
+	vr::HiddenAreaMesh_t GetHiddenAreaMesh(vr::EVREye eEye, vr::EHiddenAreaMeshType type = vr::k_eHiddenAreaMesh_Standard) override;
+
+	vr::ETrackedDeviceClass GetTrackedDeviceClass(vr::TrackedDeviceIndex_t unDeviceIndex) override;
+	vr::ETrackedControllerRole GetControllerRoleForTrackedDeviceIndex(vr::TrackedDeviceIndex_t unDeviceIndex) override;
+	bool IsTrackedDeviceConnected(vr::TrackedDeviceIndex_t unDeviceIndex) override;
+	uint32_t GetStringTrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, char *pchValue, uint32_t unBufferSize, vr::ETrackedPropertyError *pError = 0L) override;
+	vr::HmdMatrix34_t GetMatrix34TrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, vr::ETrackedPropertyError *pError = 0L) override;
+	bool GetControllerState(vr::TrackedDeviceIndex_t unControllerDeviceIndex, vr::VRControllerState_t *pControllerState, uint32_t unControllerStateSize) override;
+	bool PollNextEvent(vr::VREvent_t *pEvent, uint32_t uncbVREvent) override;
+
+	bool HasCompositor() override;
+	vr::EVRCompositorError WaitGetPoses(vr::TrackedDevicePose_t *pRenderPoseArray, uint32_t unRenderPoseArrayCount, vr::TrackedDevicePose_t *pGamePoseArray, uint32_t unGamePoseArrayCount) override;
+	vr::EVRCompositorError Submit(vr::EVREye eEye, const vr::Texture_t *pTexture, const vr::VRTextureBounds_t *pBounds = 0, vr::EVRSubmitFlags nSubmitFlags = vr::Submit_Default) override;
+	void FadeGrid(float fSeconds, bool bFadeIn) override;
+	void ShowMirrorWindow() override;
+	void HideMirrorWindow() override;
+	bool IsMirrorWindowVisible() override;
+
+	vr::EVRRenderModelError LoadRenderModel_Async(const char *pchRenderModelName, vr::RenderModel_t **ppRenderModel) override;
+	void FreeRenderModel(vr::RenderModel_t *pRenderModel) override;
+	vr::EVRRenderModelError LoadTexture_Async(vr::TextureID_t textureId, vr::RenderModel_TextureMap_t **ppTexture) override;
+	void FreeTexture(vr::RenderModel_TextureMap_t *pTexture) override;
+	const char *GetRenderModelErrorNameFromEnum(vr::EVRRenderModelError error) override;
+
+	bool HasTrackedCamera() override;
+	bool IsCameraThreadSafe() override;
+	const char *GetCameraErrorNameFromEnum(vr::EVRTrackedCameraError eCameraError) override;
+	vr::EVRTrackedCameraError HasCamera(vr::TrackedDeviceIndex_t nDeviceIndex, bool *pHasCamera) override;
+	vr::EVRTrackedCameraError GetCameraFrameSize(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, uint32_t *pnWidth, uint32_t *pnHeight, uint32_t *pnFrameBufferSize) override;
+	vr::EVRTrackedCameraError GetCameraProjection(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, float flZNear, float flZFar, vr::HmdMatrix44_t *pProjection) override;
+	vr::EVRTrackedCameraError AcquireVideoStreamingService(vr::TrackedDeviceIndex_t nDeviceIndex, vr::TrackedCameraHandle_t *pHandle) override;
+	vr::EVRTrackedCameraError ReleaseVideoStreamingService(vr::TrackedCameraHandle_t hTrackedCamera) override;
+	vr::EVRTrackedCameraError GetVideoStreamFrameBuffer(vr::TrackedCameraHandle_t hTrackedCamera, vr::EVRTrackedCameraFrameType eFrameType, void *pFrameBuffer, uint32_t nFrameBufferSize, vr::CameraVideoStreamFrameHeader_t *pFrameHeader, uint32_t nFrameHeaderSize) override;
+	vr::EVRTrackedCameraError GetVideoStreamTextureSize(vr::TrackedDeviceIndex_t nDeviceIndex, vr::EVRTrackedCameraFrameType eFrameType, vr::VRTextureBounds_t *pTextureBounds, uint32_t *pnWidth, uint32_t *pnHeight) override;
+	vr::EVRTrackedCameraError GetVideoStreamTextureGL(vr::TrackedCameraHandle_t hTrackedCamera, vr::EVRTrackedCameraFrameType eFrameType, vr::glUInt_t *pglTextureId, vr::CameraVideoStreamFrameHeader_t *pFrameHeader, uint32_t nFrameHeaderSize) override;
+	vr::EVRTrackedCameraError ReleaseVideoStreamTextureGL(vr::TrackedCameraHandle_t hTrackedCamera, vr::glUInt_t glTextureId) override;
+
+protected:
+	std::shared_ptr<ofxOpenVRBackend> _backend;
+	std::string _fileName;
+	std::ofstream _file;
+	uint64_t _nBytesWritten;
+	uint64_t _nFrame;
+	uint64_t _nStartTimeMicros;
+
+	//Last written values, for delta encoding
+	vr::TrackedDevicePose_t _lastPoses[vr::k_unMaxTrackedDeviceCount];
+	uint32_t _lastPacketNum[vr::k_unMaxTrackedDeviceCount];
+	bool _bLastStateValid[vr::k_unMaxTrackedDeviceCount];
+	ofxOpenVRSessionFile::DeviceRecord _lastDevices[vr::k_unMaxTrackedDeviceCount];
+	uint32_t _nLastCameraSequence;
+
+	uint8_t _frameBuffer[sizeof(ofxOpenVRSessionFile::FrameRecord) + vr::k_unMaxTrackedDeviceCount * sizeof(vr::TrackedDevicePose_t)];
+
+	void writeChunk(uint32_t type, const void *pData, uint32_t size);
+	void writeDevices();	//writes devices whose class, role or names changed
+};
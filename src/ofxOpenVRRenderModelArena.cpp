@@ -0,0 +1,117 @@
+#include "ofxOpenVRRenderModelArena.h"
+#include "ofxOpenVRGpuMemory.h"
+
+//--------------------------------------------------------------
+ofxOpenVRRenderModelArena::ofxOpenVRRenderModelArena() {
+	_glVertArray = 0;
+	_glVertBuffer = 0;
+	_glIndexBuffer = 0;
+	_unVertexCount = 0;
+	_unVertexCapacity = 0;
+	_unIndexCount = 0;
+	_unIndexCapacity = 0;
+}
+
+//--------------------------------------------------------------
+ofxOpenVRRenderModelArena::~ofxOpenVRRenderModelArena() {
+	clear();
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRenderModelArena::clear() {
+	if (_glVertArray) {
+		ofxOpenVRGpuMemory::untrack(ofxOpenVRGpuMemory::Object::VertexArray, _glVertArray);
+		ofxOpenVRGpuMemory::untrack(ofxOpenVRGpuMemory::Object::Buffer, _glVertBuffer);
+		ofxOpenVRGpuMemory::untrack(ofxOpenVRGpuMemory::Object::Buffer, _glIndexBuffer);
+		glDeleteVertexArrays(1, &_glVertArray);
+		glDeleteBuffers(1, &_glVertBuffer);
+		glDeleteBuffers(1, &_glIndexBuffer);
+	}
+	_glVertArray = 0;
+	_glVertBuffer = 0;
+	_glIndexBuffer = 0;
+	_unVertexCount = 0;
+	_unVertexCapacity = 0;
+	_unIndexCount = 0;
+	_unIndexCapacity = 0;
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRRenderModelArena::add(const vr::RenderModel_Vertex_t *pVertices, uint32_t unVertexCount, const uint16_t *pIndices, uint32_t unIndexCount, GLint &nBaseVertex, GLuint &unFirstIndex) {
+	if (unVertexCount == 0 || unIndexCount == 0) return false;
+	if (uint64_t(_unVertexCount) + unVertexCount > INT32_MAX || uint64_t(_unIndexCount) + unIndexCount > INT32_MAX) return false;
+
+	reserve(_unVertexCount + unVertexCount, _unIndexCount + unIndexCount);
+
+	glBindBuffer(GL_ARRAY_BUFFER, _glVertBuffer);
+	glBufferSubData(GL_ARRAY_BUFFER, sizeof(vr::RenderModel_Vertex_t) * _unVertexCount, sizeof(vr::RenderModel_Vertex_t) * unVertexCount, pVertices);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, _glIndexBuffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(uint16_t) * _unIndexCount, sizeof(uint16_t) * unIndexCount, pIndices);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	nBaseVertex = GLint(_unVertexCount);
+	unFirstIndex = _unIndexCount;
+	_unVertexCount += unVertexCount;
+	_unIndexCount += unIndexCount;
+	return true;
+}
+
+//--------------------------------------------------------------
+// Purpose: Creates the buffers on first use and grows them by doubling,
+// the VAO is pointed to the new buffers
+//--------------------------------------------------------------
+void ofxOpenVRRenderModelArena::reserve(uint32_t unVertexCount, uint32_t unIndexCount) {
+	if (unVertexCount <= _unVertexCapacity && unIndexCount <= _unIndexCapacity) return;
+
+	uint32_t unVertexCapacity = std::max(_unVertexCapacity, kInitialVertexCapacity);
+	while (unVertexCapacity < unVertexCount) unVertexCapacity *= 2;
+	uint32_t unIndexCapacity = std::max(_unIndexCapacity, kInitialIndexCapacity);
+	while (unIndexCapacity < unIndexCount) unIndexCapacity *= 2;
+
+	if (unVertexCapacity != _unVertexCapacity) {
+		_glVertBuffer = growBuffer(_glVertBuffer, sizeof(vr::RenderModel_Vertex_t) * _unVertexCount, sizeof(vr::RenderModel_Vertex_t) * unVertexCapacity);
+		_unVertexCapacity = unVertexCapacity;
+		ofxOpenVRGpuMemory::track(ofxOpenVRGpuMemory::Object::Buffer, _glVertBuffer, ofxOpenVRGpuCategory::RenderModels, sizeof(vr::RenderModel_Vertex_t) * unVertexCapacity, "render model vertices");
+	}
+	if (unIndexCapacity != _unIndexCapacity) {
+		_glIndexBuffer = growBuffer(_glIndexBuffer, sizeof(uint16_t) * _unIndexCount, sizeof(uint16_t) * unIndexCapacity);
+		_unIndexCapacity = unIndexCapacity;
+		ofxOpenVRGpuMemory::track(ofxOpenVRGpuMemory::Object::Buffer, _glIndexBuffer, ofxOpenVRGpuCategory::RenderModels, sizeof(uint16_t) * unIndexCapacity, "render model indices");
+	}
+
+	if (!_glVertArray) {
+		glGenVertexArrays(1, &_glVertArray);
+		ofxOpenVRGpuMemory::track(ofxOpenVRGpuMemory::Object::VertexArray, _glVertArray, ofxOpenVRGpuCategory::RenderModels, 0, "render model arena");
+	}
+	glBindVertexArray(_glVertArray);
+	glBindBuffer(GL_ARRAY_BUFFER, _glVertBuffer);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(vr::RenderModel_Vertex_t), (void *)offsetof(vr::RenderModel_Vertex_t, vPosition));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(vr::RenderModel_Vertex_t), (void *)offsetof(vr::RenderModel_Vertex_t, vNormal));
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(vr::RenderModel_Vertex_t), (void *)offsetof(vr::RenderModel_Vertex_t, rfTextureCoord));
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _glIndexBuffer);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+//--------------------------------------------------------------
+GLuint ofxOpenVRRenderModelArena::growBuffer(GLuint glBuffer, size_t usedSize, size_t newSize) {
+	GLuint glNewBuffer;
+	glGenBuffers(1, &glNewBuffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, glNewBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, newSize, nullptr, GL_STATIC_DRAW);
+	if (glBuffer) {
+		if (usedSize > 0) {
+			glBindBuffer(GL_COPY_READ_BUFFER, glBuffer);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, usedSize);
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		}
+		ofxOpenVRGpuMemory::untrack(ofxOpenVRGpuMemory::Object::Buffer, glBuffer);
+		glDeleteBuffers(1, &glBuffer);
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	return glNewBuffer;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "ofMain.h"
+#include <openvr.h>
+
+/*
+	Shared vertex and index buffers of all render models, with one VAO.
+
+	Each model takes a range of the buffers: add() appends its vertices and indices and returns
+	the base vertex and the first index, so its 16-bit indices stay local to the model and it is drawn
+	with glDraw*BaseVertex. The buffers grow by doubling, old contents are copied on the GPU.
+	Ranges are not reused, the arena is freed as a whole by clear().
+
+	ofxOpenVRRenderModels owns the arena, so all devices are drawn with a single VAO bind.
+*/
+
+//--------------------------------------------------------------
+class ofxOpenVRRenderModelArena {
+public:
+	ofxOpenVRRenderModelArena();
+	~ofxOpenVRRenderModelArena();
+
+	//Appends a model, call with GL context
+	bool add(const vr::RenderModel_Vertex_t *pVertices, uint32_t unVertexCount, const uint16_t *pIndices, uint32_t unIndexCount, GLint &nBaseVertex, GLuint &unFirstIndex);
+	void clear();	//frees the buffers, call with GL context
+
+	GLuint getVertexArray() const { return _glVertArray; }
+	uint32_t getVertexCount() const { return _unVertexCount; }
+	uint32_t getIndexCount() const { return _unIndexCount; }
+
+protected:
+	static const uint32_t kInitialVertexCapacity = 32768;	//1 MB
+	static const uint32_t kInitialIndexCapacity = 98304;	//192 KB
+
+	GLuint _glVertArray;
+	GLuint _glVertBuffer;
+	GLuint _glIndexBuffer;
+	uint32_t _unVertexCount;
+	uint32_t _unVertexCapacity;
+	uint32_t _unIndexCount;
+	uint32_t _unIndexCapacity;
+
+	void reserve(uint32_t unVertexCount, uint32_t unIndexCount);
+	static GLuint growBuffer(GLuint glBuffer, size_t usedSize, size_t newSize);
+};
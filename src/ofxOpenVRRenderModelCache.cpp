@@ -0,0 +1,428 @@
+#include "ofxOpenVRRenderModelCache.h"
+#include <climits>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	const char kMagic[8] = { 'O', 'F', 'X', 'V', 'R', 'R', 'M', '\0' };
+	const uint32_t kFormatVersion = 1;
+	const uint32_t kMaxLevels = 16;
+	const uint32_t kFormatRGBA8 = 0;
+	const uint32_t kFormatBC1 = 1;
+	const uint64_t kAlignment = 16;
+
+	struct FileLevel {
+		uint64_t ulOffset;
+		uint32_t unSize;
+		uint32_t unWidth;
+		uint32_t unHeight;
+		uint32_t unReserved;
+	};
+
+	struct FileHeader {
+		char magic[8];
+		uint32_t unFormatVersion;
+		uint32_t unTextureFormat;
+		char runtimeVersion[64];
+		char name[128];
+		uint64_t ulVertexOffset;
+		uint32_t unVertexCount;
+		uint32_t unVertexSize;
+		uint64_t ulIndexOffset;
+		uint32_t unIndexCount;
+		uint32_t unLevelCount;
+		uint64_t ulFileSize;
+		FileLevel levels[kMaxLevels];
+	};
+	static_assert(sizeof(FileHeader) == 632, "render model cache header layout changed, increase kFormatVersion");
+
+	//--------------------------------------------------------------
+	uint64_t align(uint64_t ulOffset) {
+		return (ulOffset + kAlignment - 1) / kAlignment * kAlignment;
+	}
+
+	//--------------------------------------------------------------
+	uint32_t getLevelSize(uint32_t unFormat, uint32_t unWidth, uint32_t unHeight) {
+		if (unFormat == kFormatBC1) {
+			return std::max(1u, (unWidth + 3) / 4) * std::max(1u, (unHeight + 3) / 4) * 8;
+		}
+		return unWidth * unHeight * 4;
+	}
+
+	//--------------------------------------------------------------
+	// Purpose: Next mip level by averaging 2x2 texels, odd sizes repeat the last row or column
+	//--------------------------------------------------------------
+	void downsample(const std::vector<uint8_t> &src, uint32_t unWidth, uint32_t unHeight, std::vector<uint8_t> &dst) {
+		uint32_t unDstWidth = std::max(1u, unWidth / 2);
+		uint32_t unDstHeight = std::max(1u, unHeight / 2);
+		dst.resize(size_t(unDstWidth) * unDstHeight * 4);
+		for (uint32_t y = 0; y < unDstHeight; y++) {
+			uint32_t y0 = std::min(y * 2, unHeight - 1);
+			uint32_t y1 = std::min(y * 2 + 1, unHeight - 1);
+			for (uint32_t x = 0; x < unDstWidth; x++) {
+				uint32_t x0 = std::min(x * 2, unWidth - 1);
+				uint32_t x1 = std::min(x * 2 + 1, unWidth - 1);
+				for (int c = 0; c < 4; c++) {
+					uint32_t sum = src[(size_t(y0) * unWidth + x0) * 4 + c] + src[(size_t(y0) * unWidth + x1) * 4 + c]
+						+ src[(size_t(y1) * unWidth + x0) * 4 + c] + src[(size_t(y1) * unWidth + x1) * 4 + c];
+					dst[(size_t(y) * unDstWidth + x) * 4 + c] = uint8_t((sum + 2) / 4);
+				}
+			}
+		}
+	}
+
+	//--------------------------------------------------------------
+	uint16_t toRGB565(int r, int g, int b) {
+		return uint16_t(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+	}
+
+	//--------------------------------------------------------------
+	void fromRGB565(uint16_t c, int *rgb) {
+		rgb[0] = ((c >> 11) & 31) * 255 / 31;
+		rgb[1] = ((c >> 5) & 63) * 255 / 63;
+		rgb[2] = (c & 31) * 255 / 31;
+	}
+
+	//--------------------------------------------------------------
+	// Purpose: BC1 block with the bounding box corners of the 16 colors as endpoints,
+	// each texel takes the nearest of the 4 palette colors
+	//--------------------------------------------------------------
+	void encodeBC1Block(const uint8_t *pBlock, uint8_t *pOut) {
+		int min[3] = { 255, 255, 255 };
+		int max[3] = { 0, 0, 0 };
+		for (int i = 0; i < 16; i++) {
+			for (int c = 0; c < 3; c++) {
+				min[c] = std::min(min[c], int(pBlock[i * 4 + c]));
+				max[c] = std::max(max[c], int(pBlock[i * 4 + c]));
+			}
+		}
+		uint16_t c0 = toRGB565(max[0], max[1], max[2]);
+		uint16_t c1 = toRGB565(min[0], min[1], min[2]);
+		if (c0 < c1) std::swap(c0, c1);
+
+		int palette[4][3];
+		fromRGB565(c0, palette[0]);
+		fromRGB565(c1, palette[1]);
+		for (int c = 0; c < 3; c++) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		uint32_t unIndices = 0;
+		if (c0 != c1) {	//equal endpoints select the 3-color mode, where index 0 is the color anyway
+			for (int i = 0; i < 16; i++) {
+				int iBest = 0;
+				int nBestDistance = INT_MAX;
+				for (int p = 0; p < 4; p++) {
+					int dr = pBlock[i * 4] - palette[p][0];
+					int dg = pBlock[i * 4 + 1] - palette[p][1];
+					int db = pBlock[i * 4 + 2] - palette[p][2];
+					int nDistance = dr * dr + dg * dg + db * db;
+					if (nDistance < nBestDistance) {
+						nBestDistance = nDistance;
+						iBest = p;
+					}
+				}
+				unIndices |= uint32_t(iBest) << (i * 2);
+			}
+		}
+
+		pOut[0] = uint8_t(c0 & 0xFF);
+		pOut[1] = uint8_t(c0 >> 8);
+		pOut[2] = uint8_t(c1 & 0xFF);
+		pOut[3] = uint8_t(c1 >> 8);
+		for (int i = 0; i < 4; i++) {
+			pOut[4 + i] = uint8_t(unIndices >> (i * 8));
+		}
+	}
+
+	//--------------------------------------------------------------
+	void encodeBC1(const std::vector<uint8_t> &rgba, uint32_t unWidth, uint32_t unHeight, std::vector<uint8_t> &out) {
+		uint32_t unBlocksX = std::max(1u, (unWidth + 3) / 4);
+		uint32_t unBlocksY = std::max(1u, (unHeight + 3) / 4);
+		out.resize(size_t(unBlocksX) * unBlocksY * 8);
+		uint8_t block[16 * 4];
+		for (uint32_t by = 0; by < unBlocksY; by++) {
+			for (uint32_t bx = 0; bx < unBlocksX; bx++) {
+				for (uint32_t i = 0; i < 16; i++) {
+					uint32_t x = std::min(bx * 4 + i % 4, unWidth - 1);
+					uint32_t y = std::min(by * 4 + i / 4, unHeight - 1);
+					memcpy(block + i * 4, &rgba[(size_t(y) * unWidth + x) * 4], 4);
+				}
+				encodeBC1Block(block, &out[(size_t(by) * unBlocksX + bx) * 8]);
+			}
+		}
+	}
+
+	//--------------------------------------------------------------
+	bool isOpaque(const std::vector<uint8_t> &rgba) {
+		for (size_t i = 3; i < rgba.size(); i += 4) {
+			if (rgba[i] != 255) return false;
+		}
+		return true;
+	}
+}
+
+//--------------------------------------------------------------
+ofxOpenVRCachedRenderModel::~ofxOpenVRCachedRenderModel() {
+#ifdef _WIN32
+	if (_pMapping) UnmapViewOfFile(_pMapping);
+	if (_hMapping) CloseHandle(_hMapping);
+	if (_hFile) CloseHandle(_hFile);
+#else
+	if (_pMapping) munmap((void *)_pMapping, _size);
+	if (_fd >= 0) close(_fd);
+#endif
+}
+
+//--------------------------------------------------------------
+ofxOpenVRRenderModelCache::ofxOpenVRRenderModelCache() {
+}
+
+//--------------------------------------------------------------
+ofxOpenVRRenderModelCache::~ofxOpenVRRenderModelCache() {
+	waitForWrites();
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRenderModelCache::setup(const std::string &sDirectory, const std::string &sRuntimeVersion) {
+	waitForWrites();
+	_sDirectory = sDirectory;
+	_sRuntimeVersion = sRuntimeVersion.substr(0, sizeof(FileHeader::runtimeVersion) - 1);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRenderModelCache::waitForWrites() {
+	{
+		std::lock_guard<std::mutex> lock(_writeMutex);
+		_bWriterExit = true;
+	}
+	_writeCondition.notify_all();
+	if (_writer.joinable()) {
+		_writer.join();
+	}
+	_bWriterExit = false;
+}
+
+//--------------------------------------------------------------
+// Purpose: Model names contain characters like '{', '}' and '/', they are replaced,
+// the name in the header tells models with the same file name apart
+//--------------------------------------------------------------
+std::string ofxOpenVRRenderModelCache::getPath(const std::string &sName) const {
+	std::string sFileName = sName;
+	for (char &c : sFileName) {
+		if (!isalnum((unsigned char)c) && c != '_' && c != '-' && c != '.') c = '_';
+	}
+	return _sDirectory + "/" + sFileName + ".vrmodel";
+}
+
+//--------------------------------------------------------------
+std::unique_ptr<ofxOpenVRCachedRenderModel> ofxOpenVRRenderModelCache::open(const std::string &sName) const {
+	if (!isEnabled() || sName.size() >= sizeof(FileHeader::name)) return nullptr;
+	std::string sPath = getPath(sName);
+
+	std::unique_ptr<ofxOpenVRCachedRenderModel> model(new ofxOpenVRCachedRenderModel());
+#ifdef _WIN32
+	HANDLE hFile = CreateFileA(sPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE) return nullptr;
+	model->_hFile = hFile;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart < LONGLONG(sizeof(FileHeader))) return nullptr;
+	model->_size = size_t(fileSize.QuadPart);
+	model->_hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!model->_hMapping) return nullptr;
+	model->_pMapping = (const uint8_t *)MapViewOfFile(model->_hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (!model->_pMapping) return nullptr;
+#else
+	model->_fd = ::open(sPath.c_str(), O_RDONLY);
+	if (model->_fd < 0) return nullptr;
+	struct stat fileStat;
+	if (fstat(model->_fd, &fileStat) != 0 || fileStat.st_size < off_t(sizeof(FileHeader))) return nullptr;
+	model->_size = size_t(fileStat.st_size);
+	void *pMapping = mmap(nullptr, model->_size, PROT_READ, MAP_PRIVATE, model->_fd, 0);
+	if (pMapping == MAP_FAILED) return nullptr;
+	model->_pMapping = (const uint8_t *)pMapping;
+#endif
+
+	// Everything is checked before use, a broken or foreign file is treated as missing
+	FileHeader header;
+	memcpy(&header, model->_pMapping, sizeof(header));
+	header.runtimeVersion[sizeof(header.runtimeVersion) - 1] = '\0';
+	header.name[sizeof(header.name) - 1] = '\0';
+	if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.unFormatVersion != kFormatVersion
+		|| _sRuntimeVersion != header.runtimeVersion || sName != header.name || header.ulFileSize != model->_size) {
+		return nullptr;
+	}
+	if (header.unVertexSize != sizeof(vr::RenderModel_Vertex_t) || header.unIndexCount % 3 != 0
+		|| header.unLevelCount == 0 || header.unLevelCount > kMaxLevels
+		|| (header.unTextureFormat != kFormatRGBA8 && header.unTextureFormat != kFormatBC1)) {
+		return nullptr;
+	}
+	auto fits = [&](uint64_t ulOffset, uint64_t ulSize) {
+		return ulOffset % kAlignment == 0 && ulOffset <= model->_size && ulSize <= model->_size - ulOffset;
+	};
+	if (!fits(header.ulVertexOffset, uint64_t(header.unVertexCount) * header.unVertexSize)
+		|| !fits(header.ulIndexOffset, uint64_t(header.unIndexCount) * sizeof(uint16_t))) {
+		return nullptr;
+	}
+	for (uint32_t i = 0; i < header.unLevelCount; i++) {
+		const FileLevel &level = header.levels[i];
+		if (level.unWidth == 0 || level.unHeight == 0 || level.unSize != getLevelSize(header.unTextureFormat, level.unWidth, level.unHeight)
+			|| !fits(level.ulOffset, level.unSize)) {
+			return nullptr;
+		}
+		ofxOpenVRCachedRenderModel::Level view;
+		view.pData = model->_pMapping + level.ulOffset;
+		view.unSize = level.unSize;
+		view.unWidth = level.unWidth;
+		view.unHeight = level.unHeight;
+		model->levels.push_back(view);
+	}
+
+	model->pVertices = (const vr::RenderModel_Vertex_t *)(model->_pMapping + header.ulVertexOffset);
+	model->unVertexCount = header.unVertexCount;
+	model->pIndices = (const uint16_t *)(model->_pMapping + header.ulIndexOffset);
+	model->unIndexCount = header.unIndexCount;
+	model->bCompressed = (header.unTextureFormat == kFormatBC1);
+	return model;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRenderModelCache::write(const std::string &sName, const vr::RenderModel_t &model, const vr::RenderModel_TextureMap_t &texture, bool bCompress) {
+	if (!isEnabled() || sName.size() >= sizeof(FileHeader::name)) return;
+
+	// The runtime frees its data after the upload, so the writer gets a copy
+	std::shared_ptr<WriteJob> job = std::make_shared<WriteJob>();
+	job->sName = sName;
+	job->vertices.assign(model.rVertexData, model.rVertexData + model.unVertexCount);
+	job->indices.assign(model.rIndexData, model.rIndexData + model.unTriangleCount * 3);
+	job->unTextureWidth = texture.unWidth;
+	job->unTextureHeight = texture.unHeight;
+	job->texture.assign(texture.rubTextureMapData, texture.rubTextureMapData + size_t(texture.unWidth) * texture.unHeight * 4);
+	job->bCompress = bCompress;
+
+	{
+		std::lock_guard<std::mutex> lock(_writeMutex);
+		_writeJobs.push_back(job);
+		if (!_writer.joinable()) {
+			_writer = std::thread(&ofxOpenVRRenderModelCache::writerLoop, this);
+		}
+	}
+	_writeCondition.notify_one();
+}
+
+//--------------------------------------------------------------
+// Purpose: Writes queued files one by one, returns when asked by waitForWrites() and the queue is empty
+//--------------------------------------------------------------
+void ofxOpenVRRenderModelCache::writerLoop() {
+	while (true) {
+		std::shared_ptr<WriteJob> job;
+		{
+			std::unique_lock<std::mutex> lock(_writeMutex);
+			_writeCondition.wait(lock, [this]() { return !_writeJobs.empty() || _bWriterExit; });
+			if (_writeJobs.empty()) return;
+			job = _writeJobs.front();
+			_writeJobs.pop_front();
+		}
+		writeFile(*job);
+	}
+}
+
+//--------------------------------------------------------------
+// Purpose: Builds the mip chain, compresses it if asked, and writes the file
+// to a temporary name first, so a file interrupted on the way is never read
+//--------------------------------------------------------------
+void ofxOpenVRRenderModelCache::writeFile(const WriteJob &job) const {
+	if (job.unTextureWidth == 0 || job.unTextureHeight == 0) return;
+
+	FileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.unFormatVersion = kFormatVersion;
+	header.unTextureFormat = (job.bCompress && isOpaque(job.texture)) ? kFormatBC1 : kFormatRGBA8;
+	strncpy(header.runtimeVersion, _sRuntimeVersion.c_str(), sizeof(header.runtimeVersion) - 1);
+	strncpy(header.name, job.sName.c_str(), sizeof(header.name) - 1);
+
+	// Mip chain down to 1x1
+	std::vector<std::vector<uint8_t>> levels;
+	std::vector<uint8_t> rgba = job.texture;
+	uint32_t unWidth = job.unTextureWidth;
+	uint32_t unHeight = job.unTextureHeight;
+	while (header.unLevelCount < kMaxLevels) {
+		FileLevel &level = header.levels[header.unLevelCount++];
+		level.unWidth = unWidth;
+		level.unHeight = unHeight;
+		levels.emplace_back();
+		if (header.unTextureFormat == kFormatBC1) {
+			encodeBC1(rgba, unWidth, unHeight, levels.back());
+		}
+		else {
+			levels.back() = rgba;
+		}
+		level.unSize = uint32_t(levels.back().size());
+
+		if (unWidth == 1 && unHeight == 1) break;
+		std::vector<uint8_t> next;
+		downsample(rgba, unWidth, unHeight, next);
+		rgba.swap(next);
+		unWidth = std::max(1u, unWidth / 2);
+		unHeight = std::max(1u, unHeight / 2);
+	}
+
+	// Layout
+	uint64_t ulOffset = align(sizeof(FileHeader));
+	header.ulVertexOffset = ulOffset;
+	header.unVertexCount = uint32_t(job.vertices.size());
+	header.unVertexSize = sizeof(vr::RenderModel_Vertex_t);
+	ulOffset = align(ulOffset + job.vertices.size() * sizeof(vr::RenderModel_Vertex_t));
+	header.ulIndexOffset = ulOffset;
+	header.unIndexCount = uint32_t(job.indices.size());
+	ulOffset = align(ulOffset + job.indices.size() * sizeof(uint16_t));
+	for (uint32_t i = 0; i < header.unLevelCount; i++) {
+		header.levels[i].ulOffset = ulOffset;
+		ulOffset = align(ulOffset + header.levels[i].unSize);
+	}
+	header.ulFileSize = ulOffset;
+
+	ofDirectory::createDirectory(_sDirectory, false, true);
+	std::string sPath = getPath(job.sName);
+	std::string sTempPath = sPath + ".tmp";
+	{
+		std::ofstream file(sTempPath, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			ofLogError("ofxOpenVR") << "Unable to write render model cache " << sTempPath;
+			return;
+		}
+		auto writeAt = [&file](uint64_t ulAt, const void *pData, size_t size) {
+			static const char padding[kAlignment] = {};
+			uint64_t ulPosition = uint64_t(file.tellp());
+			if (ulAt > ulPosition) file.write(padding, std::streamsize(ulAt - ulPosition));
+			file.write((const char *)pData, std::streamsize(size));
+		};
+		writeAt(0, &header, sizeof(header));
+		writeAt(header.ulVertexOffset, job.vertices.data(), job.vertices.size() * sizeof(vr::RenderModel_Vertex_t));
+		writeAt(header.ulIndexOffset, job.indices.data(), job.indices.size() * sizeof(uint16_t));
+		for (uint32_t i = 0; i < header.unLevelCount; i++) {
+			writeAt(header.levels[i].ulOffset, levels[i].data(), levels[i].size());
+		}
+		writeAt(header.ulFileSize, nullptr, 0);
+		if (!file) {
+			ofLogError("ofxOpenVR") << "Unable to write render model cache " << sTempPath;
+			file.close();
+			std::remove(sTempPath.c_str());
+			return;
+		}
+	}
+	std::remove(sPath.c_str());	//rename() doesn't replace files on Windows
+	if (std::rename(sTempPath.c_str(), sPath.c_str()) != 0) {
+		ofLogError("ofxOpenVR") << "Unable to write render model cache " << sPath;
+		std::remove(sTempPath.c_str());
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "ofxOpenVRBackend.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+/*
+	On-disk cache of render models, so warm starts don't call IVRRenderModels at all.
+
+	One file per model, named after the model and checked against the model name and runtime version
+	stored in its header, so files of another runtime version are ignored and rewritten.
+	The file holds data in the layout GL takes, each block aligned to 16 bytes:
+		header | interleaved vr::RenderModel_Vertex_t | uint16_t indices | texture mip levels 0..n-1
+	Mip levels are built on the CPU when the file is written, so no glGenerateMipmap is needed at load.
+	When asked to compress, opaque textures are stored as BC1 (DXT1), 8 times smaller than RGBA8.
+
+	open() maps the file into memory, the views of ofxOpenVRCachedRenderModel point into the mapping
+	and are valid while the object lives. write() copies the model and queues the file for a single writer thread,
+	which runs while there are files to write.
+
+	ofxOpenVRRenderModels uses it, the directory is set with:
+		openVR.getRenderModels().setCacheDirectory("renderModels");	//"" disables the cache
+		openVR.getRenderModels().compressTextures = true;
+*/
+
+//--------------------------------------------------------------
+class ofxOpenVRCachedRenderModel {
+public:
+	struct Level {
+		const uint8_t *pData = nullptr;
+		uint32_t unSize = 0;
+		uint32_t unWidth = 0;
+		uint32_t unHeight = 0;
+	};
+
+	~ofxOpenVRCachedRenderModel();
+
+	const vr::RenderModel_Vertex_t *pVertices = nullptr;
+	uint32_t unVertexCount = 0;
+	const uint16_t *pIndices = nullptr;
+	uint32_t unIndexCount = 0;
+	bool bCompressed = false;	//BC1 levels, otherwise RGBA8
+	std::vector<Level> levels;	//level 0 is the full size texture
+
+protected:
+	friend class ofxOpenVRRenderModelCache;
+	ofxOpenVRCachedRenderModel() {}
+
+	const uint8_t *_pMapping = nullptr;
+	size_t _size = 0;
+#ifdef _WIN32
+	void *_hFile = nullptr;
+	void *_hMapping = nullptr;
+#else
+	int _fd = -1;
+#endif
+};
+
+//--------------------------------------------------------------
+class ofxOpenVRRenderModelCache {
+public:
+	ofxOpenVRRenderModelCache();
+	~ofxOpenVRRenderModelCache();
+
+	void setup(const std::string &sDirectory, const std::string &sRuntimeVersion);	//empty directory disables the cache
+	bool isEnabled() const { return !_sDirectory.empty(); }
+	const std::string &getDirectory() const { return _sDirectory; }
+
+	//Maps the model's file, nullptr if there is no file, it is of another runtime version or broken
+	std::unique_ptr<ofxOpenVRCachedRenderModel> open(const std::string &sName) const;
+	//Copies the model and queues its file for the writer thread, bCompress - store an opaque texture as BC1
+	void write(const std::string &sName, const vr::RenderModel_t &model, const vr::RenderModel_TextureMap_t &texture, bool bCompress);
+	void waitForWrites();	//writes all queued files and stops the writer thread
+
+protected:
+	struct WriteJob {
+		std::string sName;
+		std::vector<vr::RenderModel_Vertex_t> vertices;
+		std::vector<uint16_t> indices;
+		uint32_t unTextureWidth = 0;
+		uint32_t unTextureHeight = 0;
+		std::vector<uint8_t> texture;	//RGBA8
+		bool bCompress = false;
+	};
+
+	std::string _sDirectory;
+	std::string _sRuntimeVersion;
+	std::thread _writer;
+	std::mutex _writeMutex;
+	std::condition_variable _writeCondition;
+	std::deque<std::shared_ptr<WriteJob>> _writeJobs;
+	bool _bWriterExit = false;		//the writer returns once the queue is empty
+
+	std::string getPath(const std::string &sName) const;
+	void writerLoop();
+	void writeFile(const WriteJob &job) const;
+};
@@ -0,0 +1,329 @@
+#include "ofxOpenVRRenderModels.h"
+#include "ofxOpenVRGpuMemory.h"
+
+//--------------------------------------------------------------
+ofxOpenVRRenderModels::ofxOpenVRRenderModels() {
+	_pVR = nullptr;
+	_sCacheDirectory = "ofxOpenVR/renderModels";
+	_bCompressionSupported = false;
+	_deviceEntry.fill(-1);
+	_batch.reserve(vr::k_unMaxTrackedDeviceCount);
+	_nBatchDevices = 0;
+	_glModelsBuffer = 0;
+}
+
+//--------------------------------------------------------------
+ofxOpenVRRenderModels::~ofxOpenVRRenderModels() {
+	clear();
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRenderModels::setup(ofxOpenVRBackend *pVR, const std::string &sRuntimeVersion) {
+	clear();
+	_pVR = pVR;
+	_sRuntimeVersion = sRuntimeVersion;
+	_bCompressionSupported = ofGLCheckExtension("GL_EXT_texture_compression_s3tc");
+	setCacheDirectory(_sCacheDirectory);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRenderModels::setCacheDirectory(const std::string &sDirectory) {
+	_sCacheDirectory = sDirectory;
+	_cache.setup(sDirectory.empty() ? "" : ofToDataPath(sDirectory, true), _sRuntimeVersion);
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRenderModels::clear() {
+	for (Entry &entry : _entries) {
+		freeRuntimeData(entry);
+		delete entry.pGLModel;
+	}
+	_entries.clear();
+	_entryIndex.clear();
+	_deviceEntry.fill(-1);
+	_arena.clear();
+	_batch.clear();
+	_nBatchDevices = 0;
+	if (_glModelsBuffer) {
+		ofxOpenVRGpuMemory::untrack(ofxOpenVRGpuMemory::Object::Buffer, _glModelsBuffer);
+		glDeleteBuffers(1, &_glModelsBuffer);
+		_glModelsBuffer = 0;
+	}
+	_pVR = nullptr;
+}
+
+//--------------------------------------------------------------
+int ofxOpenVRRenderModels::findEntry(const std::string &sRenderModelName) const {
+	auto it = _entryIndex.find(ofToLower(sRenderModelName));
+	return (it != _entryIndex.end()) ? it->second : -1;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRenderModels::request(vr::TrackedDeviceIndex_t unDevice, const std::string &sRenderModelName) {
+	if (unDevice >= vr::k_unMaxTrackedDeviceCount) return;
+	if (sRenderModelName.empty()) {
+		release(unDevice);
+		return;
+	}
+
+	int i = findEntry(sRenderModelName);
+	if (i < 0) {
+		i = int(_entries.size());
+		_entries.emplace_back();
+		_entries.back().name = sRenderModelName;
+		_entryIndex[ofToLower(sRenderModelName)] = i;
+	}
+	else if (_entries[i].state == State::Failed) {
+		_entries[i].state = State::LoadingModel;	//retry
+		_entries[i].bCacheChecked = false;
+	}
+	_deviceEntry[unDevice] = i;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRenderModels::release(vr::TrackedDeviceIndex_t unDevice) {
+	if (unDevice < vr::k_unMaxTrackedDeviceCount) {
+		_deviceEntry[unDevice] = -1;
+	}
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRenderModels::releaseAll() {
+	_deviceEntry.fill(-1);
+}
+
+//--------------------------------------------------------------
+CGLRenderModel *ofxOpenVRRenderModels::get(vr::TrackedDeviceIndex_t unDevice) const {
+	if (unDevice >= vr::k_unMaxTrackedDeviceCount || _deviceEntry[unDevice] < 0) return nullptr;
+	const Entry &entry = _entries[_deviceEntry[unDevice]];
+	return (entry.state == State::Ready) ? entry.pGLModel : nullptr;
+}
+
+//--------------------------------------------------------------
+ofxOpenVRRenderModels::State ofxOpenVRRenderModels::getState(vr::TrackedDeviceIndex_t unDevice) const {
+	if (unDevice >= vr::k_unMaxTrackedDeviceCount || _deviceEntry[unDevice] < 0) return State::Failed;
+	return _entries[_deviceEntry[unDevice]].state;
+}
+
+//--------------------------------------------------------------
+int ofxOpenVRRenderModels::getPendingCount() const {
+	int nPending = 0;
+	for (const Entry &entry : _entries) {
+		if (entry.state != State::Ready && entry.state != State::Failed) nPending++;
+	}
+	return nPending;
+}
+
+//--------------------------------------------------------------
+// Purpose: Each loading model is polled once, then upload steps of models
+// ready for upload are run until the budget is spent. The first step always runs,
+// so a model is uploaded even if a step takes longer than the budget.
+//--------------------------------------------------------------
+void ofxOpenVRRenderModels::update() {
+	if (!_pVR) return;
+
+	for (Entry &entry : _entries) {
+		poll(entry);
+	}
+
+	uint64_t ulStart = ofGetElapsedTimeMicros();
+	uint64_t ulBudget = uint64_t(std::max(uploadBudgetMs, 0.0f) * 1000.0f);
+	bool bFirstStep = true;
+	for (Entry &entry : _entries) {
+		while (entry.state == State::Uploading) {
+			if (!bFirstStep && ofGetElapsedTimeMicros() - ulStart >= ulBudget) return;
+			bFirstStep = false;
+			if (!uploadStep(entry)) break;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRenderModels::poll(Entry &entry) {
+	vr::EVRRenderModelError error;
+	if (entry.state == State::LoadingModel && !entry.bCacheChecked) {
+		entry.bCacheChecked = true;
+		entry.pCached = _cache.open(entry.name);
+		if (entry.pCached && entry.pCached->bCompressed && !_bCompressionSupported) {
+			entry.pCached.reset();
+		}
+		if (entry.pCached) {
+			entry.state = State::Uploading;
+			entry.unUploadedRows = 0;
+			entry.unUploadedLevels = 0;
+			return;
+		}
+	}
+	if (entry.state == State::LoadingModel) {
+		error = _pVR->LoadRenderModel_Async(entry.name.c_str(), &entry.pModel);
+		if (error == vr::VRRenderModelError_Loading) return;
+		if (error != vr::VRRenderModelError_None) {
+			entry.pModel = nullptr;
+			fail(entry, "render model", error);
+			return;
+		}
+		entry.state = State::LoadingTexture;
+	}
+	if (entry.state == State::LoadingTexture) {
+		error = _pVR->LoadTexture_Async(entry.pModel->diffuseTextureId, &entry.pTexture);
+		if (error == vr::VRRenderModelError_Loading) return;
+		if (error != vr::VRRenderModelError_None) {
+			entry.pTexture = nullptr;
+			fail(entry, "texture of render model", error);
+			return;
+		}
+		entry.state = State::Uploading;
+		entry.unUploadedRows = 0;
+	}
+}
+
+//--------------------------------------------------------------
+// Purpose: One step of the GL upload: geometry and texture storage,
+// a band of texture rows, or mipmaps
+//--------------------------------------------------------------
+bool ofxOpenVRRenderModels::uploadStep(Entry &entry) {
+	if (entry.pCached) {
+		return uploadCachedStep(entry);
+	}
+
+	if (!entry.pGLModel) {
+		entry.pGLModel = new CGLRenderModel(entry.name);
+		if (!entry.pGLModel->BInitGeometry(_arena, entry.pModel->rVertexData, entry.pModel->unVertexCount, entry.pModel->rIndexData, entry.pModel->unTriangleCount * 3)
+			|| !entry.pGLModel->BInitTexture(entry.pTexture->unWidth, entry.pTexture->unHeight)) {
+			delete entry.pGLModel;
+			entry.pGLModel = nullptr;
+			fail(entry, "GL model from render model", vr::VRRenderModelError_None);
+			return false;
+		}
+		return true;
+	}
+
+	if (entry.unUploadedRows < entry.pTexture->unHeight) {
+		entry.unUploadedRows += entry.pGLModel->UploadTextureRows(*entry.pTexture, entry.unUploadedRows, kUploadRowsPerStep);
+		return true;
+	}
+
+	entry.pGLModel->FinishTexture();
+	_cache.write(entry.name, *entry.pModel, *entry.pTexture, compressTextures && _bCompressionSupported);
+	freeRuntimeData(entry);
+	entry.state = State::Ready;
+	return false;
+}
+
+//--------------------------------------------------------------
+// Purpose: Upload from the mapped cache file: geometry, level 0 in bands of rows
+// (whole if compressed), then the smaller prebuilt levels one per step
+//--------------------------------------------------------------
+bool ofxOpenVRRenderModels::uploadCachedStep(Entry &entry) {
+	const ofxOpenVRCachedRenderModel &cached = *entry.pCached;
+	const ofxOpenVRCachedRenderModel::Level &level0 = cached.levels[0];
+	if (!entry.pGLModel) {
+		entry.pGLModel = new CGLRenderModel(entry.name);
+		if (!entry.pGLModel->BInitGeometry(_arena, cached.pVertices, cached.unVertexCount, cached.pIndices, cached.unIndexCount)
+			|| (!cached.bCompressed && !entry.pGLModel->BInitTexture(level0.unWidth, level0.unHeight))) {
+			delete entry.pGLModel;
+			entry.pGLModel = nullptr;
+			fail(entry, "GL model from render model", vr::VRRenderModelError_None);
+			return false;
+		}
+		return true;
+	}
+
+	if (entry.unUploadedLevels == 0 && !cached.bCompressed) {
+		entry.unUploadedRows += entry.pGLModel->UploadTextureRows(level0.pData, level0.unWidth, level0.unHeight, entry.unUploadedRows, kUploadRowsPerStep);
+		if (entry.unUploadedRows >= level0.unHeight) entry.unUploadedLevels = 1;
+		return true;
+	}
+
+	if (entry.unUploadedLevels < cached.levels.size()) {
+		const ofxOpenVRCachedRenderModel::Level &level = cached.levels[entry.unUploadedLevels];
+		entry.pGLModel->UploadTextureLevel(entry.unUploadedLevels, level.unWidth, level.unHeight, cached.bCompressed, level.pData, level.unSize);
+		entry.unUploadedLevels++;
+		return true;
+	}
+
+	entry.pGLModel->FinishTexture(GLint(cached.levels.size()));
+	entry.pCached.reset();
+	entry.state = State::Ready;
+	return false;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRenderModels::freeRuntimeData(Entry &entry) {
+	if (_pVR) {
+		if (entry.pTexture) _pVR->FreeTexture(entry.pTexture);
+		if (entry.pModel) _pVR->FreeRenderModel(entry.pModel);
+	}
+	entry.pTexture = nullptr;
+	entry.pModel = nullptr;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRenderModels::fail(Entry &entry, const char *pchWhat, vr::EVRRenderModelError error) {
+	if (error != vr::VRRenderModelError_None) {
+		ofLogError("ofxOpenVR") << "Unable to load " << pchWhat << " " << entry.name << " - " << _pVR->GetRenderModelErrorNameFromEnum(error);
+	}
+	else {
+		ofLogError("ofxOpenVR") << "Unable to create " << pchWhat << " " << entry.name;
+	}
+	freeRuntimeData(entry);
+	entry.pCached.reset();
+	entry.state = State::Failed;
+}
+
+//--------------------------------------------------------------
+// Purpose: Devices are grouped by model, so each model is drawn once for all of its devices.
+// The uniform buffer is orphaned before the upload, so the driver doesn't wait for the last frame's draws
+//--------------------------------------------------------------
+void ofxOpenVRRenderModels::updateBatch(const std::vector<vr::TrackedDeviceIndex_t> &devices, const vr::TrackedDevicePose_t *poses, const glm::mat4 *matrices) {
+	_batch.clear();
+	_nBatchDevices = 0;
+	for (size_t i = 0; i < _entries.size(); i++) {
+		if (_entries[i].state != State::Ready) continue;
+		BatchGroup group;
+		group.pModel = _entries[i].pGLModel;
+		group.nFirstModel = _nBatchDevices;
+		for (vr::TrackedDeviceIndex_t unDevice : devices) {
+			if (_deviceEntry[unDevice] != int(i) || !poses[unDevice].bPoseIsValid) continue;
+			_batchMatrices[_nBatchDevices++] = matrices[unDevice];
+		}
+		group.nDevices = _nBatchDevices - group.nFirstModel;
+		if (group.nDevices > 0) _batch.push_back(group);
+	}
+	if (_nBatchDevices == 0) return;
+
+	if (!_glModelsBuffer) {
+		glGenBuffers(1, &_glModelsBuffer);
+		ofxOpenVRGpuMemory::track(ofxOpenVRGpuMemory::Object::Buffer, _glModelsBuffer, ofxOpenVRGpuCategory::RenderModels, sizeof(_batchMatrices), "render model matrices");
+	}
+	glBindBuffer(GL_UNIFORM_BUFFER, _glModelsBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(_batchMatrices), nullptr, GL_DYNAMIC_DRAW);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4) * _nBatchDevices, _batchMatrices.data());
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+//--------------------------------------------------------------
+int ofxOpenVRRenderModels::drawBatch(const ofShader &shader, GLsizei nViews) const {
+	if (_batch.empty()) return 0;
+
+	glBindBufferBase(GL_UNIFORM_BUFFER, kModelsBlockBinding, _glModelsBuffer);
+	glBindVertexArray(_arena.getVertexArray());
+	glActiveTexture(GL_TEXTURE0);
+	for (const BatchGroup &group : _batch) {
+		glBindTexture(GL_TEXTURE_2D, group.pModel->GetTexture());
+		shader.setUniform1i("firstModel", group.nFirstModel);
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES, group.pModel->GetIndexCount(), GL_UNSIGNED_SHORT,
+			(void *)(sizeof(uint16_t) * group.pModel->GetFirstIndex()), group.nDevices * nViews, group.pModel->GetBaseVertex());
+	}
+	glBindVertexArray(0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	return int(_batch.size());
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRRenderModels::setupShader(const ofShader &shader) {
+	GLuint unBlockIndex = glGetUniformBlockIndex(shader.getProgram(), "DeviceModels");
+	if (unBlockIndex != GL_INVALID_INDEX) {
+		glUniformBlockBinding(shader.getProgram(), unBlockIndex, kModelsBlockBinding);
+	}
+}
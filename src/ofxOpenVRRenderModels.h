@@ -0,0 +1,132 @@
+#pragma once
+
+#include "ofxOpenVRBackend.h"
+#include "CGLRenderModel.h"
+#include "ofxOpenVRRenderModelCache.h"
+#include "ofxOpenVRRenderModelArena.h"
+
+/*
+	Non-blocking loader of tracked devices' render models.
+
+	request() only assigns a model to a device; update(), called once per frame, advances each model
+	through its states without waiting:
+		LoadingModel	- maps the model's cache file, if it is valid the runtime is not asked at all,
+						  otherwise polls LoadRenderModel_Async
+		LoadingTexture	- polls LoadTexture_Async
+		Uploading		- creates the GL buffers, then uploads the texture in bands of rows and builds mipmaps
+						  (or uploads mip levels of the cache file), only as many steps per frame
+						  as fit in uploadBudgetMs (at least one step)
+		Ready			- get() returns the model, runtime's data is freed, models loaded from the runtime
+						  are written to the cache on a worker thread
+		Failed			- loading failed, the next request() of the model retries it
+	Until the model is ready, get() returns nullptr and the device is not drawn,
+	so connecting a controller during a show doesn't stall rendering.
+
+	Models are shared by name between devices. The cache is keyed by model name and runtime version,
+	see ofxOpenVRRenderModelCache.h.
+
+	All models share the vertex and index buffers of one arena (ofxOpenVRRenderModelArena.h).
+	updateBatch() collects the drawn devices once per frame, grouped by model, and uploads their matrices
+	into a uniform buffer; drawBatch() then draws each model once, instanced for all its devices
+	(and both eyes in single-pass stereo). A scene of 15 trackers of the same model is one draw call.
+	The shader takes the matrices from the block bound by setupShader():
+		layout(std140) uniform DeviceModels { mat4 models[64]; };
+		uniform int firstModel;
+		...
+		mat4 model = models[firstModel + gl_InstanceID / nViews];
+
+	ofxOpenVR owns one loader, to check the progress:
+		const ofxOpenVRRenderModels &models = openVR.getRenderModels();
+		if (models.isLoading()) cout << models.getPendingCount() << " render models are loading" << endl;
+*/
+
+//--------------------------------------------------------------
+class ofxOpenVRRenderModels {
+public:
+	enum class State {
+		LoadingModel,
+		LoadingTexture,
+		Uploading,
+		Ready,
+		Failed
+	};
+
+	ofxOpenVRRenderModels();
+	~ofxOpenVRRenderModels();
+
+	void setup(ofxOpenVRBackend *pVR, const std::string &sRuntimeVersion = "");	//call with GL context
+	void clear();	//frees runtime's data and GL resources of all models, call with GL context before the runtime is shut down
+
+	//Assigns the render model to the device and starts loading it if needed
+	void request(vr::TrackedDeviceIndex_t unDevice, const std::string &sRenderModelName);
+	void release(vr::TrackedDeviceIndex_t unDevice);	//device is not drawn anymore, its model is kept loaded
+	void releaseAll();
+
+	void update();	//polls loading models and uploads within the budget, call once per frame with GL context
+
+	CGLRenderModel *get(vr::TrackedDeviceIndex_t unDevice) const;	//nullptr until the device's model is ready
+	State getState(vr::TrackedDeviceIndex_t unDevice) const;		//Failed if no model is assigned
+	const ofxOpenVRRenderModelArena &getArena() const { return _arena; }
+	bool isLoading() const { return getPendingCount() > 0; }
+	int getPendingCount() const;	//models which are neither ready nor failed
+
+	//---- Batched drawing
+	//Collects connected devices with valid poses and ready models and uploads their matrices, call once per frame
+	void updateBatch(const std::vector<vr::TrackedDeviceIndex_t> &devices, const vr::TrackedDevicePose_t *poses, const glm::mat4 *matrices);
+	//One instanced draw per model, nViews instances per device. Call between shader.begin() and end(), returns the number of draw calls
+	int drawBatch(const ofShader &shader, GLsizei nViews) const;
+	int getBatchDeviceCount() const { return _nBatchDevices; }
+	static void setupShader(const ofShader &shader);	//binds the shader's DeviceModels block, call once after loading
+	static const GLuint kModelsBlockBinding = 3;		//uniform buffer binding point of DeviceModels
+
+	//Directory of the cache files, relative to the data folder or absolute; "" disables the cache.
+	//Default is "ofxOpenVR/renderModels". Takes effect for models loaded after the call
+	void setCacheDirectory(const std::string &sDirectory);
+	const std::string &getCacheDirectory() const { return _sCacheDirectory; }
+
+	float uploadBudgetMs = 1.0f;	//GL upload time per frame
+	bool compressTextures = false;	//opaque textures are cached as BC1, if the GPU supports it
+
+protected:
+	static const uint32_t kUploadRowsPerStep = 64;	//texture rows per upload step, 256 KB for 1024 pixels wide textures
+
+	struct Entry {
+		std::string name;
+		State state = State::LoadingModel;
+		vr::RenderModel_t *pModel = nullptr;
+		vr::RenderModel_TextureMap_t *pTexture = nullptr;
+		std::unique_ptr<ofxOpenVRCachedRenderModel> pCached;	//mapped cache file while it is uploaded
+		bool bCacheChecked = false;
+		CGLRenderModel *pGLModel = nullptr;
+		uint32_t unUploadedRows = 0;	//of level 0
+		uint32_t unUploadedLevels = 0;	//prebuilt levels of the cache file
+	};
+
+	struct BatchGroup {
+		const CGLRenderModel *pModel;
+		GLint nFirstModel;	//in _batchMatrices
+		GLsizei nDevices;
+	};
+
+	ofxOpenVRBackend *_pVR;
+	std::string _sRuntimeVersion;
+	std::string _sCacheDirectory;
+	ofxOpenVRRenderModelCache _cache;
+	bool _bCompressionSupported;
+	std::vector<Entry> _entries;
+	std::unordered_map<std::string, int> _entryIndex;	//lowercase name to index in _entries
+	std::array<int, vr::k_unMaxTrackedDeviceCount> _deviceEntry;	//index in _entries, -1 if none
+
+	ofxOpenVRRenderModelArena _arena;
+	std::array<glm::mat4, vr::k_unMaxTrackedDeviceCount> _batchMatrices;
+	std::vector<BatchGroup> _batch;
+	int _nBatchDevices;
+	GLuint _glModelsBuffer;	//uniform buffer of _batchMatrices
+
+	int findEntry(const std::string &sRenderModelName) const;
+	void poll(Entry &entry);
+	bool uploadStep(Entry &entry);	//returns false when the model needs no more steps
+	bool uploadCachedStep(Entry &entry);
+	void freeRuntimeData(Entry &entry);
+	void fail(Entry &entry, const char *pchWhat, vr::EVRRenderModelError error);
+};
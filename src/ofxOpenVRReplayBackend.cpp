@@ -0,0 +1,293 @@
+#include "ofxOpenVRReplayBackend.h"
+
+using namespace ofxOpenVRSessionFile;
+
+namespace {
+	//--------------------------------------------------------------
+	ofxOpenVRFakeBackendSettings replaySettings(bool bThrottle) {
+		ofxOpenVRFakeBackendSettings settings;
+		settings.throttle = bThrottle;
+		settings.controllerCount = 0;
+		settings.hasCamera = false;
+		return settings;
+	}
+}
+
+//--------------------------------------------------------------
+ofxOpenVRReplayBackend::ofxOpenVRReplayBackend(const std::string &fileName, bool bThrottle, bool bLoop)
+	: ofxOpenVRFakeBackend(replaySettings(bThrottle)) {
+	_bLoop = bLoop;
+	_bFinished = false;
+	_nFirstChunk = 0;
+	_nCursor = 0;
+	_nRecordedFrames = 0;
+	_dRecordedDuration = 0;
+	_dLoopTime = 0;
+	_bLoaded = load(fileName);
+	rewind();
+}
+
+//--------------------------------------------------------------
+// Purpose: Reads the file and checks its chunks, a truncated last chunk is dropped
+//--------------------------------------------------------------
+bool ofxOpenVRReplayBackend::load(const std::string &fileName) {
+	_data = ofBufferFromFile(ofToDataPath(fileName, true), true);
+
+	Header header;
+	if (_data.size() < sizeof(Header)) {
+		ofLogError("ofxOpenVR") << "Can't read session file " << fileName;
+		return false;
+	}
+	memcpy(&header, _data.getData(), sizeof(header));
+	if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion || header.headerSize < sizeof(Header)) {
+		ofLogError("ofxOpenVR") << fileName << " is not a session file of version " << kVersion;
+		return false;
+	}
+	if (header.poseSize != sizeof(vr::TrackedDevicePose_t) || header.controllerStateSize != sizeof(vr::VRControllerState_t)
+		|| header.cameraHeaderSize != sizeof(vr::CameraVideoStreamFrameHeader_t)) {
+		ofLogError("ofxOpenVR") << fileName << " was recorded with an incompatible openvr.h";
+		return false;
+	}
+
+	_settings.renderWidth = header.renderWidth;
+	_settings.renderHeight = header.renderHeight;
+	_nFirstChunk = header.headerSize;
+
+	// Count frames and find camera frame size
+	_nCursor = _nFirstChunk;
+	Chunk chunk;
+	const char *pPayload;
+	while (peekChunk(chunk, pPayload)) {
+		if (chunk.type == Chunk_Frame && chunk.size >= sizeof(FrameRecord)) {
+			FrameRecord frame;
+			memcpy(&frame, pPayload, sizeof(frame));
+			_nRecordedFrames++;
+			_dRecordedDuration = frame.dTime;
+		}
+		if (chunk.type == Chunk_CameraFrame && !_settings.hasCamera && chunk.size >= sizeof(vr::CameraVideoStreamFrameHeader_t)) {
+			vr::CameraVideoStreamFrameHeader_t cameraHeader;
+			memcpy(&cameraHeader, pPayload, sizeof(cameraHeader));
+			_settings.hasCamera = true;
+			_settings.cameraWidth = cameraHeader.nWidth;
+			_settings.cameraHeight = cameraHeader.nHeight;
+		}
+		_nCursor += sizeof(Chunk) + chunk.size;
+	}
+	if (_nCursor < _data.size()) {
+		ofLogWarning("ofxOpenVR") << fileName << " is truncated, replaying " << _nRecordedFrames << " complete frames";
+	}
+
+	// Camera test pattern of the recorded size
+	createGeometry();
+
+	ofLogNotice("ofxOpenVR") << "Loaded session " << fileName << ": " << _nRecordedFrames << " frames, " << _dRecordedDuration << " seconds";
+	return true;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRReplayBackend::rewind() {
+	_nCursor = _nFirstChunk;
+	memset(_poses, 0, sizeof(_poses));
+	memset(_devices, 0, sizeof(_devices));
+	memset(_controllerStates, 0, sizeof(_controllerStates));
+	memset(_bControllerStateValid, 0, sizeof(_bControllerStateValid));
+	memset(&_cameraHeader, 0, sizeof(_cameraHeader));
+	_bCameraHeaderValid = false;
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRReplayBackend::peekChunk(Chunk &chunk, const char *&pPayload) {
+	if (!_nFirstChunk || _nCursor + sizeof(Chunk) > _data.size()) return false;
+	memcpy(&chunk, _data.getData() + _nCursor, sizeof(chunk));
+	if (_nCursor + sizeof(Chunk) + chunk.size > _data.size()) return false;
+	pPayload = _data.getData() + _nCursor + sizeof(Chunk);
+	return true;
+}
+
+//--------------------------------------------------------------
+void ofxOpenVRReplayBackend::applyStateChunks() {
+	Chunk chunk;
+	const char *pPayload;
+	while (peekChunk(chunk, pPayload)) {
+		switch (chunk.type) {
+		case Chunk_Event:
+		case Chunk_Frame:
+			return;
+		case Chunk_Device:
+			if (chunk.size >= sizeof(DeviceRecord)) {
+				DeviceRecord device;
+				memcpy(&device, pPayload, sizeof(device));
+				if (device.index < vr::k_unMaxTrackedDeviceCount) _devices[device.index] = device;
+			}
+			break;
+		case Chunk_ControllerState:
+			if (chunk.size >= sizeof(ControllerStateRecord)) {
+				ControllerStateRecord record;
+				memcpy(&record, pPayload, sizeof(record));
+				if (record.index < vr::k_unMaxTrackedDeviceCount) {
+					_controllerStates[record.index] = record.state;
+					_bControllerStateValid[record.index] = true;
+				}
+			}
+			break;
+		case Chunk_CameraFrame:
+			if (chunk.size >= sizeof(vr::CameraVideoStreamFrameHeader_t)) {
+				memcpy(&_cameraHeader, pPayload, sizeof(_cameraHeader));
+				_bCameraHeaderValid = true;
+			}
+			break;
+		default:
+			//Unknown chunks of newer versions are skipped
+			break;
+		}
+		_nCursor += sizeof(Chunk) + chunk.size;
+	}
+}
+
+//--------------------------------------------------------------
+vr::EVRInitError ofxOpenVRReplayBackend::Init() {
+	if (!_bLoaded) return vr::VRInitError_Init_FileNotFound;
+	ofxOpenVRFakeBackend::Init();
+	_bFinished = false;
+	_dLoopTime = 0;
+	rewind();
+	applyStateChunks();		//devices connected at the start of recording
+	return vr::VRInitError_None;
+}
+
+//--------------------------------------------------------------
+vr::ETrackedDeviceClass ofxOpenVRReplayBackend::GetTrackedDeviceClass(vr::TrackedDeviceIndex_t unDeviceIndex) {
+	if (unDeviceIndex >= vr::k_unMaxTrackedDeviceCount || !_devices[unDeviceIndex].bConnected) return vr::TrackedDeviceClass_Invalid;
+	return vr::ETrackedDeviceClass(_devices[unDeviceIndex].deviceClass);
+}
+
+//--------------------------------------------------------------
+vr::ETrackedControllerRole ofxOpenVRReplayBackend::GetControllerRoleForTrackedDeviceIndex(vr::TrackedDeviceIndex_t unDeviceIndex) {
+	if (unDeviceIndex >= vr::k_unMaxTrackedDeviceCount || !_devices[unDeviceIndex].bConnected) return vr::TrackedControllerRole_Invalid;
+	return vr::ETrackedControllerRole(_devices[unDeviceIndex].role);
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRReplayBackend::IsTrackedDeviceConnected(vr::TrackedDeviceIndex_t unDeviceIndex) {
+	return _bInit && unDeviceIndex < vr::k_unMaxTrackedDeviceCount && _devices[unDeviceIndex].bConnected;
+}
+
+//--------------------------------------------------------------
+uint32_t ofxOpenVRReplayBackend::GetStringTrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, char *pchValue, uint32_t unBufferSize, vr::ETrackedPropertyError *pError) {
+	if (!IsTrackedDeviceConnected(unDeviceIndex)) {
+		if (pError) *pError = vr::TrackedProp_InvalidDevice;
+		return 0;
+	}
+
+	const DeviceRecord &device = _devices[unDeviceIndex];
+	const char *value = nullptr;
+	switch (prop) {
+	case vr::Prop_SerialNumber_String: value = device.serialNumber; break;
+	case vr::Prop_RenderModelName_String: value = device.renderModelName; break;
+	case vr::Prop_TrackingSystemName_String: value = device.trackingSystemName; break;
+	case vr::Prop_ModelNumber_String: value = device.modelNumber; break;
+	default:
+		return ofxOpenVRFakeBackend::GetStringTrackedDeviceProperty(unDeviceIndex, prop, pchValue, unBufferSize, pError);
+	}
+
+	uint32_t unRequiredBufferLen = strlen(value) + 1;
+	if (unBufferSize < unRequiredBufferLen) {
+		if (pError) *pError = vr::TrackedProp_BufferTooSmall;
+		return unRequiredBufferLen;
+	}
+	memcpy(pchValue, value, unRequiredBufferLen);
+	if (pError) *pError = vr::TrackedProp_Success;
+	return unRequiredBufferLen;
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRReplayBackend::GetControllerState(vr::TrackedDeviceIndex_t unControllerDeviceIndex, vr::VRControllerState_t *pControllerState, uint32_t unControllerStateSize) {
+	applyStateChunks();
+	if (!IsTrackedDeviceConnected(unControllerDeviceIndex) || !_bControllerStateValid[unControllerDeviceIndex]
+		|| unControllerStateSize < sizeof(vr::VRControllerState_t)) return false;
+
+	*pControllerState = _controllerStates[unControllerDeviceIndex];
+	return true;
+}
+
+//--------------------------------------------------------------
+bool ofxOpenVRReplayBackend::PollNextEvent(vr::VREvent_t *pEvent, uint32_t uncbVREvent) {
+	applyStateChunks();
+
+	Chunk chunk;
+	const char *pPayload;
+	if (!peekChunk(chunk, pPayload) || chunk.type != Chunk_Event) return false;
+
+	memset(pEvent, 0, uncbVREvent);
+	memcpy(pEvent, pPayload, std::min<uint32_t>(uncbVREvent, chunk.size));
+	_nCursor += sizeof(Chunk) + chunk.size;
+	return true;
+}
+
+//--------------------------------------------------------------
+// Purpose: Moves to the next recorded frame, events of the current frame which were not polled are dropped
+//--------------------------------------------------------------
+vr::EVRCompositorError ofxOpenVRReplayBackend::WaitGetPoses(vr::TrackedDevicePose_t *pRenderPoseArray, uint32_t unRenderPoseArrayCount, vr::TrackedDevicePose_t *pGamePoseArray, uint32_t unGamePoseArrayCount) {
+	_nFrame++;
+
+	Chunk chunk;
+	const char *pPayload;
+	while (true) {
+		applyStateChunks();
+		if (!peekChunk(chunk, pPayload)) {
+			if (_bLoop && _nRecordedFrames > 0) {
+				_dLoopTime += _dRecordedDuration;
+				rewind();
+				continue;
+			}
+			_bFinished = true;		//keep the last poses
+			break;
+		}
+		_nCursor += sizeof(Chunk) + chunk.size;
+		if (chunk.type != Chunk_Frame || chunk.size < sizeof(FrameRecord)) continue;
+
+		// Changed poses follow the frame record in the order of device indices
+		FrameRecord frame;
+		memcpy(&frame, pPayload, sizeof(frame));
+		const char *pPose = pPayload + sizeof(FrameRecord);
+		const char *pEnd = pPayload + chunk.size;
+		for (vr::TrackedDeviceIndex_t i = 0; i < vr::k_unMaxTrackedDeviceCount; i++) {
+			if ((frame.ulChangedMask & (uint64_t(1) << i)) && pPose + sizeof(vr::TrackedDevicePose_t) <= pEnd) {
+				memcpy(&_poses[i], pPose, sizeof(vr::TrackedDevicePose_t));
+				pPose += sizeof(vr::TrackedDevicePose_t);
+			}
+		}
+
+		// Keep the recorded timing
+		if (_settings.throttle) {
+			uint64_t nFrameMicros = _nStartTimeMicros + uint64_t((_dLoopTime + frame.dTime) * 1000000.0);
+			uint64_t nNowMicros = ofGetElapsedTimeMicros();
+			if (nFrameMicros > nNowMicros) {
+				std::this_thread::sleep_for(std::chrono::microseconds(nFrameMicros - nNowMicros));
+			}
+		}
+		break;
+	}
+
+	if (pRenderPoseArray) {
+		memcpy(pRenderPoseArray, _poses, std::min(unRenderPoseArrayCount, vr::k_unMaxTrackedDeviceCount) * sizeof(vr::TrackedDevicePose_t));
+	}
+	if (pGamePoseArray) {
+		memcpy(pGamePoseArray, _poses, std::min(unGamePoseArrayCount, vr::k_unMaxTrackedDeviceCount) * sizeof(vr::TrackedDevicePose_t));
+	}
+	return vr::VRCompositorError_None;
+}
+
+//--------------------------------------------------------------
+vr::EVRTrackedCameraError ofxOpenVRReplayBackend::GetVideoStreamFrameBuffer(vr::TrackedCameraHandle_t hTrackedCamera, vr::EVRTrackedCameraFrameType eFrameType, void *pFrameBuffer, uint32_t nFrameBufferSize, vr::CameraVideoStreamFrameHeader_t *pFrameHeader, uint32_t nFrameHeaderSize) {
+	applyStateChunks();
+	if (!_bCameraHeaderValid) return vr::VRTrackedCameraError_NoFrameAvailable;
+
+	// Test pattern image with the recorded sequence number and pose
+	vr::EVRTrackedCameraError eError = ofxOpenVRFakeBackend::GetVideoStreamFrameBuffer(hTrackedCamera, eFrameType, pFrameBuffer, nFrameBufferSize, pFrameHeader, nFrameHeaderSize);
+	if (eError == vr::VRTrackedCameraError_None && pFrameHeader && nFrameHeaderSize >= sizeof(vr::CameraVideoStreamFrameHeader_t)) {
+		pFrameHeader->nFrameSequence = _cameraHeader.nFrameSequence;
+		pFrameHeader->standingTrackedDevicePose = _cameraHeader.standingTrackedDevicePose;
+	}
+	return eError;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "ofxOpenVRFakeBackend.h"
+#include "ofxOpenVRRecorder.h"
+
+/*
+	Replays a session recorded by ofxOpenVRRecordingBackend (see ofxOpenVRRecorder.h) without SteamVR and headset.
+	Poses, controller states, events, device info and camera frame headers are returned exactly as recorded,
+	so ofxOpenVR::update() runs the same code with the same data as at the venue.
+	Everything which is not recorded (render models, distortion, camera images) comes from ofxOpenVRFakeBackend.
+
+	Each WaitGetPoses() returns the next recorded frame. By default frames are replayed as fast as possible,
+	with 'throttle' the recorded frame times are kept. At the end of the recording the last frame is repeated,
+	or, with 'loop', the replay starts over.
+
+	Usage:
+		auto replay = std::make_shared<ofxOpenVRReplayBackend>("show.ovrsession");
+		if (replay->isLoaded()) {
+			openVR.setup(std::bind(&ofApp::render, this, std::placeholders::_1), replay);
+		}
+*/
+
+//--------------------------------------------------------------
+class ofxOpenVRReplayBackend : public ofxOpenVRFakeBackend {
+public:
+	//fileName is relative to bin/data; the whole file is read in the constructor
+	ofxOpenVRReplayBackend(const std::string &fileName, bool bThrottle = false, bool bLoop = false);
+
+	bool isLoaded() const { return _bLoaded; }
+	bool isFinished() const { return _bFinished; }	//the last recorded frame was reached (never, if looping)
+	uint64_t getRecordedFrameCount() const { return _nRecordedFrames; }
+	double getRecordedDuration() const { return _dRecordedDuration; }	//seconds
+
+	vr::EVRInitError Init() override;
+
+	vr::ETrackedDeviceClass GetTrackedDeviceClass(vr::TrackedDeviceIndex_t unDeviceIndex) override;
+	vr::ETrackedControllerRole GetControllerRoleForTrackedDeviceIndex(vr::TrackedDeviceIndex_t unDeviceIndex) override;
+	bool IsTrackedDeviceConnected(vr::TrackedDeviceIndex_t unDeviceIndex) override;
+	uint32_t GetStringTrackedDeviceProperty(vr::TrackedDeviceIndex_t unDeviceIndex, vr::ETrackedDeviceProperty prop, char *pchValue, uint32_t unBufferSize, vr::ETrackedPropertyError *pError = 0L) override;
+	bool GetControllerState(vr::TrackedDeviceIndex_t unControllerDeviceIndex, vr::VRControllerState_t *pControllerState, uint32_t unControllerStateSize) override;
+	bool PollNextEvent(vr::VREvent_t *pEvent, uint32_t uncbVREvent) override;
+
+	vr::EVRCompositorError WaitGetPoses(vr::TrackedDevicePose_t *pRenderPoseArray, uint32_t unRenderPoseArrayCount, vr::TrackedDevicePose_t *pGamePoseArray, uint32_t unGamePoseArrayCount) override;
+	vr::EVRTrackedCameraError GetVideoStreamFrameBuffer(vr::TrackedCameraHandle_t hTrackedCamera, vr::EVRTrackedCameraFrameType eFrameType, void *pFrameBuffer, uint32_t nFrameBufferSize, vr::CameraVideoStreamFrameHeader_t *pFrameHeader, uint32_t nFrameHeaderSize) override;
+
+protected:
+	bool _bLoaded;
+	bool _bLoop;
+	bool _bFinished;
+	ofBuffer _data;
+	size_t _nFirstChunk;		//offset of the first chunk after the header
+	size_t _nCursor;			//offset of the next chunk to replay
+	uint64_t _nRecordedFrames;
+	double _dRecordedDuration;
+	double _dLoopTime;			//recorded time at the start of the current loop, for throttling
+
+	//Recorded state at the cursor
+	ofxOpenVRSessionFile::DeviceRecord _devices[vr::k_unMaxTrackedDeviceCount];
+	vr::VRControllerState_t _controllerStates[vr::k_unMaxTrackedDeviceCount];
+	bool _bControllerStateValid[vr::k_unMaxTrackedDeviceCount];
+	vr::CameraVideoStreamFrameHeader_t _cameraHeader;
+	bool _bCameraHeaderValid;
+
+	bool load(const std::string &fileName);
+	void rewind();
+	//Reads a chunk at the cursor, returns false at the end of data
+	bool peekChunk(ofxOpenVRSessionFile::Chunk &chunk, const char *&pPayload);
+	//Applies device, controller state and camera chunks till the next event or frame
+	void applyStateChunks();
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+/*
+	Fixed-capacity lock-free queue for one producer thread and one consumer thread.
+
+	push() is called only by the producer, pop() and clear() only by the consumer.
+	When the queue is full, push() drops the item and increments the overflow counter,
+	so the producer never blocks and never allocates.
+
+	Usage:
+		ofxOpenVRSpscQueue<int, 64> queue;
+		queue.push(1);		//producer thread
+		int v;
+		while (queue.pop(v)) { ... }	//consumer thread
+*/
+
+//--------------------------------------------------------------
+template<typename T, size_t Capacity>
+class ofxOpenVRSpscQueue {
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+	ofxOpenVRSpscQueue() : _head(0), _tail(0), _nOverflow(0) {}
+
+	//Producer
+	bool push(const T &item) {
+		size_t tail = _tail.load(std::memory_order_relaxed);
+		if (tail - _head.load(std::memory_order_acquire) >= Capacity) {
+			_nOverflow.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		_items[tail & (Capacity - 1)] = item;
+		_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	//Consumer
+	bool pop(T &item) {
+		size_t head = _head.load(std::memory_order_relaxed);
+		if (head == _tail.load(std::memory_order_acquire)) {
+			return false;
+		}
+		item = _items[head & (Capacity - 1)];
+		_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	void clear() {
+		_head.store(_tail.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+	bool empty() const { return size() == 0; }
+	size_t size() const { return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire); }
+	static size_t capacity() { return Capacity; }
+
+	uint64_t getOverflowCount() const { return _nOverflow.load(std::memory_order_relaxed); }	//items dropped because the queue was full
+
+protected:
+	std::array<T, Capacity> _items;
+	alignas(64) std::atomic<size_t> _head;		//next item to pop, written by consumer
+	alignas(64) std::atomic<size_t> _tail;		//next free slot, written by producer
+	alignas(64) std::atomic<uint64_t> _nOverflow;
+};